@@ -126,6 +126,10 @@ TestScreen1::register_instruments()
 	register_instrument (this->glide_ratio_label, _others_work_performer);
 	register_instrument (this->load_factor, _others_work_performer);
 	register_instrument (this->load_factor_label, _others_work_performer);
+
+	// Keep primary flight instruments at full rate under load:
+	set_paint_priority (this->adi, xf::PaintPriority::Critical);
+	set_paint_priority (this->hsi, xf::PaintPriority::Critical);
 }
 
 
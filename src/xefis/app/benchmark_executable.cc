@@ -0,0 +1,45 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/test/benchmark.h>
+
+// Qt:
+#include <QApplication>
+
+// Standard:
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+
+int
+main (int argc, char** argv, char**)
+{
+	// Instrument benchmarks need fonts and QPainter, but they paint on QImages only,
+	// so no display is needed. Allow overriding the platform for comparison (the OpenGL
+	// compositor benchmark needs a platform with OpenGL, eg. xcb):
+	if (!qEnvironmentVariableIsSet ("QT_QPA_PLATFORM"))
+		qputenv ("QT_QPA_PLATFORM", "offscreen");
+
+	QApplication app (argc, argv);
+
+	// Optional first argument filters benchmarks by name:
+	auto const filter = argc > 1
+		? std::optional<std::string_view> (argv[1])
+		: std::nullopt;
+
+	xf::Benchmark::run_all (filter);
+	return EXIT_SUCCESS;
+}
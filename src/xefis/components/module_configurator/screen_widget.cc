@@ -94,6 +94,14 @@ ScreenWidget::refresh()
 
 			if (widgets.total_latency_histogram && widgets.total_latency_stats)
 				update_histogram (metrics->total_latencies, *widgets.total_latency_histogram, *widgets.total_latency_stats);
+
+			if (widgets.deadlines_info)
+			{
+				widgets.deadlines_info->setText (QString ("<b>Missed deadlines:</b> %1 • <b>Deferred paints:</b> %2%3")
+					.arg (metrics->missed_deadlines)
+					.arg (metrics->deferred_paints)
+					.arg (metrics->overloaded ? QString (" • <b>OVERLOADED</b>") : QString()));
+			}
 		}
 	}
 }
@@ -149,14 +157,17 @@ ScreenWidget::create_performance_tab()
 			std::tie (widgets.total_latency_histogram, widgets.total_latency_stats, widgets.total_latency_group)
 				= create_performance_widget (tab, nu::to_qstring ("Total latency (request start to painting finish)"));
 
+			widgets.deadlines_info = new QLabel (tab);
+
 			auto* tab_layout = new QGridLayout (tab);
 			tab_layout->setContentsMargins (0, 0, 0, 0);
 			tab_layout->addWidget (widgets.start_latency_group, 0, 0);
 			tab_layout->addWidget (widgets.total_latency_group, 1, 0);
-			tab_layout->addItem (new QSpacerItem (0, ph.em_pixels (0.5f), QSizePolicy::Expanding, QSizePolicy::Fixed), 2, 0);
-			tab_layout->addWidget (handled_modules_info, 3, 0);
+			tab_layout->addWidget (widgets.deadlines_info, 2, 0);
+			tab_layout->addItem (new QSpacerItem (0, ph.em_pixels (0.5f), QSizePolicy::Expanding, QSizePolicy::Fixed), 3, 0);
+			tab_layout->addWidget (handled_modules_info, 4, 0);
 			tab_layout->addItem (ph.new_expanding_horizontal_spacer(), 0, 1);
-			tab_layout->addItem (ph.new_expanding_vertical_spacer(), 4, 0);
+			tab_layout->addItem (ph.new_expanding_vertical_spacer(), 5, 0);
 		}
 	}
 
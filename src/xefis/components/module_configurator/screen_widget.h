@@ -23,6 +23,7 @@
 #include <xefis/support/ui/widget.h>
 
 // Qt:
+#include <QLabel>
 #include <QTimer>
 #include <QWidget>
 
@@ -50,6 +51,7 @@ class ScreenWidget: public ConfigWidget
 		xf::HistogramWidget*		total_latency_histogram	{ nullptr };
 		xf::HistogramStatsWidget*	total_latency_stats		{ nullptr };
 		QWidget*					total_latency_group		{ nullptr };
+		QLabel*						deadlines_info			{ nullptr };
 	};
 
   public:
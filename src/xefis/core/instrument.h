@@ -21,10 +21,14 @@
 
 // Neutrino:
 #include <neutrino/noncopyable.h>
+#include <neutrino/work_performer.h>
 
 // Lib:
 #include <boost/circular_buffer.hpp>
 
+// Qt:
+#include <QSize>
+
 // Standard:
 #include <cstddef>
 #include <atomic>
@@ -78,6 +82,18 @@ class Instrument: public Module
 		boost::circular_buffer<si::Time> const&
 		painting_times() const noexcept;
 
+		/**
+		 * Set size of the canvas that the instrument is being painted on.
+		 */
+		void
+		set_canvas_size (QSize);
+
+		/**
+		 * Set WorkPerformer that paints the instrument.
+		 */
+		void
+		set_work_performer (nu::WorkPerformer*);
+
 	  private:
 		Instrument& _instrument;
 	};
@@ -103,14 +119,41 @@ class Instrument: public Module
 	bool
 	dirty_since_last_check() noexcept;
 
+	/**
+	 * Return true if instrument wants to be repainted, without unmarking it.
+	 */
+	[[nodiscard]]
+	bool
+	dirty() const noexcept;
+
 	/**
 	 * Mark instrument as dirty (to be repainted).
 	 */
 	void
 	mark_dirty() noexcept;
 
+	/**
+	 * Size of the canvas that the instrument has been recently painted on
+	 * or an empty size if it hasn't been painted yet. Can be used to skip
+	 * repainting when inputs change by less than a pixel.
+	 */
+	[[nodiscard]]
+	QSize
+	canvas_size() const noexcept;
+
+	/**
+	 * WorkPerformer that paints the instrument or nullptr if the instrument
+	 * isn't registered on any Screen. Can be used to schedule background work
+	 * related to painting.
+	 */
+	[[nodiscard]]
+	nu::WorkPerformer*
+	work_performer() const noexcept;
+
   private:
 	std::atomic<bool>					_dirty			{ true };
+	std::atomic<QSize>					_canvas_size	{ QSize() };
+	std::atomic<nu::WorkPerformer*>		_work_performer	{ nullptr };
 	boost::circular_buffer<si::Time>	_painting_times	{ kMaxPaintingTimesBackLog };
 	si::Time							_frame_time		{ 0_s };
 };
@@ -150,6 +193,20 @@ Instrument::AccountingAPI::painting_times() const noexcept
 }
 
 
+inline void
+Instrument::AccountingAPI::set_canvas_size (QSize const canvas_size)
+{
+	_instrument._canvas_size.store (canvas_size);
+}
+
+
+inline void
+Instrument::AccountingAPI::set_work_performer (nu::WorkPerformer* const work_performer)
+{
+	_instrument._work_performer.store (work_performer);
+}
+
+
 inline bool
 Instrument::dirty_since_last_check() noexcept
 {
@@ -157,12 +214,33 @@ Instrument::dirty_since_last_check() noexcept
 }
 
 
+inline bool
+Instrument::dirty() const noexcept
+{
+	return _dirty.load();
+}
+
+
 inline void
 Instrument::mark_dirty() noexcept
 {
 	_dirty.store (true);
 }
 
+
+inline QSize
+Instrument::canvas_size() const noexcept
+{
+	return _canvas_size.load();
+}
+
+
+inline nu::WorkPerformer*
+Instrument::work_performer() const noexcept
+{
+	return _work_performer.load();
+}
+
 } // namespace xf
 
 #endif
@@ -32,7 +32,9 @@
 #include <cstddef>
 #include <functional>
 #include <algorithm>
+#include <numeric>
 #include <thread>
+#include <utility>
 
 
 namespace xf {
@@ -66,6 +68,29 @@ InstrumentDetails::compute_position (QSize const canvas_size)
 }
 
 
+void
+WorkPerformerMetrics::add (PaintPerformanceMetrics const& metrics, si::Time const frame_budget)
+{
+	auto const total_latency = metrics.start_latency + metrics.painting_time;
+
+	start_latencies.push_back (metrics.start_latency);
+	total_latencies.push_back (total_latency);
+
+	if (total_latency > frame_budget)
+		++missed_deadlines;
+
+	// Average of recent total latencies decides about overload. Use hysteresis,
+	// so that deferring paints doesn't immediately end the overload state:
+	auto const samples = std::min (kOverloadSamples, total_latencies.size());
+	auto const average = std::accumulate (total_latencies.end() - samples, total_latencies.end(), 0_s) / static_cast<double> (samples);
+
+	if (average > frame_budget)
+		overloaded = true;
+	else if (average < kOverloadRecovery * frame_budget)
+		overloaded = false;
+}
+
+
 Screen::Screen (ScreenSpec const& spec, Graphics const& graphics, Machine& machine, std::string_view const instance, nu::Logger const& logger):
 	QWidget (nullptr),
 	NamedInstance (instance),
@@ -90,6 +115,13 @@ Screen::Screen (ScreenSpec const& spec, Graphics const& graphics, Machine& machi
 	QObject::connect (_hide_logo_timer, &QTimer::timeout, this, &Screen::hide_logo);
 	// Start will be called in the showEvent.
 
+	if (_screen_spec.compositor() == ScreenSpec::Compositor::OpenGL)
+	{
+		_gl_compositor = new ScreenGLCompositor (this);
+		_gl_compositor->resize (size());
+		_gl_compositor->show();
+	}
+
 	_refresh_timer = new QTimer (this);
 	_refresh_timer->setSingleShot (false);
 	_refresh_timer->setTimerType (Qt::PreciseTimer);
@@ -121,6 +153,7 @@ Screen::register_instrument (Instrument& instrument, nu::WorkPerformer& work_per
 	{
 		_z_index_order.push_back (&inserted_at->second);
 		sort_by_z_index();
+		Instrument::AccountingAPI (instrument).set_work_performer (&work_performer);
 	}
 }
 
@@ -131,7 +164,12 @@ Screen::deregister_instrument (Instrument& instrument)
 	if (auto* details = find_details (instrument))
 	{
 		wait_for_async_paint (*details);
+
+		if (details->computed_position)
+			_dirty_region += *details->computed_position;
+
 		_instrument_details_map.erase (&instrument);
+		Instrument::AccountingAPI (instrument).set_work_performer (nullptr);
 		auto new_end = std::remove (_z_index_order.begin(), _z_index_order.end(), details);
 		_z_index_order.resize (nu::to_unsigned (new_end - _z_index_order.begin()));
 	}
@@ -147,6 +185,11 @@ Screen::set (Instrument const& instrument, QRectF const requested_position, QPoi
 	{
 		details->requested_position = requested_position;
 		details->anchor_position = anchor_position;
+
+		// New position gets marked dirty when it's computed:
+		if (details->computed_position)
+			_dirty_region += *details->computed_position;
+
 		details->computed_position.reset();
 	}
 }
@@ -166,14 +209,29 @@ Screen::set_z_index (Instrument const& instrument, int const new_z_index)
 	{
 		details->z_index = new_z_index;
 		sort_by_z_index();
+
+		if (details->computed_position)
+			_dirty_region += *details->computed_position;
 	}
 }
 
 
+void
+Screen::set_paint_priority (Instrument const& instrument, PaintPriority const priority)
+{
+	if (auto* details = find_details (instrument))
+		details->priority = priority;
+}
+
+
 void
 Screen::set_paint_bounding_boxes (bool enable)
 {
 	_paint_bounding_boxes = enable;
+	_dirty_region = _canvas.rect();
+
+	if (_gl_compositor)
+		_gl_compositor->set_paint_bounding_boxes (enable);
 }
 
 
@@ -212,9 +270,14 @@ Screen::work_performer_metrics_for (nu::WorkPerformer const& work_performer) con
 void
 Screen::paintEvent (QPaintEvent* paint_event)
 {
+	// OpenGL compositor covers the whole widget:
+	if (_gl_compositor)
+		return;
+
 	QPainter painter (this);
-	auto const rect = paint_event->region().boundingRect();
-	painter.drawImage (rect, _canvas, rect);
+
+	for (auto const& rect: paint_event->region())
+		painter.drawImage (rect, _canvas, rect);
 }
 
 
@@ -222,6 +285,9 @@ void
 Screen::resizeEvent (QResizeEvent* resize_event)
 {
 	update_canvas (resize_event->size());
+
+	if (_gl_compositor)
+		_gl_compositor->resize (resize_event->size());
 }
 
 
@@ -240,6 +306,7 @@ Screen::update_canvas (QSize size)
 	{
 		_canvas = allocate_image (size);
 		_canvas.fill (Qt::black);
+		_dirty_region = _canvas.rect();
 
 		for (auto& [instrument, details]: _instrument_details_map)
 			details.computed_position.reset();
@@ -248,7 +315,7 @@ Screen::update_canvas (QSize size)
 
 
 void
-Screen::paint_logo_to_buffer()
+Screen::prepare_logo_image()
 {
 	auto const lesser_dim = 0.5 * std::min (_canvas.width(), _canvas.height());
 
@@ -259,24 +326,47 @@ Screen::paint_logo_to_buffer()
 		QPainter logo_image_painter (&*_logo_image);
 		QSvgRenderer (QString (global::kLogoPath)).render (&logo_image_painter);
 	}
+}
+
+
+void
+Screen::paint_logo_to_buffer()
+{
+	auto const lesser_dim = 0.5 * std::min (_canvas.width(), _canvas.height());
+
+	prepare_logo_image();
 
 	QPainter canvas_painter (&_canvas);
 	canvas_painter.drawImage (_canvas.rect().center() - 0.5 * QPoint (lesser_dim, lesser_dim), *_logo_image);
 }
 
 
+QRect
+Screen::logo_rect() const
+{
+	auto const lesser_dim = 0.5 * std::min (_canvas.width(), _canvas.height());
+
+	// Add a pixel on each side to account for rounding in paint_logo_to_buffer():
+	return QRect (_canvas.rect().center() - 0.5 * QPoint (lesser_dim, lesser_dim), QSize (lesser_dim, lesser_dim))
+		.adjusted (-1, -1, +1, +1);
+}
+
+
 void
 Screen::update_instruments()
 {
 	QSize const canvas_size = _canvas.size();
 
-	// Ask instruments to paint themselves:
+	// Collect finished paintings:
 	for (auto* const details: _z_index_order)
 	{
 		auto& instrument = details->instrument;
 
 		if (!details->computed_position)
+		{
 			details->compute_position (canvas_size);
+			_dirty_region += *details->computed_position;
+		}
 
 		if (details->computed_position->isValid())
 		{
@@ -291,53 +381,114 @@ Screen::update_instruments()
 						accounting_api.add_painting_time (perf_metrics.painting_time);
 					}
 					// Update per-WorkPerformer metrics:
-					_work_performer_metrics[details->work_performer].start_latencies.push_back (perf_metrics.start_latency);
-					_work_performer_metrics[details->work_performer].total_latencies.push_back (perf_metrics.start_latency + perf_metrics.painting_time);
+					_work_performer_metrics[details->work_performer].add (perf_metrics, _frame_time);
 				});
 
 				std::swap (details->canvas, details->canvas_to_use);
+				_dirty_region += *details->computed_position;
+
+				if (_gl_compositor)
+					_gl_compositor->set_image (instrument, *details->canvas_to_use);
 			}
+		}
+		else
+			std::clog << "Instrument " << identifier (instrument) << " has invalid size/position." << std::endl;
+	}
+
+	// Start new painting jobs, critical instruments first. This only orders jobs submitted
+	// in this refresh; WorkPerformers have no priorities, so jobs queued earlier are still
+	// performed first:
+	for (auto const priority: { PaintPriority::Critical, PaintPriority::Normal, PaintPriority::Low })
+		for (auto* const details: _z_index_order)
+			if (details->priority == priority && details->computed_position && details->computed_position->isValid())
+				request_painting (*details);
+}
 
-			// Start new painting job:
-			if (!details->result.valid() && instrument.dirty_since_last_check())
-			{
-				prepare_canvas_for_instrument (details->canvas, details->computed_position->size());
 
-				PaintRequest::Metric metric (details->computed_position->size(), _screen_spec.pixel_density(), _screen_spec.base_pen_width(), _screen_spec.base_font_height());
-				PaintRequest paint_request (*details->canvas, metric, details->previous_size);
+void
+Screen::request_painting (InstrumentDetails& details)
+{
+	auto& instrument = details.instrument;
 
-				details->previous_size = details->computed_position->size();
+	// Instruments like ADI or HSI only mark themselves dirty when their inputs change visibly,
+	// so make sure they get painted again after the computed size changes (images of other
+	// sizes are discarded by compose_instruments()):
+	if (details.previous_size != details.computed_position->size())
+		instrument.mark_dirty();
 
-				auto task = instrument.paint (std::move (paint_request));
-				auto request_time = nu::utc_now();
-				auto measured_task = [t = std::move (task), request_time]() mutable noexcept {
-					auto const start_time = nu::utc_now();
-					auto const painting_time = nu::measure_time (t);
+	if (details.result.valid() || !instrument.dirty() || should_defer (details) || !instrument.dirty_since_last_check())
+		return;
 
-					return PaintPerformanceMetrics {
-						start_time - request_time,
-						painting_time,
-					};
-				};
+	prepare_canvas_for_instrument (details.canvas, details.computed_position->size());
 
-				details->result = details->work_performer->submit (std::move (measured_task));
-			}
-		}
-		else
-			std::clog << "Instrument " << identifier (instrument) << " has invalid size/position." << std::endl;
+	PaintRequest::Metric metric (details.computed_position->size(), _screen_spec.pixel_density(), _screen_spec.base_pen_width(), _screen_spec.base_font_height());
+	PaintRequest paint_request (*details.canvas, metric, details.previous_size);
+
+	details.previous_size = details.computed_position->size();
+	Instrument::AccountingAPI (instrument).set_canvas_size (details.computed_position->size());
+
+	auto task = instrument.paint (std::move (paint_request));
+	auto request_time = nu::utc_now();
+	auto measured_task = [t = std::move (task), request_time]() mutable noexcept {
+		auto const start_time = nu::utc_now();
+		auto const painting_time = nu::measure_time (t);
+
+		return PaintPerformanceMetrics {
+			start_time - request_time,
+			painting_time,
+		};
+	};
+
+	details.result = details.work_performer->submit (std::move (measured_task));
+}
+
+
+bool
+Screen::should_defer (InstrumentDetails& details)
+{
+	auto const metrics = _work_performer_metrics.find (details.work_performer);
+
+	if (details.priority == PaintPriority::Critical || metrics == _work_performer_metrics.end() || !metrics->second.overloaded)
+	{
+		details.deferred_frames = 0;
+		return false;
+	}
+
+	auto const rate_divider = details.priority == PaintPriority::Normal ? 2u : 4u;
+
+	if (++details.deferred_frames < rate_divider)
+	{
+		++metrics->second.deferred_paints;
+		return true;
 	}
+
+	details.deferred_frames = 0;
+	return false;
 }
 
 
-void
+QRegion
 Screen::compose_instruments()
 {
-	_canvas.fill (Qt::black);
+	// Bounding boxes are painted over instrument borders, so just repaint everything:
+	if (_paint_bounding_boxes)
+		_dirty_region = _canvas.rect();
+
+	auto const region = std::exchange (_dirty_region, QRegion()) & _canvas.rect();
+
+	if (region.isEmpty())
+		return region;
+
 	QPainter canvas_painter (&_canvas);
+	canvas_painter.setClipRegion (region);
+	canvas_painter.setCompositionMode (QPainter::CompositionMode_Source);
+	canvas_painter.fillRect (region.boundingRect(), Qt::black);
+	canvas_painter.setCompositionMode (QPainter::CompositionMode_SourceOver);
 
+	// Repaint all instruments intersecting the region in z-order, so that overlapping ones stay on top:
 	for (auto* const details: _z_index_order)
 	{
-		if (details->computed_position && details->computed_position->isValid())
+		if (details->computed_position && details->computed_position->isValid() && region.intersects (*details->computed_position))
 		{
 			if (auto* painted_image = details->canvas_to_use.get())
 			{
@@ -354,6 +505,40 @@ Screen::compose_instruments()
 			}
 		}
 	}
+
+	return region;
+}
+
+
+void
+Screen::update_gl_compositor()
+{
+	std::vector<ScreenGLCompositor::Placement> placements;
+	placements.reserve (_z_index_order.size());
+
+	for (auto* const details: _z_index_order)
+	{
+		if (details->computed_position && details->computed_position->isValid())
+		{
+			// Skip images that have different size than requested (see compose_instruments()):
+			if (auto* painted_image = details->canvas_to_use.get(); painted_image && painted_image->size() == details->computed_position->size())
+				placements.push_back ({ &details->instrument, *details->computed_position });
+		}
+	}
+
+	_gl_compositor->set_placements (std::move (placements));
+
+	if (_displaying_logo)
+	{
+		prepare_logo_image();
+		_gl_compositor->set_overlay (*_logo_image, QRect (_canvas.rect().center() - 0.5 * QPoint (_logo_image->width(), _logo_image->height()), _logo_image->size()));
+	}
+	else
+		_gl_compositor->reset_overlay();
+
+	// The compositor repaints everything anyway:
+	_dirty_region = QRegion();
+	_gl_compositor->update();
 }
 
 
@@ -426,6 +611,7 @@ Screen::hide_logo()
 {
 	_displaying_logo = false;
 	_logo_image.reset();
+	_dirty_region += logo_rect();
 }
 
 
@@ -433,12 +619,24 @@ void
 Screen::refresh()
 {
 	update_instruments();
-	compose_instruments();
+
+	if (_gl_compositor)
+	{
+		update_gl_compositor();
+		return;
+	}
+
+	// Logo is painted over the instruments, so area under it must be composed again:
+	if (_displaying_logo)
+		_dirty_region += logo_rect();
+
+	auto const updated_region = compose_instruments();
 
 	if (_displaying_logo)
 		paint_logo_to_buffer();
 
-	update();
+	if (!updated_region.isEmpty())
+		update (updated_region);
 }
 
 
@@ -19,6 +19,7 @@
 #include <xefis/core/graphics.h>
 #include <xefis/core/instrument.h>
 #include <xefis/core/machine.h>
+#include <xefis/core/screen_gl_compositor.h>
 #include <xefis/core/screen_spec.h>
 #include <xefis/utility/named_instance.h>
 
@@ -30,6 +31,7 @@
 // Qt:
 #include <QSize>
 #include <QImage>
+#include <QRegion>
 #include <QWidget>
 
 // Standard:
@@ -57,6 +59,22 @@ class PaintPerformanceMetrics
 };
 
 
+/**
+ * Painting priority of an instrument. When a WorkPerformer can't keep up with
+ * the screen refresh rate, instruments with lower priority are painted less often
+ * to leave time for the critical ones.
+ */
+enum class PaintPriority
+{
+	// Primary flight instruments, always painted at full rate:
+	Critical,
+	// Painted at half rate under overload:
+	Normal,
+	// Painted at quarter rate under overload:
+	Low,
+};
+
+
 /**
  * Additional information for each instrument needed by the Screen object,
  * such as its position on the screen.
@@ -70,6 +88,9 @@ class InstrumentDetails
 	std::optional<QRect>					computed_position;
 	QSize									previous_size;
 	int										z_index			{ 0 };
+	PaintPriority							priority		{ PaintPriority::Normal };
+	// Number of frames painting has been deferred because of overload:
+	unsigned int							deferred_frames	{ 0 };
 	// This future returns time it took to paint the instrument:
 	std::future<PaintPerformanceMetrics>	result;
 	// The canvas and canvas_to_use constitute a double-buffer. std::unique_ptr<> is used
@@ -98,12 +119,30 @@ class WorkPerformerMetrics
 {
   public:
 	static constexpr std::size_t kMaxBackLog = 1000;
+	// Number of recent paints used to detect overload:
+	static constexpr std::size_t kOverloadSamples = 10;
+	// Overload ends when recent paints take less than this fraction of the frame budget:
+	static constexpr double kOverloadRecovery = 0.75;
+
+  public:
+	/**
+	 * Record metrics of a finished paint and update the overload state.
+	 * Frame budget is the time in which the paint is expected to finish.
+	 */
+	void
+	add (PaintPerformanceMetrics const&, si::Time frame_budget);
 
   public:
 	// Time between issuing a paint request and actual start of painting:
-	boost::circular_buffer<si::Time>	start_latencies	{ kMaxBackLog };
+	boost::circular_buffer<si::Time>	start_latencies		{ kMaxBackLog };
 	// Metrics of how much time it took to finish the painting since the request was issued:
-	boost::circular_buffer<si::Time>	total_latencies	{ kMaxBackLog };
+	boost::circular_buffer<si::Time>	total_latencies		{ kMaxBackLog };
+	// Number of paints that didn't finish within the frame budget:
+	std::size_t							missed_deadlines	{ 0 };
+	// Number of paints of non-critical instruments postponed because of overload:
+	std::size_t							deferred_paints		{ 0 };
+	// True if recent paints didn't fit in the frame budget:
+	bool								overloaded			{ false };
 };
 
 
@@ -158,6 +197,12 @@ class Screen:
 	void
 	set_z_index (Instrument const&, int z_index);
 
+	/**
+	 * Set painting priority for an instrument. Default is PaintPriority::Normal.
+	 */
+	void
+	set_paint_priority (Instrument const&, PaintPriority);
+
 	/**
 	 * Enable/disable debug bounding boxes of instruments.
 	 */
@@ -217,6 +262,12 @@ class Screen:
 	void
 	update_canvas (QSize);
 
+	/**
+	 * Render SVG logo into _logo_image, unless already rendered.
+	 */
+	void
+	prepare_logo_image();
+
 	/**
 	 * Paint SVG logo.
 	 */
@@ -230,11 +281,34 @@ class Screen:
 	update_instruments();
 
 	/**
-	 * Paint all current instrument canvases onto the main screen canvas.
+	 * Start painting job for the instrument, unless it's not dirty, is being painted already
+	 * or has to be deferred because of overload.
 	 */
 	void
+	request_painting (InstrumentDetails&);
+
+	/**
+	 * Return true if painting of the instrument should be skipped in this frame
+	 * because its WorkPerformer is overloaded.
+	 */
+	[[nodiscard]]
+	bool
+	should_defer (InstrumentDetails&);
+
+	/**
+	 * Paint current instrument canvases onto the main screen canvas, but only
+	 * within the dirty region. Return the region that has been repainted.
+	 */
+	QRegion
 	compose_instruments();
 
+	/**
+	 * Pass current instrument placements and the logo to the OpenGL compositor
+	 * and schedule its repaint.
+	 */
+	void
+	update_gl_compositor();
+
 	/**
 	 * Wait for async paint to be done in an active loop.
 	 */
@@ -254,6 +328,12 @@ class Screen:
 	QImage
 	allocate_image (QSize) const;
 
+	/**
+	 * Return area of the canvas covered by the logo.
+	 */
+	QRect
+	logo_rect() const;
+
 	void
 	sort_by_z_index();
 
@@ -285,6 +365,10 @@ class Screen:
 	QTimer*						_hide_logo_timer;
 	QTimer*						_refresh_timer;
 	QImage						_canvas;
+	// Used instead of _canvas if ScreenSpec::Compositor::OpenGL is selected:
+	ScreenGLCompositor*			_gl_compositor			{ nullptr };
+	// Area of the canvas that needs to be composed again:
+	QRegion						_dirty_region;
 	std::optional<QImage>		_logo_image;
 	InstrumentsSet				_instruments_set;
 	InstrumentDetailsMap		_instrument_details_map;
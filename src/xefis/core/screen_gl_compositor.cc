@@ -0,0 +1,192 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "screen_gl_compositor.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Qt:
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+#include <QSysInfo>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+
+namespace xf {
+
+ScreenGLCompositor::ScreenGLCompositor (QWidget* parent):
+	QOpenGLWidget (parent)
+{
+	setAttribute (Qt::WA_TransparentForMouseEvents);
+	// Everything is repainted in paintGL(), there's no need to keep the framebuffer:
+	setUpdateBehavior (QOpenGLWidget::NoPartialUpdate);
+}
+
+
+ScreenGLCompositor::~ScreenGLCompositor()
+{
+	// Textures must be destroyed with the context current:
+	makeCurrent();
+	_textures.clear();
+	_overlay.texture.reset();
+
+	if (_blitter.isCreated())
+		_blitter.destroy();
+
+	doneCurrent();
+}
+
+
+void
+ScreenGLCompositor::set_image (Instrument const& instrument, QImage const& image)
+{
+	_textures[&instrument].pending_image = image;
+}
+
+
+void
+ScreenGLCompositor::set_placements (std::vector<Placement> placements)
+{
+	_placements = std::move (placements);
+}
+
+
+void
+ScreenGLCompositor::set_overlay (QImage const& image, QRect const position)
+{
+	if (_overlay_cache_key != image.cacheKey())
+	{
+		_overlay.pending_image = image;
+		_overlay_cache_key = image.cacheKey();
+	}
+
+	_overlay_position = position;
+}
+
+
+void
+ScreenGLCompositor::reset_overlay()
+{
+	_overlay.pending_image.reset();
+	_overlay_position.reset();
+	_overlay_cache_key.reset();
+}
+
+
+void
+ScreenGLCompositor::initializeGL()
+{
+	_blitter.create();
+}
+
+
+void
+ScreenGLCompositor::paintGL()
+{
+	auto* const gl = context()->functions();
+
+	// Release textures of instruments that are no longer shown:
+	std::erase_if (_textures, [this] (auto const& pair) {
+		return std::none_of (_placements.begin(), _placements.end(), [&] (Placement const& placement) {
+			return placement.instrument == pair.first;
+		});
+	});
+
+	for (auto& [instrument, texture]: _textures)
+		upload (texture);
+
+	if (_overlay_position)
+		upload (_overlay);
+	else
+		_overlay.texture.reset();
+
+	gl->glClearColor (0.0f, 0.0f, 0.0f, 1.0f);
+	gl->glClear (GL_COLOR_BUFFER_BIT);
+	// Instrument images have premultiplied alpha:
+	gl->glEnable (GL_BLEND);
+	gl->glBlendFunc (GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	_blitter.bind();
+
+	for (auto const& placement: _placements)
+		if (auto const texture = _textures.find (placement.instrument); texture != _textures.end())
+			blit (texture->second, placement.position);
+
+	if (_overlay_position)
+		blit (_overlay, *_overlay_position);
+
+	_blitter.release();
+	gl->glDisable (GL_BLEND);
+
+	if (_paint_bounding_boxes)
+	{
+		QPainter painter (this);
+		painter.setPen (QPen (QBrush (Qt::red), 2.0));
+
+		for (auto const& placement: _placements)
+			painter.drawRect (placement.position);
+	}
+}
+
+
+void
+ScreenGLCompositor::upload (Texture& texture)
+{
+	if (!texture.pending_image)
+		return;
+
+	auto image = *std::exchange (texture.pending_image, std::nullopt);
+
+	if (image.isNull())
+		return;
+
+	if (!texture.texture || texture.texture->width() != image.width() || texture.texture->height() != image.height())
+	{
+		texture.texture = std::make_unique<QOpenGLTexture> (QOpenGLTexture::Target2D);
+		texture.texture->setFormat (QOpenGLTexture::RGBA8_UNorm);
+		texture.texture->setSize (image.width(), image.height());
+		// Textures are blitted 1:1, no filtering needed:
+		texture.texture->setMinMagFilters (QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+		texture.texture->setWrapMode (QOpenGLTexture::ClampToEdge);
+		texture.texture->allocateStorage (QOpenGLTexture::BGRA, QOpenGLTexture::UInt8);
+	}
+
+	// ARGB32 pixels are BGRA bytes on little-endian machines, so they can be uploaded without conversion:
+	if (QSysInfo::ByteOrder == QSysInfo::LittleEndian && image.format() == QImage::Format_ARGB32_Premultiplied)
+		texture.texture->setData (QOpenGLTexture::BGRA, QOpenGLTexture::UInt8, image.constBits());
+	else
+	{
+		image.convertTo (QImage::Format_RGBA8888_Premultiplied);
+		texture.texture->setData (QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, image.constBits());
+	}
+}
+
+
+void
+ScreenGLCompositor::blit (Texture const& texture, QRect const position)
+{
+	if (texture.texture)
+	{
+		auto const target = QOpenGLTextureBlitter::targetTransform (position, rect());
+		_blitter.blit (texture.texture->textureId(), target, QOpenGLTextureBlitter::OriginTopLeft);
+	}
+}
+
+} // namespace xf
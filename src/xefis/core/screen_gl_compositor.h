@@ -0,0 +1,143 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__CORE__SCREEN_GL_COMPOSITOR_H__INCLUDED
+#define XEFIS__CORE__SCREEN_GL_COMPOSITOR_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Qt:
+#include <QImage>
+#include <QOpenGLTexture>
+#include <QOpenGLTextureBlitter>
+#include <QOpenGLWidget>
+#include <QRect>
+
+// Standard:
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace xf {
+
+class Instrument;
+
+
+/**
+ * OpenGL compositor for the Screen. Each instrument image is kept in its own texture,
+ * which is uploaded only when the instrument delivers a new image. Textures are then
+ * blended by OpenGL in z-order directly into the widget, so there's no full-frame
+ * copy on the CPU side. Works with software implementations like Mesa's llvmpipe.
+ */
+class ScreenGLCompositor: public QOpenGLWidget
+{
+  public:
+	/**
+	 * Position of an instrument image on the screen.
+	 */
+	class Placement
+	{
+	  public:
+		Instrument const*	instrument;
+		QRect				position;
+	};
+
+  private:
+	class Texture
+	{
+	  public:
+		std::unique_ptr<QOpenGLTexture>	texture;
+		// Image waiting to be uploaded. QImage data is implicitly shared, so this is not a copy:
+		std::optional<QImage>			pending_image;
+	};
+
+  public:
+	// Ctor
+	explicit
+	ScreenGLCompositor (QWidget* parent);
+
+	// Dtor
+	~ScreenGLCompositor();
+
+	/**
+	 * Set new image of an instrument. It will be uploaded to the texture on next paint.
+	 */
+	void
+	set_image (Instrument const&, QImage const&);
+
+	/**
+	 * Set instruments to composite, ordered by z-index (the bottom one first).
+	 * Textures of instruments not on the list are released.
+	 */
+	void
+	set_placements (std::vector<Placement>);
+
+	/**
+	 * Set image painted over all instruments (eg. the logo).
+	 * Image is uploaded again only if it's a different image than the last one.
+	 */
+	void
+	set_overlay (QImage const&, QRect position);
+
+	/**
+	 * Remove the overlay image.
+	 */
+	void
+	reset_overlay();
+
+	/**
+	 * Enable/disable debug bounding boxes of instruments.
+	 */
+	void
+	set_paint_bounding_boxes (bool enable) noexcept
+		{ _paint_bounding_boxes = enable; }
+
+  protected:
+	// QOpenGLWidget API
+	void
+	initializeGL() override;
+
+	// QOpenGLWidget API
+	void
+	paintGL() override;
+
+  private:
+	/**
+	 * Upload pending image to the texture, (re)creating the texture if needed.
+	 */
+	static void
+	upload (Texture&);
+
+	/**
+	 * Blit the texture onto given position on the widget.
+	 */
+	void
+	blit (Texture const&, QRect position);
+
+  private:
+	QOpenGLTextureBlitter							_blitter;
+	std::vector<Placement>							_placements;
+	std::unordered_map<Instrument const*, Texture>	_textures;
+	Texture											_overlay;
+	std::optional<QRect>							_overlay_position;
+	std::optional<qint64>							_overlay_cache_key;
+	bool											_paint_bounding_boxes	{ false };
+};
+
+} // namespace xf
+
+#endif
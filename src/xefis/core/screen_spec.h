@@ -34,6 +34,18 @@ namespace xf {
  */
 class ScreenSpec
 {
+  public:
+	/**
+	 * Method of compositing instrument images onto the screen.
+	 */
+	enum class Compositor
+	{
+		// QPainter into a QImage, blitted to the widget:
+		Raster,
+		// Each instrument image is an OpenGL texture, composited by OpenGL:
+		OpenGL,
+	};
+
   public:
 	// Ctor
 	explicit
@@ -92,6 +104,21 @@ class ScreenSpec
 	void
 	set_scale (float factor);
 
+	/**
+	 * Return compositor to use.
+	 */
+	[[nodiscard]]
+	Compositor
+	compositor() const noexcept
+		{ return _compositor; }
+
+	/**
+	 * Set compositor to use. Default is Compositor::Raster.
+	 */
+	void
+	set_compositor (Compositor compositor) noexcept
+		{ _compositor = compositor; }
+
   private:
 	float				_scale				{ 1.0f };
 	// Qt doesn't seem to scale fonts correctly, this is to mitigate that problem:
@@ -102,6 +129,7 @@ class ScreenSpec
 	si::Length			_base_pen_width;
 	si::Length			_base_font_height;
 	si::PixelDensity	_pixel_density;
+	Compositor			_compositor			{ Compositor::Raster };
 };
 
 
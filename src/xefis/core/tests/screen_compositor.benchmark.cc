@@ -0,0 +1,231 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/graphics.h>
+#include <xefis/core/screen_gl_compositor.h>
+#include <xefis/modules/instruments/label.h>
+#include <xefis/test/benchmark.h>
+#include <xefis/test/test_processing_loop.h>
+
+// Qt:
+#include <QImage>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+#include <QRegion>
+
+// Standard:
+#include <array>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+constexpr size_t kFrames = 300;
+
+
+/**
+ * Instrument placements relative to the screen size, similar to the test instruments machine.
+ */
+std::vector<QRectF> const kLayout {
+	{ 0.00, 0.00, 0.40, 0.60 },		// ADI
+	{ 0.40, 0.00, 0.40, 0.60 },		// HSI
+	{ 0.00, 0.60, 0.15, 0.20 },		// Radial gauges
+	{ 0.15, 0.60, 0.15, 0.20 },
+	{ 0.30, 0.60, 0.15, 0.20 },
+	{ 0.45, 0.60, 0.15, 0.20 },
+	{ 0.60, 0.60, 0.15, 0.10 },		// Linear gauges
+	{ 0.60, 0.70, 0.15, 0.10 },
+	{ 0.80, 0.00, 0.20, 0.40 },		// Datatable
+	{ 0.80, 0.40, 0.10, 0.15 },		// Gear
+	{ 0.90, 0.40, 0.10, 0.20 },		// Flaps
+	{ 0.80, 0.60, 0.10, 0.12 },		// Trims
+	{ 0.90, 0.60, 0.08, 0.12 },
+};
+
+
+/**
+ * Placement and two versions of an instrument image. Versions are alternated each frame,
+ * so that every frame gets a new image to composite. The instrument is only used to identify
+ * images in the OpenGL compositor, it never paints.
+ */
+struct InstrumentImages
+{
+	std::unique_ptr<Instrument>	instrument;
+	QRect						position;
+	std::array<QImage, 2>		images;
+};
+
+
+std::vector<InstrumentImages>
+make_instruments (ProcessingLoop& loop, Graphics const& graphics, QSize const screen_size)
+{
+	std::vector<InstrumentImages> instruments;
+
+	for (auto const& relative: kLayout)
+	{
+		auto const position = QRectF (relative.x() * screen_size.width(), relative.y() * screen_size.height(),
+									  relative.width() * screen_size.width(), relative.height() * screen_size.height()).toRect();
+		auto& instrument = instruments.emplace_back (std::make_unique<Label> (loop, graphics), position);
+
+		for (std::size_t version = 0; version < instrument.images.size(); ++version)
+		{
+			auto& image = instrument.images[version];
+			image = QImage (position.size(), QImage::Format_ARGB32_Premultiplied);
+			image.fill (Qt::transparent);
+
+			QPainter painter (&image);
+			painter.setRenderHint (QPainter::Antialiasing, true);
+			painter.setPen (QPen (version == 0 ? Qt::white : Qt::green, 2.0));
+			painter.setBrush (QColor (0x20, 0x20, 0x40, 0x80));
+			painter.drawEllipse (image.rect().adjusted (2, 2, -2, -2));
+			painter.drawText (image.rect(), Qt::AlignCenter, QString ("%1").arg (version));
+		}
+	}
+
+	return instruments;
+}
+
+
+/**
+ * Gives access to paintGL(), so that compositing can be timed without going through
+ * the widget's event loop.
+ */
+class BenchmarkedGLCompositor: public ScreenGLCompositor
+{
+  public:
+	using ScreenGLCompositor::ScreenGLCompositor;
+	using ScreenGLCompositor::paintGL;
+};
+
+
+/**
+ * Measure the Raster compositor: instruments intersecting the updated region are composed
+ * into the screen canvas, which is then copied to the widget's backing store, like Screen
+ * does in compose_instruments() and paintEvent().
+ *
+ * \param	updated
+ *			Number of instruments (from the first one) that deliver a new image each frame.
+ */
+void
+benchmark_raster (Benchmark& benchmark, std::string_view const label, QSize const screen_size, std::vector<InstrumentImages> const& instruments, std::size_t const updated)
+{
+	QImage canvas (screen_size, QImage::Format_ARGB32_Premultiplied);
+	QImage backing_store (screen_size, QImage::Format_RGB32);
+	std::size_t frame = 0;
+
+	benchmark.measure (label, kFrames, [&] {
+		auto const version = frame++ % 2;
+		QRegion region;
+
+		for (std::size_t i = 0; i < updated; ++i)
+			region += instruments[i].position;
+
+		{
+			QPainter canvas_painter (&canvas);
+			canvas_painter.setClipRegion (region);
+			canvas_painter.setCompositionMode (QPainter::CompositionMode_Source);
+			canvas_painter.fillRect (region.boundingRect(), Qt::black);
+			canvas_painter.setCompositionMode (QPainter::CompositionMode_SourceOver);
+
+			for (std::size_t i = 0; i < instruments.size(); ++i)
+				if (region.intersects (instruments[i].position))
+					canvas_painter.drawImage (instruments[i].position, instruments[i].images[i < updated ? version : 0]);
+		}
+
+		QPainter backing_store_painter (&backing_store);
+
+		for (auto const& rect: region)
+			backing_store_painter.drawImage (rect, canvas, rect);
+	});
+}
+
+
+/**
+ * Measure the OpenGL compositor with the same workload as benchmark_raster(). Waits for
+ * OpenGL to finish each frame, so that software renderers are timed correctly.
+ * Return false if there's no OpenGL available.
+ */
+bool
+benchmark_opengl (Benchmark& benchmark, std::string_view const label, QSize const screen_size, std::vector<InstrumentImages> const& instruments, std::size_t const updated)
+{
+	BenchmarkedGLCompositor compositor (nullptr);
+	compositor.resize (screen_size);
+	// Creates the context and the framebuffer and calls initializeGL():
+	compositor.grabFramebuffer();
+
+	if (!compositor.context() || !compositor.context()->isValid())
+		return false;
+
+	std::vector<ScreenGLCompositor::Placement> placements;
+
+	for (auto const& instrument: instruments)
+	{
+		placements.push_back ({ instrument.instrument.get(), instrument.position });
+		compositor.set_image (*instrument.instrument, instrument.images[0]);
+	}
+
+	compositor.set_placements (std::move (placements));
+	std::size_t frame = 0;
+
+	benchmark.measure (label, kFrames, [&] {
+		auto const version = frame++ % 2;
+
+		for (std::size_t i = 0; i < updated; ++i)
+			compositor.set_image (*instruments[i].instrument, instruments[i].images[version]);
+
+		compositor.makeCurrent();
+		compositor.paintGL();
+		compositor.context()->functions()->glFinish();
+		compositor.doneCurrent();
+	});
+
+	return true;
+}
+
+
+xf::Benchmark b1 ("Screen: compositing, Raster vs. OpenGL", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (1 / 60_Hz);
+	Graphics graphics (TestProcessingLoop::logger);
+	bool opengl_available = true;
+
+	for (auto const screen_size: { QSize (1366, 768), QSize (2560, 1600) })
+	{
+		auto const instruments = make_instruments (loop, graphics, screen_size);
+		auto const screen_name = std::format ("{}×{}", screen_size.width(), screen_size.height());
+
+		for (auto const& [scenario, updated]: { std::pair ("all instruments updated", instruments.size()), std::pair ("ADI updated", 1uz) })
+		{
+			benchmark_raster (benchmark, std::format ("{}, {}, Raster", screen_name, scenario), screen_size, instruments, updated);
+
+			if (opengl_available && !benchmark_opengl (benchmark, std::format ("{}, {}, OpenGL", screen_name, scenario), screen_size, instruments, updated))
+			{
+				std::clog << "OpenGL is not available, skipping OpenGL compositor. To run it on llvmpipe use eg.:\n"
+							 "  QT_QPA_PLATFORM=xcb LIBGL_ALWAYS_SOFTWARE=1 GALLIUM_DRIVER=llvmpipe" << std::endl;
+				opengl_available = false;
+			}
+		}
+	}
+});
+
+} // namespace
+} // namespace xf::test
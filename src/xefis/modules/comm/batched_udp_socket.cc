@@ -0,0 +1,248 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "batched_udp_socket.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// System:
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <unistd.h>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <string>
+
+
+BatchedUDPSocket::BatchedUDPSocket (Parameters const& parameters, nu::Logger const& logger):
+	_parameters (parameters),
+	_logger (logger)
+{
+	_parameters.batch_size = std::max<std::size_t> (_parameters.batch_size, 1);
+
+	auto const n = _parameters.batch_size;
+	auto const size = _parameters.max_datagram_size;
+
+	_rx_buffer.resize (n * size);
+	_rx_iovecs.resize (n);
+	_rx_headers.resize (n);
+	_rx_datagrams.resize (n);
+	_tx_buffer.resize (n * size);
+	_tx_iovecs.resize (n);
+	_tx_headers.resize (n);
+
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		_rx_iovecs[i] = { .iov_base = _rx_buffer.data() + i * size, .iov_len = size };
+		_rx_headers[i] = {};
+		_rx_headers[i].msg_hdr.msg_iov = &_rx_iovecs[i];
+		_rx_headers[i].msg_hdr.msg_iovlen = 1;
+
+		_tx_iovecs[i] = { .iov_base = _tx_buffer.data() + i * size, .iov_len = 0 };
+		_tx_headers[i] = {};
+		_tx_headers[i].msg_hdr.msg_iov = &_tx_iovecs[i];
+		_tx_headers[i].msg_hdr.msg_iovlen = 1;
+		_tx_headers[i].msg_hdr.msg_name = &_destination;
+	}
+}
+
+
+BatchedUDPSocket::~BatchedUDPSocket()
+{
+	if (_fd >= 0)
+		::close (_fd);
+}
+
+
+bool
+BatchedUDPSocket::bind (std::string const& host, uint16_t const port)
+{
+	sockaddr_storage address;
+	socklen_t address_length;
+
+	if (!resolve (host, port, address, address_length) || !open_socket (address.ss_family))
+		return false;
+
+	if (::bind (_fd, reinterpret_cast<sockaddr const*> (&address), address_length) != 0)
+	{
+		log_error (std::format ("failed to bind to address {}:{}", host, port));
+		return false;
+	}
+
+	return true;
+}
+
+
+bool
+BatchedUDPSocket::set_destination (std::string const& host, uint16_t const port)
+{
+	if (!resolve (host, port, _destination, _destination_length) || !open_socket (_destination.ss_family))
+		return false;
+
+	for (auto& header: _tx_headers)
+		header.msg_hdr.msg_namelen = _destination_length;
+
+	return true;
+}
+
+
+std::span<BatchedUDPSocket::Datagram const>
+BatchedUDPSocket::receive_batch()
+{
+	if (_fd < 0)
+		return {};
+
+	for (auto& header: _rx_headers)
+		header.msg_hdr.msg_flags = 0;
+
+	auto const received = ::recvmmsg (_fd, _rx_headers.data(), _rx_headers.size(), MSG_DONTWAIT, nullptr);
+
+	if (received < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			log_error ("recvmmsg() failed");
+
+		return {};
+	}
+
+	auto const count = static_cast<std::size_t> (received);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		auto const& header = _rx_headers[i];
+		auto const length = std::min<std::size_t> (header.msg_len, _parameters.max_datagram_size);
+
+		_rx_datagrams[i] = {
+			.data = std::string_view (static_cast<char const*> (header.msg_hdr.msg_iov->iov_base), length),
+			.truncated = (header.msg_hdr.msg_flags & MSG_TRUNC) != 0,
+		};
+	}
+
+	return std::span (_rx_datagrams).first (count);
+}
+
+
+bool
+BatchedUDPSocket::queue (std::string_view const datagram)
+{
+	if (datagram.size() > _parameters.max_datagram_size || _tx_queued == _tx_headers.size())
+		return false;
+
+	auto const slot = (_tx_head + _tx_queued) % _tx_headers.size();
+	auto& iovec = _tx_iovecs[slot];
+	std::copy (datagram.begin(), datagram.end(), static_cast<char*> (iovec.iov_base));
+	iovec.iov_len = datagram.size();
+	++_tx_queued;
+
+	return true;
+}
+
+
+std::size_t
+BatchedUDPSocket::flush()
+{
+	std::size_t sent_bytes = 0;
+
+	if (_fd < 0 || _destination_length == 0)
+		return sent_bytes;
+
+	while (_tx_queued > 0)
+	{
+		// Send the contiguous part of the ring up to its end; the wrapped part goes with the next iteration:
+		auto const contiguous = std::min (_tx_queued, _tx_headers.size() - _tx_head);
+		auto const sent = ::sendmmsg (_fd, _tx_headers.data() + _tx_head, contiguous, MSG_DONTWAIT);
+
+		if (sent <= 0)
+		{
+			if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				log_error ("sendmmsg() failed; dropping queued datagrams");
+				_tx_head = 0;
+				_tx_queued = 0;
+			}
+
+			break;
+		}
+
+		for (int i = 0; i < sent; ++i)
+			sent_bytes += _tx_headers[_tx_head + i].msg_len;
+
+		_tx_head = (_tx_head + sent) % _tx_headers.size();
+		_tx_queued -= sent;
+	}
+
+	return sent_bytes;
+}
+
+
+bool
+BatchedUDPSocket::open_socket (int const family)
+{
+	if (_fd >= 0)
+		return true;
+
+	_fd = ::socket (family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (_fd < 0)
+	{
+		log_error ("failed to create UDP socket");
+		return false;
+	}
+
+	// Same as QUdpSocket::ShareAddress:
+	int const enable = 1;
+
+	if (::setsockopt (_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof (enable)) != 0)
+		log_error ("failed to set SO_REUSEADDR");
+
+	return true;
+}
+
+
+bool
+BatchedUDPSocket::resolve (std::string const& host, uint16_t const port, sockaddr_storage& result, socklen_t& result_length)
+{
+	addrinfo hints {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV | AI_PASSIVE;
+
+	addrinfo* addresses = nullptr;
+	auto const port_string = std::to_string (port);
+
+	if (auto const error = ::getaddrinfo (host.c_str(), port_string.c_str(), &hints, &addresses); error != 0)
+	{
+		_logger << std::format ("Invalid address {}:{}: {}\n", host, port, ::gai_strerror (error));
+		return false;
+	}
+
+	std::memcpy (&result, addresses->ai_addr, addresses->ai_addrlen);
+	result_length = addresses->ai_addrlen;
+	::freeaddrinfo (addresses);
+
+	return true;
+}
+
+
+void
+BatchedUDPSocket::log_error (std::string_view const what)
+{
+	_logger << std::format ("{}: {}\n", what, ::strerror (errno));
+}
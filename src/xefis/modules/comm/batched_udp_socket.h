@@ -0,0 +1,152 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__MODULES__COMM__BATCHED_UDP_SOCKET_H__INCLUDED
+#define XEFIS__MODULES__COMM__BATCHED_UDP_SOCKET_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/logger.h>
+
+// System:
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * Non-blocking UDP socket that receives and sends datagrams in batches with Linux recvmmsg()/sendmmsg().
+ * All buffers are preallocated in the constructor, so that steady-state operation doesn't allocate.
+ * Not thread-safe.
+ */
+class BatchedUDPSocket
+{
+  public:
+	struct Parameters
+	{
+		// Max number of datagrams received/sent with a single system call. Also the size
+		// of the transmit queue:
+		std::size_t	batch_size			{ 32 };
+
+		// Datagrams larger than this are truncated on receive (and reported as such)
+		// and rejected on send:
+		std::size_t	max_datagram_size	{ 2048 };
+	};
+
+	struct Datagram
+	{
+		std::string_view	data;
+		bool				truncated	{ false };
+	};
+
+  public:
+	// Ctor
+	explicit
+	BatchedUDPSocket (Parameters const&, nu::Logger const&);
+
+	// Dtor
+	~BatchedUDPSocket();
+
+	BatchedUDPSocket (BatchedUDPSocket const&) = delete;
+
+	BatchedUDPSocket&
+	operator= (BatchedUDPSocket const&) = delete;
+
+	/**
+	 * Create a socket and bind it to given numeric address for receiving.
+	 * Return false and log the error on failure.
+	 */
+	bool
+	bind (std::string const& host, uint16_t port);
+
+	/**
+	 * Create a socket (if not bound already) and set destination address for sent datagrams.
+	 * Return false and log the error on failure.
+	 */
+	bool
+	set_destination (std::string const& host, uint16_t port);
+
+	/**
+	 * Receive next batch of datagrams without blocking. Returned views are valid until the next call.
+	 * Empty result means there are no more pending datagrams.
+	 */
+	[[nodiscard]]
+	std::span<Datagram const>
+	receive_batch();
+
+	/**
+	 * Queue datagram for sending with the next flush().
+	 * Return false if datagram is too large or the queue is full.
+	 */
+	bool
+	queue (std::string_view datagram);
+
+	/**
+	 * Send as many queued datagrams as the socket accepts without blocking.
+	 * Datagrams that couldn't be sent stay queued for the next flush().
+	 *
+	 * \returns	number of bytes sent.
+	 */
+	std::size_t
+	flush();
+
+	/**
+	 * Return number of datagrams waiting in the transmit queue.
+	 */
+	[[nodiscard]]
+	std::size_t
+	queued() const noexcept
+		{ return _tx_queued; }
+
+  private:
+	bool
+	open_socket (int family);
+
+	/**
+	 * Convert numeric host address and port to sockaddr_storage.
+	 */
+	bool
+	resolve (std::string const& host, uint16_t port, sockaddr_storage& result, socklen_t& result_length);
+
+	void
+	log_error (std::string_view what);
+
+  private:
+	Parameters					_parameters;
+	nu::Logger					_logger;
+	int							_fd						{ -1 };
+	sockaddr_storage			_destination			{ };
+	socklen_t					_destination_length		{ 0 };
+	// Receive ring:
+	std::vector<char>			_rx_buffer;
+	std::vector<iovec>			_rx_iovecs;
+	std::vector<mmsghdr>		_rx_headers;
+	std::vector<Datagram>		_rx_datagrams;
+	// Transmit ring; _tx_head is the oldest queued datagram:
+	std::vector<char>			_tx_buffer;
+	std::vector<iovec>			_tx_iovecs;
+	std::vector<mmsghdr>		_tx_headers;
+	std::size_t					_tx_head				{ 0 };
+	std::size_t					_tx_queued				{ 0 };
+};
+
+#endif
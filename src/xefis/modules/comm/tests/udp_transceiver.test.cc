@@ -0,0 +1,123 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/sockets/tests/test_cycle.h>
+#include <xefis/modules/comm/batched_udp_socket.h>
+#include <xefis/modules/comm/udp_transceiver.h>
+#include <xefis/test/test_processing_loop.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <cstddef>
+#include <string>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+using namespace nu::si::literals;
+
+
+nu::AutoTest t_1 ("BatchedUDPSocket: sends and receives batches over loopback", []{
+	auto const parameters = BatchedUDPSocket::Parameters { .batch_size = 4, .max_datagram_size = 16 };
+	auto rx = BatchedUDPSocket (parameters, TestProcessingLoop::logger);
+	auto tx = BatchedUDPSocket (parameters, TestProcessingLoop::logger);
+
+	test_asserts::verify ("rx socket binds", rx.bind ("127.0.0.1", 45'401));
+	test_asserts::verify ("tx socket sets destination", tx.set_destination ("127.0.0.1", 45'401));
+
+	// Fill the ring twice to exercise wrapping:
+	std::string received;
+
+	for (auto const* round: { "abcd", "efgh" })
+	{
+		for (auto const* c = round; *c; ++c)
+			test_asserts::verify ("datagram queued", tx.queue (std::string (1, *c)));
+
+		test_asserts::verify ("queue is bounded by batch size", !tx.queue ("x"));
+		test_asserts::verify_equal ("all bytes sent", tx.flush(), std::size_t (4));
+		test_asserts::verify_equal ("nothing left queued", tx.queued(), std::size_t (0));
+	}
+
+	test_asserts::verify ("oversized datagram is rejected", !tx.queue (std::string (17, 'x')));
+
+	for (auto batch = rx.receive_batch(); !batch.empty(); batch = rx.receive_batch())
+	{
+		test_asserts::verify ("batch is not larger than batch size", batch.size() <= 4u);
+
+		for (auto const& datagram: batch)
+			received += datagram.data;
+	}
+
+	test_asserts::verify_equal ("all datagrams received in order", received, std::string ("abcdefgh"));
+});
+
+
+nu::AutoTest t_2 ("UDPTransceiver: batched I/O over loopback", []{
+	auto loop = TestProcessingLoop (1_ms);
+	auto cycle = TestCycle();
+	auto udp = UDPTransceiver (loop, {
+		.rx_udp_address = UDPTransceiver::Address { "127.0.0.1", 45'402 },
+		.tx_udp_address = UDPTransceiver::Address { "127.0.0.1", 45'402 },
+		.batched_io = true,
+	}, TestProcessingLoop::logger, "udp");
+
+	for (auto const* payload: { "first", "second", "third" })
+	{
+		udp.send << std::string (payload);
+		udp.send.fetch (cycle += 1_ms);
+		udp.process (cycle);
+	}
+
+	udp.communicate (cycle += 1_ms);
+	test_asserts::verify_equal ("datagrams received within a cycle are concatenated", udp.receive.value_or (""), std::string ("firstsecondthird"));
+
+	udp.communicate (cycle += 1_ms);
+	test_asserts::verify_equal ("receive output is kept when nothing new arrives", udp.receive.value_or (""), std::string ("firstsecondthird"));
+});
+
+
+nu::AutoTest t_3 ("UDPTransceiver: batched I/O keeps the interference hook", []{
+	auto loop = TestProcessingLoop (1_ms);
+	auto cycle = TestCycle();
+	auto udp = UDPTransceiver (loop, {
+		.rx_udp_address = UDPTransceiver::Address { "127.0.0.1", 45'403 },
+		.tx_udp_address = UDPTransceiver::Address { "127.0.0.1", 45'403 },
+		.tx_interference = true,
+		.batched_io = true,
+	}, TestProcessingLoop::logger, "udp");
+
+	std::size_t sent_bytes = 0;
+
+	for (std::size_t i = 0; i < 100; ++i)
+	{
+		auto const payload = std::string ("0123456789");
+		sent_bytes += payload.size();
+		udp.send << payload;
+		udp.send.fetch (cycle += 1_ms);
+		udp.process (cycle);
+	}
+
+	udp.communicate (cycle += 1_ms);
+	auto const received_bytes = udp.receive.value_or ("").size();
+	test_asserts::verify ("interference removed some bytes", received_bytes < sent_bytes);
+	test_asserts::verify ("interference removed at most one byte per datagram", received_bytes >= sent_bytes - 100);
+});
+
+} // namespace
+} // namespace xf::test
@@ -48,6 +48,23 @@ UDPTransceiver::UDPTransceiver (xf::ProcessingLoop& loop, Parameters const param
 		.transmitted_bandwidth = xf::BandwidthSampler ({ parameters.bandwidth_measurement_interval, parameters.bandwidth_history_size }),
 	})
 {
+	if (_parameters.batched_io)
+	{
+		if (_parameters.tx_udp_address)
+		{
+			_batched_tx = std::make_unique<BatchedUDPSocket> (_parameters.batched_io_parameters, _logger);
+			_batched_tx->set_destination (_parameters.tx_udp_address->host, gsl::narrow<uint16_t> (_parameters.tx_udp_address->port));
+		}
+
+		if (_parameters.rx_udp_address)
+		{
+			_batched_rx = std::make_unique<BatchedUDPSocket> (_parameters.batched_io_parameters, _logger);
+			_batched_rx->bind (_parameters.rx_udp_address->host, gsl::narrow<uint16_t> (_parameters.rx_udp_address->port));
+		}
+
+		return;
+	}
+
 	if (_parameters.tx_udp_address)
 	{
 		_tx_qhostaddress = QHostAddress (nu::to_qstring (_parameters.tx_udp_address->host));
@@ -76,6 +93,46 @@ UDPTransceiver::bandwidth_snapshot() const
 }
 
 
+void
+UDPTransceiver::communicate (xf::Cycle const&)
+{
+	if (!_batched_rx)
+		return;
+
+	std::size_t received_bytes = 0u;
+	_received_batch.clear();
+
+	for (auto batch = _batched_rx->receive_batch(); !batch.empty(); batch = _batched_rx->receive_batch())
+	{
+		for (auto const& datagram: batch)
+		{
+			received_bytes += datagram.data.size();
+
+			if (datagram.truncated)
+			{
+				_logger << "Dropping truncated datagram; max_datagram_size is too small\n";
+				continue;
+			}
+
+			if (_parameters.rx_interference)
+			{
+				_interference_buffer.assign (datagram.data);
+				interfere (_interference_buffer);
+				_received_batch += _interference_buffer;
+			}
+			else
+				_received_batch += datagram.data;
+		}
+	}
+
+	if (received_bytes > 0u)
+		_bandwidth_accounting.pending_received_bytes += received_bytes;
+
+	if (!_received_batch.empty())
+		this->receive = _received_batch;
+}
+
+
 void
 UDPTransceiver::process (xf::Cycle const& cycle)
 {
@@ -89,7 +146,14 @@ UDPTransceiver::process (xf::Cycle const& cycle)
 	else
 		_bandwidth_accounting.received_bandwidth.flush (cycle.update_time());
 
-	if (_tx && _parameters.tx_udp_address)
+	if (_batched_tx)
+	{
+		if (this->send)
+			send_batched (*this->send, cycle);
+		else if (_batched_tx->queued() > 0)
+			_bandwidth_accounting.transmitted_bandwidth.record_bytes (_batched_tx->flush(), cycle.update_time());
+	}
+	else if (_tx && _parameters.tx_udp_address)
 	{
 		if (this->send)
 		{
@@ -142,12 +206,37 @@ UDPTransceiver::got_udp_packet()
 
 
 void
-UDPTransceiver::interfere (QByteArray& blob)
+UDPTransceiver::send_batched (std::string const& data, xf::Cycle const& cycle)
 {
-	if (!blob.isEmpty() && rand() % 3 == 0)
+	bool queued;
+
+	if (_parameters.tx_interference)
 	{
-		// Erase random byte from the input sequence:
-		int i = rand() % blob.size();
-		blob.remove (i, 1);
+		_interference_buffer.assign (data);
+		interfere (_interference_buffer);
+		queued = _batched_tx->queue (_interference_buffer);
 	}
+	else
+		queued = _batched_tx->queue (data);
+
+	if (!queued)
+		_logger << std::format ("Dropping datagram of {} bytes: too large or transmit queue full\n", data.size());
+
+	auto const written = _batched_tx->flush();
+
+	if (written > 0)
+		_bandwidth_accounting.transmitted_bandwidth.record_bytes (written, cycle.update_time());
 }
+
+
+template<class Blob>
+	void
+	UDPTransceiver::interfere (Blob& blob)
+	{
+		if (!blob.empty() && rand() % 3 == 0)
+		{
+			// Erase random byte from the input sequence:
+			auto const i = rand() % blob.size();
+			blob.erase (blob.begin() + i, blob.begin() + i + 1);
+		}
+	}
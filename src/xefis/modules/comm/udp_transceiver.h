@@ -19,6 +19,7 @@
 #include <xefis/core/module.h>
 #include <xefis/core/setting.h>
 #include <xefis/core/sockets/module_socket.h>
+#include <xefis/modules/comm/batched_udp_socket.h>
 #include <xefis/support/properties/has_configurator_widget.h>
 #include <xefis/support/stats/bandwidth_sampler.h>
 
@@ -31,6 +32,8 @@
 
 // Standard:
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
 
@@ -75,6 +78,12 @@ class UDPTransceiver:
 
 		// Whether to randomly interfere with received data:
 		bool					tx_interference					{ false }; // TODO std::optional<float> tx_interference_probability;
+
+		// Linux only: use non-blocking sockets with recvmmsg()/sendmmsg() instead of QUdpSocket.
+		// Received datagrams are drained in communicate() and all datagrams received within
+		// a cycle are concatenated on the receive output:
+		bool							batched_io				{ false };
+		BatchedUDPSocket::Parameters	batched_io_parameters	{ };
 	};
 
 	using Bandwidth = xf::BandwidthSampler::Bandwidth;
@@ -104,6 +113,10 @@ class UDPTransceiver:
 	BandwidthSnapshot
 	bandwidth_snapshot() const;
 
+	// Module API
+	void
+	communicate (xf::Cycle const&) override;
+
 	// Module API
 	void
 	process (xf::Cycle const&) override;
@@ -122,15 +135,25 @@ class UDPTransceiver:
 
   private:
 	/**
-	 * Interfere with packets for testing purposes.
+	 * Send datagram through the batched socket.
 	 */
 	void
-	interfere (QByteArray& blob);
+	send_batched (std::string const& data, xf::Cycle const&);
+
+	/**
+	 * Interfere with packets for testing purposes.
+	 */
+	template<class Blob>
+		static void
+		interfere (Blob& blob);
 
   private:
 	Parameters					_parameters;
 	nu::Logger					_logger;
 	QByteArray					_received_datagram;
+	// Buffers reused by the batched I/O:
+	std::string					_received_batch;
+	std::string					_interference_buffer;
 	QHostAddress				_tx_qhostaddress;
 	BandwidthAccounting			_bandwidth_accounting;
 	// Cached non-owning pointer; the host Qt container owns and deletes the widget.
@@ -138,6 +161,8 @@ class UDPTransceiver:
 	// Last on list to be destroyed first to disconnect signals:
 	std::unique_ptr<QUdpSocket>	_rx;
 	std::unique_ptr<QUdpSocket>	_tx;
+	std::unique_ptr<BatchedUDPSocket>	_batched_rx;
+	std::unique_ptr<BatchedUDPSocket>	_batched_tx;
 };
 
 #endif
@@ -224,6 +224,7 @@ MasterSecureChannel::Session::Connected::Connected (nu::Secure<Blob> const& ephe
 		.hmac_size = params.hmac_size,
 		// This ensures actual keys are different for both directions:
 		.hkdf_user_info = global::kSlaveToMaster,
+		.replay_window_size = params.replay_window_size,
 	})
 { }
 
@@ -427,6 +428,7 @@ SlaveSecureChannel::Session::Session (Blob const& handshake_request,
 		.hmac_size = params.hmac_size,
 		// This ensures actual keys are different for both directions:
 		.hkdf_user_info = global::kMasterToSlave,
+		.replay_window_size = params.replay_window_size,
 	});
 }
 
@@ -93,6 +93,8 @@ class SecureChannel
 		// HMAC length, 12 should be a minimum:
 		size_t		hmac_size				{ 12 };
 		si::Time	max_time_difference		{ 60_s };
+		// How many most recent sequence numbers are tracked for accepting reordered packets:
+		size_t		replay_window_size		{ 64 };
 	};
 
   protected:
@@ -16,6 +16,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/instrument/quantization.h>
 #include <xefis/support/instrument/text_layout.h>
 
 // Neutrino:
@@ -26,8 +27,10 @@
 
 // Standard:
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <format>
+#include <tuple>
 
 
 namespace adi_detail {
@@ -124,6 +127,61 @@ Parameters::sanitize()
 }
 
 
+void
+Parameters::quantize (QSize const canvas_size)
+{
+	// Timestamp itself is not painted, blinkers have their own state:
+	this->timestamp = 0_s;
+
+	if (canvas_size.isEmpty())
+		return;
+
+	// Antialiased painting makes sub-pixel movements visible, so use a quarter of a pixel:
+	constexpr double kSubpixels = 4.0;
+	auto const lesser_dimension = std::min (canvas_size.width(), canvas_size.height());
+	auto const diagonal = std::hypot (canvas_size.width(), canvas_size.height());
+	// Take the finer one of pitch scale (see AdiPaintRequest::pitch_to_px()) and rotation at the canvas corners:
+	auto const angle = std::min<si::Angle> (0.775 * this->fov / lesser_dimension, 2_rad / diagonal) / kSubpixels;
+	// Ladders are shorter than the canvas, so this is a bit finer than needed:
+	auto const speed_step = this->vl_extent / canvas_size.height() / kSubpixels;
+	auto const altitude_step = this->al_extent / canvas_size.height() / kSubpixels;
+	// See ArtificialHorizon::paint_bank_angle_indicator() and PaintingWork::paint_nav() for pixels per degree:
+	auto const slip_skid_angle = 1_deg / (0.01 * lesser_dimension) / kSubpixels;
+	auto const deviation_angle = 1_deg / (0.075 * lesser_dimension) / kSubpixels;
+	// Control surfaces ±1.0 are painted at ±17.5° of pitch scale:
+	auto const control_surfaces_step = static_cast<float> (angle / 17.5_deg);
+
+	xf::quantize (this->orientation_pitch, angle);
+	xf::quantize (this->orientation_roll, angle);
+	xf::quantize (this->orientation_heading, angle);
+	xf::quantize (this->slip_skid, slip_skid_angle);
+	xf::quantize (this->flight_path_alpha, angle);
+	xf::quantize (this->flight_path_beta, angle);
+	xf::quantize (this->aoa_alpha, angle);
+	xf::quantize (this->flight_director_pitch, angle);
+	xf::quantize (this->flight_director_roll, angle);
+	xf::quantize (this->raising_runway_position, angle);
+	xf::quantize (this->deviation_vertical_approach, deviation_angle);
+	xf::quantize (this->deviation_vertical_flight_path, deviation_angle);
+	xf::quantize (this->deviation_lateral_approach, deviation_angle);
+	xf::quantize (this->deviation_lateral_flight_path, deviation_angle);
+	xf::quantize (this->control_surfaces_elevator, control_surfaces_step);
+	xf::quantize (this->control_surfaces_ailerons, control_surfaces_step);
+	xf::quantize (this->speed, speed_step);
+	xf::quantize (this->speed_lookahead, speed_step);
+	xf::quantize (this->altitude_amsl, altitude_step);
+	xf::quantize (this->altitude_lookahead, altitude_step);
+	xf::quantize (this->vertical_speed, 1_fpm);
+	// Same as vertical speed, 1 fpm of equivalent speed:
+	xf::quantize (this->energy_variometer_rate, this->energy_variometer_1000_fpm_power / 1000.0);
+	// Numeric readouts, to their displayed precision:
+	xf::quantize (this->speed_mach, 0.001);
+	xf::quantize (this->speed_ground, 1_kt);
+	xf::quantize (this->altitude_agl, 1_ft);
+	xf::quantize (this->navaid_distance, 0.1_nmi);
+}
+
+
 Blinker::Blinker (si::Time period):
 	_period (period)
 { }
@@ -179,15 +237,16 @@ Blinker::update_current_time (si::Time now)
 }
 
 
-AdiPaintRequest::AdiPaintRequest (xf::PaintRequest const& paint_request, xf::InstrumentSupport const& instrument_support, Parameters const& params, Precomputed const& precomputed, Blinker const& speed_warning_blinker, Blinker const& decision_height_warning_blinker):
+AdiPaintRequest::AdiPaintRequest (xf::PaintRequest const& paint_request, xf::InstrumentSupport const& instrument_support, Parameters const& params, Precomputed const& precomputed):
 	paint_request (paint_request),
 	params (params),
 	precomputed (precomputed),
+	instrument_support (instrument_support),
 	painter (instrument_support.get_painter (paint_request)),
 	aids_ptr (instrument_support.get_aids (paint_request)),
 	aids (*aids_ptr),
-	speed_warning_blinker (speed_warning_blinker),
-	decision_height_warning_blinker (decision_height_warning_blinker),
+	speed_warning_blinker (params.speed_warning_blinker),
+	decision_height_warning_blinker (params.decision_height_warning_blinker),
 	q (0.1f * aids.lesser_dimension())
 {
 	this->default_shadow = aids.default_shadow();
@@ -361,6 +420,31 @@ AdiPaintRequest::get_decision_height_color() const
 }
 
 
+bool
+ScaleStrip::needs_update (xf::PaintRequest::Metric const& metric, Settings const& settings, float const value, float const extent) const
+{
+	// Visible part of the ladder must fit in the strip:
+	auto const max_offset = 0.5f * (kExtents - 1.0f) * extent;
+
+	return !_metric || *_metric != metric || _settings != settings || std::abs (value - _center_value) > max_offset;
+}
+
+
+QImage&
+ScaleStrip::prepare (xf::PaintRequest::Metric const& metric, Settings const& settings, QSize const size, float const center_value)
+{
+	if (_image.size() != size)
+		_image = QImage (size, QImage::Format_ARGB32_Premultiplied);
+
+	_image.fill (Qt::transparent);
+	_metric = metric;
+	_settings = settings;
+	_center_value = center_value;
+
+	return _image;
+}
+
+
 void
 ArtificialHorizon::paint (AdiPaintRequest& pr) const
 {
@@ -1128,37 +1212,73 @@ VelocityLadder::paint_ladder_scale (AdiPaintRequest& pr, float const x) const
 {
 	if (pr.params.speed)
 	{
-		QFont const& ladder_font = pr.aids.font_2.font;
-		float const ladder_digit_width = pr.aids.font_2.digit_width;
-		float const ladder_digit_height = pr.aids.font_2.digit_height;
+		_mutable_this->update_scale_strip (pr, x);
 
-		pr.painter.setFont (ladder_font);
+		auto const& strip_image = _scale_strip.image();
+		auto const strip_center = kt_to_px (pr, 1_kt * _scale_strip.center_value());
 
 		pr.painter.setTransform (_transform);
 		pr.painter.setClipPath (_ladder_clip_path, Qt::IntersectClip);
-		pr.painter.translate (2.f * x, 0.f);
+		pr.painter.drawImage (QPointF (_ladder_rect.left(), strip_center - 0.5f * strip_image.height()), strip_image);
+	}
+}
 
-		pr.painter.setPen (_scale_pen);
-		// -+line_every is to have drawn also numbers that barely fit the scale.
-		for (int kt = (static_cast<int> (_min_shown.in<si::Knot>()) / pr.params.vl_line_every) * pr.params.vl_line_every - pr.params.vl_line_every;
-			 kt <= _max_shown.in<si::Knot>() + pr.params.vl_line_every;
-			 kt += pr.params.vl_line_every)
-		{
-			if (kt < pr.params.vl_minimum || kt > pr.params.vl_maximum)
-				continue;
 
-			float posy = kt_to_px (pr, 1_kt * kt);
-			pr.painter.paint (pr.default_shadow, [&]{
-				pr.painter.drawLine (QPointF (-0.8f * x, posy), QPointF (0.f, posy));
-			});
+void
+VelocityLadder::update_scale_strip (AdiPaintRequest& pr, float const x)
+{
+	auto const& metric = pr.paint_request.metric();
+	float const speed = pr.params.speed->in<si::Knot>();
+	float const extent = pr.params.vl_extent.in<si::Knot>();
+	ScaleStrip::Settings const settings {
+		1.f * pr.params.vl_line_every,
+		1.f * pr.params.vl_number_every,
+		1.f * pr.params.vl_minimum,
+		1.f * pr.params.vl_maximum,
+		extent,
+	};
 
-			if ((kt - pr.params.vl_minimum) % pr.params.vl_number_every == 0)
-			{
-				pr.painter.fast_draw_text (QRectF (-4.f * ladder_digit_width - 1.25f * x, -0.5f * ladder_digit_height + posy,
-												   +4.f * ladder_digit_width, ladder_digit_height),
-										   Qt::AlignVCenter | Qt::AlignRight, QString::number (kt),
-										   pr.default_shadow);
-			}
+	if (!_scale_strip.needs_update (metric, settings, speed, extent))
+		return;
+
+	QFont const& ladder_font = pr.aids.font_2.font;
+	float const ladder_digit_width = pr.aids.font_2.digit_width;
+	float const ladder_digit_height = pr.aids.font_2.digit_height;
+
+	// Add some space for numbers at both ends of the strip:
+	QSize const strip_size (std::ceil (_ladder_rect.width()), std::ceil (ScaleStrip::kExtents * _ladder_rect.height() + ladder_digit_height));
+	auto& strip_image = _scale_strip.prepare (metric, settings, strip_size, speed);
+	auto const min_shown = speed - 0.5f * ScaleStrip::kExtents * extent;
+	auto const max_shown = speed + 0.5f * ScaleStrip::kExtents * extent;
+	auto const kt_to_strip_px = [&] (float const kt) {
+		return -_ladder_rect.height() * (kt - speed) / extent;
+	};
+
+	auto painter = pr.instrument_support.get_painter (xf::PaintRequest (strip_image, metric, strip_size));
+	painter.setFont (ladder_font);
+	painter.translate (-_ladder_rect.left(), 0.5f * strip_size.height());
+	painter.translate (2.f * x, 0.f);
+
+	painter.setPen (_scale_pen);
+	// -+line_every is to have drawn also numbers that barely fit the scale.
+	for (int kt = (static_cast<int> (min_shown) / pr.params.vl_line_every) * pr.params.vl_line_every - pr.params.vl_line_every;
+		 kt <= max_shown + pr.params.vl_line_every;
+		 kt += pr.params.vl_line_every)
+	{
+		if (kt < pr.params.vl_minimum || kt > pr.params.vl_maximum)
+			continue;
+
+		float posy = kt_to_strip_px (kt);
+		painter.paint (pr.default_shadow, [&]{
+			painter.drawLine (QPointF (-0.8f * x, posy), QPointF (0.f, posy));
+		});
+
+		if ((kt - pr.params.vl_minimum) % pr.params.vl_number_every == 0)
+		{
+			painter.fast_draw_text (QRectF (-4.f * ladder_digit_width - 1.25f * x, -0.5f * ladder_digit_height + posy,
+											+4.f * ladder_digit_width, ladder_digit_height),
+									Qt::AlignVCenter | Qt::AlignRight, QString::number (kt),
+									pr.default_shadow);
 		}
 	}
 }
@@ -1682,74 +1802,111 @@ AltitudeLadder::paint_ladder_scale (AdiPaintRequest& pr, float const x) const
 {
 	if (pr.params.altitude_amsl)
 	{
-		QFont const& b_ladder_font = pr.aids.font_2.font;
-		float const b_ladder_digit_width = pr.aids.font_2.digit_width;
-		float const b_ladder_digit_height = pr.aids.font_2.digit_height;
+		_mutable_this->update_scale_strip (pr, x);
 
-		QFont const& s_ladder_font = pr.aids.font_1.font;
-		float const s_ladder_digit_width = pr.aids.font_1.digit_width;
-		float const s_ladder_digit_height = pr.aids.font_1.digit_height;
+		auto const& strip_image = _scale_strip.image();
+		auto const strip_center = ft_to_px (pr, 1_ft * _scale_strip.center_value());
 
 		pr.painter.setTransform (_transform);
 		pr.painter.setClipPath (_ladder_clip_path, Qt::IntersectClip);
-		pr.painter.translate (-2.f * x, 0.f);
+		pr.painter.drawImage (QPointF (_ladder_rect.left(), strip_center - 0.5f * strip_image.height()), strip_image);
+	}
+}
 
-		// -+line_every is to have drawn also numbers that barely fit the scale.
-		for (int ft = (static_cast<int> (_min_shown.in<si::Foot>()) / pr.params.al_line_every) * pr.params.al_line_every - pr.params.al_line_every;
-			 ft <= _max_shown.in<si::Foot>() + pr.params.al_line_every;
-			 ft += pr.params.al_line_every)
-		{
-			if (ft > 100000.f)
-				continue;
 
-			float posy = ft_to_px (pr, 1_ft * ft);
+void
+AltitudeLadder::update_scale_strip (AdiPaintRequest& pr, float const x)
+{
+	auto const& metric = pr.paint_request.metric();
+	float const altitude = pr.params.altitude_amsl->in<si::Foot>();
+	float const extent = pr.params.al_extent.in<si::Foot>();
+	ScaleStrip::Settings const settings {
+		1.f * pr.params.al_line_every,
+		1.f * pr.params.al_number_every,
+		1.f * pr.params.al_emphasis_every,
+		1.f * pr.params.al_bold_every,
+		extent,
+	};
 
-			pr.painter.setPen (ft % pr.params.al_bold_every == 0 ? _scale_pen_2 : _scale_pen_1);
-			pr.painter.paint (pr.default_shadow, [&]{
-				pr.painter.drawLine (QPointF (0.f, posy), QPointF (0.8f * x, posy));
-			});
+	if (!_scale_strip.needs_update (metric, settings, altitude, extent))
+		return;
+
+	QFont const& b_ladder_font = pr.aids.font_2.font;
+	float const b_ladder_digit_width = pr.aids.font_2.digit_width;
+	float const b_ladder_digit_height = pr.aids.font_2.digit_height;
+
+	QFont const& s_ladder_font = pr.aids.font_1.font;
+	float const s_ladder_digit_width = pr.aids.font_1.digit_width;
+	float const s_ladder_digit_height = pr.aids.font_1.digit_height;
+
+	// Add some space for numbers and emphasis lines at both ends of the strip:
+	QSize const strip_size (std::ceil (_ladder_rect.width()), std::ceil (ScaleStrip::kExtents * _ladder_rect.height() + 2.f * b_ladder_digit_height));
+	auto& strip_image = _scale_strip.prepare (metric, settings, strip_size, altitude);
+	auto const min_shown = altitude - 0.5f * ScaleStrip::kExtents * extent;
+	auto const max_shown = altitude + 0.5f * ScaleStrip::kExtents * extent;
+	auto const ft_to_strip_px = [&] (float const ft) {
+		return -_ladder_rect.height() * (ft - altitude) / extent;
+	};
+
+	auto painter = pr.instrument_support.get_painter (xf::PaintRequest (strip_image, metric, strip_size));
+	painter.translate (-_ladder_rect.left(), 0.5f * strip_size.height());
+	painter.translate (-2.f * x, 0.f);
+
+	// -+line_every is to have drawn also numbers that barely fit the scale.
+	for (int ft = (static_cast<int> (min_shown) / pr.params.al_line_every) * pr.params.al_line_every - pr.params.al_line_every;
+		 ft <= max_shown + pr.params.al_line_every;
+		 ft += pr.params.al_line_every)
+	{
+		if (ft > 100000.f)
+			continue;
 
-			if (ft % pr.params.al_number_every == 0)
+		float posy = ft_to_strip_px (ft);
+
+		painter.setPen (ft % pr.params.al_bold_every == 0 ? _scale_pen_2 : _scale_pen_1);
+		painter.paint (pr.default_shadow, [&]{
+			painter.drawLine (QPointF (0.f, posy), QPointF (0.8f * x, posy));
+		});
+
+		if (ft % pr.params.al_number_every == 0)
+		{
+			QRectF big_text_box (1.1f * x, -0.5f * b_ladder_digit_height + posy,
+								 2.f * b_ladder_digit_width, b_ladder_digit_height);
+			if (std::abs (ft) / 1000 > 0)
 			{
-				QRectF big_text_box (1.1f * x, -0.5f * b_ladder_digit_height + posy,
-									 2.f * b_ladder_digit_width, b_ladder_digit_height);
-				if (std::abs (ft) / 1000 > 0)
-				{
-					QString big_text = QString::number (ft / 1000);
-					pr.painter.setFont (b_ladder_font);
-					pr.painter.fast_draw_text (big_text_box, Qt::AlignVCenter | Qt::AlignRight, big_text, pr.default_shadow);
-				}
+				QString big_text = QString::number (ft / 1000);
+				painter.setFont (b_ladder_font);
+				painter.fast_draw_text (big_text_box, Qt::AlignVCenter | Qt::AlignRight, big_text, pr.default_shadow);
+			}
 
-				QString small_text = QString ("%1").arg (QString::number (std::abs (ft % 1000)), 3, '0');
-				if (ft == 0)
-					small_text = "0";
-				pr.painter.setFont (s_ladder_font);
-				QRectF small_text_box (1.1f * x + 2.1f * b_ladder_digit_width, -0.5f * s_ladder_digit_height + posy,
-									   3.f * s_ladder_digit_width, s_ladder_digit_height);
-				pr.painter.fast_draw_text (small_text_box, Qt::AlignVCenter | Qt::AlignRight, small_text, pr.default_shadow);
-				// Minus sign?
-				if (ft < 0)
-				{
-					if (ft > -1000)
-						pr.painter.fast_draw_text (small_text_box.adjusted (-s_ladder_digit_width, 0.f, 0.f, 0.f),
-												   Qt::AlignVCenter | Qt::AlignLeft, pr.aids.kMinusSignStrUTF8, pr.default_shadow);
-				}
+			QString small_text = QString ("%1").arg (QString::number (std::abs (ft % 1000)), 3, '0');
+			if (ft == 0)
+				small_text = "0";
+			painter.setFont (s_ladder_font);
+			QRectF small_text_box (1.1f * x + 2.1f * b_ladder_digit_width, -0.5f * s_ladder_digit_height + posy,
+								   3.f * s_ladder_digit_width, s_ladder_digit_height);
+			painter.fast_draw_text (small_text_box, Qt::AlignVCenter | Qt::AlignRight, small_text, pr.default_shadow);
+			// Minus sign?
+			if (ft < 0)
+			{
+				if (ft > -1000)
+					painter.fast_draw_text (small_text_box.adjusted (-s_ladder_digit_width, 0.f, 0.f, 0.f),
+											Qt::AlignVCenter | Qt::AlignLeft, pr.aids.kMinusSignStrUTF8, pr.default_shadow);
+			}
 
-				// Additional lines above/below every 1000 ft:
-				if (ft % pr.params.al_emphasis_every == 0)
-				{
-					pr.painter.setPen (pr.aids.get_pen (Qt::white, 1.0));
-					float r, y;
-					r = big_text_box.left() + 4.0 * x;
-					y = posy - 0.75f * big_text_box.height();
-					pr.painter.paint (pr.default_shadow, [&]{
-						pr.painter.drawLine (QPointF (big_text_box.left(), y), QPointF (r, y));
-					});
-					y = posy + 0.75f * big_text_box.height();
-					pr.painter.paint (pr.default_shadow, [&]{
-						pr.painter.drawLine (QPointF (big_text_box.left(), y), QPointF (r, y));
-					});
-				}
+			// Additional lines above/below every 1000 ft:
+			if (ft % pr.params.al_emphasis_every == 0)
+			{
+				painter.setPen (pr.aids.get_pen (Qt::white, 1.0));
+				float r, y;
+				r = big_text_box.left() + 4.0 * x;
+				y = posy - 0.75f * big_text_box.height();
+				painter.paint (pr.default_shadow, [&]{
+					painter.drawLine (QPointF (big_text_box.left(), y), QPointF (r, y));
+				});
+				y = posy + 0.75f * big_text_box.height();
+				painter.paint (pr.default_shadow, [&]{
+					painter.drawLine (QPointF (big_text_box.left(), y), QPointF (r, y));
+				});
 			}
 		}
 	}
@@ -2303,42 +2460,156 @@ AltitudeLadder::ft_to_px (AdiPaintRequest& pr, si::Length const length) const
 }
 
 
+CachedLayer::CachedLayer (SameInputs const same_inputs):
+	_same_inputs (same_inputs)
+{ }
+
+
+bool
+CachedLayer::needs_update (xf::PaintRequest::Metric const& metric, Parameters const& parameters) const
+{
+	return !_metric || *_metric != metric || !_parameters || !_same_inputs (*_parameters, parameters);
+}
+
+
+bool
+CachedLayer::prepare (xf::PaintRequest::Metric const& metric, Parameters const& parameters)
+{
+	bool const metric_changed = !_metric || *_metric != metric;
+
+	if (_image.size() != metric.canvas_size())
+		_image = QImage (metric.canvas_size(), QImage::Format_ARGB32_Premultiplied);
+
+	_image.fill (Qt::transparent);
+	_metric = metric;
+	_parameters = parameters;
+
+	return metric_changed;
+}
+
+
+/**
+ * Compare values used by ArtificialHorizon.
+ */
+static bool
+same_horizon_inputs (Parameters const& a, Parameters const& b)
+{
+	auto const inputs = [] (Parameters const& p) {
+		return std::tie (
+			p.fov, p.old_style,
+			p.orientation_failure, p.orientation_failure_focus, p.orientation_pitch, p.orientation_roll, p.orientation_heading,
+			p.orientation_heading_numbers_visible, p.pitch_disagree, p.pitch_disagree_focus, p.roll_disagree, p.roll_disagree_focus,
+			p.roll_warning, p.slip_skid, p.slip_skid_warning,
+			p.flight_path_marker_failure, p.flight_path_marker_failure_focus, p.flight_path_alpha, p.flight_path_beta,
+			p.flight_director_failure, p.flight_director_failure_focus, p.cmd_fpa,
+			p.tcas_ra_pitch_minimum, p.tcas_ra_pitch_maximum
+		);
+	};
+
+	return inputs (a) == inputs (b);
+}
+
+
+/**
+ * Compare values used by the navigation, flight director, center cross and other
+ * things painted directly by PaintingWork.
+ */
+static bool
+same_overlay_inputs (Parameters const& a, Parameters const& b)
+{
+	auto const inputs = [] (Parameters const& p) {
+		return std::tie (
+			p.fov, p.old_style, p.dilated_shadows,
+			p.navaid_reference_visible, p.navaid_hint, p.navaid_identifier, p.navaid_distance, p.navaid_course_magnetic,
+			p.deviation_vertical_failure, p.deviation_vertical_failure_focus, p.deviation_vertical_approach, p.deviation_vertical_flight_path,
+			p.deviation_lateral_failure, p.deviation_lateral_failure_focus, p.deviation_lateral_approach, p.deviation_lateral_flight_path,
+			p.deviation_mixed_mode, p.raising_runway_position,
+			p.flight_director_guidance_visible, p.flight_director_pitch, p.flight_director_roll, p.flight_director_active_name,
+			p.control_surfaces_visible, p.control_surfaces_elevator, p.control_surfaces_ailerons,
+			p.altitude_agl_failure, p.altitude_agl_failure_focus, p.altitude_agl, p.altitude_agl_focus,
+			p.altitude_amsl, p.decision_height_amsl, p.decision_height_setting, p.decision_height_type, p.decision_height_focus,
+			p.decision_height_warning_blinker,
+			p.control_hint, p.control_hint_focus, p.fma_visible,
+			p.fma_speed_hint, p.fma_speed_focus, p.fma_speed_armed_hint, p.fma_speed_armed_focus,
+			p.fma_lateral_hint, p.fma_lateral_focus, p.fma_lateral_armed_hint, p.fma_lateral_armed_focus,
+			p.fma_vertical_hint, p.fma_vertical_focus, p.fma_vertical_armed_hint, p.fma_vertical_armed_focus,
+			p.critical_aoa, p.aoa_alpha
+		);
+	};
+
+	// Attitude values are only used to position flight director bars, otherwise only their presence matters:
+	auto const same_attitude = a.flight_director_guidance_visible
+		? std::tie (a.orientation_pitch, a.orientation_roll) == std::tie (b.orientation_pitch, b.orientation_roll)
+		: a.orientation_pitch.has_value() == b.orientation_pitch.has_value() && a.orientation_roll.has_value() == b.orientation_roll.has_value();
+
+	return inputs (a) == inputs (b) && same_attitude;
+}
+
+
+/**
+ * Compare values used by VelocityLadder.
+ */
+static bool
+same_velocity_ladder_inputs (Parameters const& a, Parameters const& b)
+{
+	auto const inputs = [] (Parameters const& p) {
+		return std::tie (
+			p.vl_extent, p.vl_minimum, p.vl_maximum, p.vl_line_every, p.vl_number_every,
+			p.speed_failure, p.speed_failure_focus, p.speed, p.speed_lookahead, p.speed_minimum, p.speed_minimum_maneuver,
+			p.speed_maximum_maneuver, p.speed_maximum, p.speed_mach, p.speed_ground, p.speed_bugs, p.speed_warning_blinker,
+			p.cmd_speed, p.cmd_mach, p.ias_disagree, p.novspd_flag
+		);
+	};
+
+	return inputs (a) == inputs (b);
+}
+
+
+/**
+ * Compare values used by AltitudeLadder.
+ */
+static bool
+same_altitude_ladder_inputs (Parameters const& a, Parameters const& b)
+{
+	auto const inputs = [] (Parameters const& p) {
+		return std::tie (
+			p.old_style, p.show_metric,
+			p.al_extent, p.al_line_every, p.al_number_every, p.al_emphasis_every, p.al_bold_every,
+			p.altitude_failure, p.altitude_failure_focus, p.altitude_amsl, p.altitude_lookahead, p.altitude_bugs,
+			p.altitude_disagree, p.altitude_landing_warning_hi, p.altitude_landing_warning_lo, p.landing_amsl, p.ldgalt_flag,
+			p.decision_height_amsl, p.decision_height_warning_blinker,
+			p.vertical_speed_failure, p.vertical_speed_failure_focus, p.vertical_speed,
+			p.energy_variometer_rate, p.energy_variometer_1000_fpm_power,
+			p.pressure_qnh, p.pressure_display_hpa, p.use_standard_pressure,
+			p.cmd_altitude, p.cmd_altitude_acquired, p.cmd_vertical_speed,
+			p.tcas_ra_vertical_speed_minimum, p.tcas_ra_vertical_speed_maximum
+		);
+	};
+
+	return inputs (a) == inputs (b);
+}
+
+
 PaintingWork::PaintingWork (xf::Graphics const& graphics):
-	_instrument_support (graphics)
+	_instrument_support (graphics),
+	_horizon_layer (same_horizon_inputs),
+	_overlay_layer (same_overlay_inputs),
+	_velocity_ladder_layer (same_velocity_ladder_inputs),
+	_altitude_ladder_layer (same_altitude_ladder_inputs)
 { }
 
 
 void
 PaintingWork::paint (xf::PaintRequest const& paint_request, Parameters const& params) const
 {
-	AdiPaintRequest pr (paint_request, _instrument_support, _parameters, _precomputed, _speed_warning_blinker, _decision_height_warning_blinker);
+	AdiPaintRequest pr (paint_request, _instrument_support, _parameters, _precomputed);
 
 	precompute (pr, params);
 
 	if (_parameters.input_alert_visible)
 		paint_input_alert (pr);
 	else
-	{
-		_artificial_horizon.paint (pr);
-
-		paint_nav (pr);
-		paint_center_cross (pr, false, true);
-		paint_flight_director (pr);
-		paint_control_surfaces (pr);
-		paint_center_cross (pr, true, false);
-
-		if (pr.params.altitude_agl_failure)
-			paint_radar_altimeter_failure (pr);
-		else
-			paint_altitude_agl (pr);
-
-		paint_decision_height_setting (pr);
-		paint_hints (pr);
-		paint_critical_aoa (pr);
-
-		_velocity_ladder.paint (pr);
-		_altitude_ladder.paint (pr);
-	}
+		paint_layers (pr);
 }
 
 
@@ -2354,21 +2625,98 @@ PaintingWork::precompute (AdiPaintRequest& pr, Parameters const& params)
 {
 	_parameters = params;
 	_parameters.sanitize();
+	// Invisible changes would otherwise cause layers to be re-rendered:
+	_parameters.quantize (pr.paint_request.metric().canvas_size());
 
 	if (pr.paint_request.size_changed())
 	{
 		_precomputed.center_transform.reset();
 		_precomputed.center_transform.translate (0.5f * pr.aids.width(), 0.5f * pr.aids.height());
 	}
+}
 
-	_speed_warning_blinker.update_current_time (_parameters.timestamp);
-	_speed_warning_blinker.update (_parameters.speed &&
-								   ((_parameters.speed_minimum && *_parameters.speed < *_parameters.speed_minimum) ||
-									(_parameters.speed_maximum && *_parameters.speed > *_parameters.speed_maximum)));
-	_decision_height_warning_blinker.update_current_time (_parameters.timestamp);
-	_decision_height_warning_blinker.update (_parameters.altitude_amsl && _parameters.decision_height_amsl &&
-											 *_parameters.altitude_amsl < *_parameters.decision_height_amsl &&
-											 _parameters.decision_height_focus_short);
+
+template<class PaintFunction>
+	void
+	PaintingWork::update_layer (CachedLayer& layer, xf::PaintRequest const& paint_request, bool const dilated_shadows, PaintFunction&& paint_function)
+	{
+		auto const& metric = paint_request.metric();
+
+		if (layer.needs_update (metric, _parameters))
+		{
+			// Painters recompute their size-dependent data when they see a size change,
+			// so report one when the layer is rendered for a new metric:
+			auto const previous_size = layer.prepare (metric, _parameters) ? QSize() : metric.canvas_size();
+			std::optional<xf::Shadow> shadow;
+
+			{
+				xf::PaintRequest const layer_paint_request (layer.image(), metric, previous_size);
+				AdiPaintRequest layer_pr (layer_paint_request, _instrument_support, _parameters, _precomputed);
+
+				if (dilated_shadows)
+				{
+					layer_pr.painter.set_shadow_mode (xf::ShadowPainter::ShadowMode::Deferred);
+					shadow = layer_pr.default_shadow;
+				}
+
+				paint_function (layer_pr);
+			}
+
+			// Painter must be finished before the image is modified:
+			if (shadow)
+				xf::ShadowPainter::add_dilated_shadow (layer.image(), *shadow);
+		}
+	}
+
+
+void
+PaintingWork::paint_layers (AdiPaintRequest& pr) const
+{
+	_mutable_this->paint_layers (pr);
+}
+
+
+void
+PaintingWork::paint_layers (AdiPaintRequest& pr)
+{
+	update_layer (_horizon_layer, pr.paint_request, false, [&] (AdiPaintRequest& layer_pr) {
+		_artificial_horizon.paint (layer_pr);
+	});
+
+	update_layer (_overlay_layer, pr.paint_request, _parameters.dilated_shadows, [&] (AdiPaintRequest& layer_pr) {
+		paint_nav (layer_pr);
+		paint_center_cross (layer_pr, false, true);
+		paint_flight_director (layer_pr);
+		paint_control_surfaces (layer_pr);
+		paint_center_cross (layer_pr, true, false);
+
+		if (layer_pr.params.altitude_agl_failure)
+			paint_radar_altimeter_failure (layer_pr);
+		else
+			paint_altitude_agl (layer_pr);
+
+		paint_decision_height_setting (layer_pr);
+		paint_hints (layer_pr);
+		paint_critical_aoa (layer_pr);
+	});
+
+	update_layer (_velocity_ladder_layer, pr.paint_request, false, [&] (AdiPaintRequest& layer_pr) {
+		_velocity_ladder.paint (layer_pr);
+	});
+
+	update_layer (_altitude_ladder_layer, pr.paint_request, false, [&] (AdiPaintRequest& layer_pr) {
+		_altitude_ladder.paint (layer_pr);
+	});
+
+	pr.painter.setClipping (false);
+	pr.painter.resetTransform();
+	// Canvas is transparent at this point, so the bottom layer can be just copied:
+	pr.painter.setCompositionMode (QPainter::CompositionMode_Source);
+	pr.painter.drawImage (QPointF (0.f, 0.f), _horizon_layer.image());
+	pr.painter.setCompositionMode (QPainter::CompositionMode_SourceOver);
+
+	for (auto* layer: { &_overlay_layer, &_velocity_ladder_layer, &_altitude_ladder_layer })
+		pr.painter.drawImage (QPointF (0.f, 0.f), layer->image());
 }
 
 
@@ -3079,6 +3427,7 @@ ADI::process (xf::Cycle const& cycle)
 	params.timestamp = cycle.update_time();
 	params.fov = *_io.field_of_view;
 	params.show_vertical_speed_ladder = *_io.show_vertical_speed_ladder;
+	params.dilated_shadows = *_io.dilated_shadows;
 	params.focus_duration = *_io.focus_duration;
 	params.focus_short_duration = *_io.focus_short_duration;
 	params.old_style = _io.style_old.value_or (false);
@@ -3368,9 +3717,28 @@ ADI::process (xf::Cycle const& cycle)
 	params.al_bold_every = *_io.altitude_ladder_bold_every;
 	params.al_line_every = *_io.altitude_ladder_line_every;
 	params.al_number_every = *_io.altitude_ladder_number_every;
+	// Blinkers:
+	_speed_warning_blinker.update_current_time (params.timestamp);
+	_speed_warning_blinker.update (params.speed &&
+								   ((params.speed_minimum && *params.speed < *params.speed_minimum) ||
+									(params.speed_maximum && *params.speed > *params.speed_maximum)));
+	params.speed_warning_blinker = _speed_warning_blinker;
+	_decision_height_warning_blinker.update_current_time (params.timestamp);
+	_decision_height_warning_blinker.update (params.altitude_amsl && params.decision_height_amsl &&
+											 *params.altitude_amsl < *params.decision_height_amsl &&
+											 params.decision_height_focus_short);
+	params.decision_height_warning_blinker = _decision_height_warning_blinker;
 
 	_parameters.store (params);
-	mark_dirty();
+
+	// Repaint only if the change is visible:
+	params.quantize (canvas_size());
+
+	if (params != _painted_parameters)
+	{
+		_painted_parameters = std::move (params);
+		mark_dirty();
+	}
 }
 
 
@@ -29,11 +29,13 @@
 
 // Qt:
 #include <QtGui/QColor>
+#include <QtGui/QImage>
 #include <QtGui/QPainterPath>
 
 // Standard:
 #include <array>
 #include <cstddef>
+#include <optional>
 
 
 namespace nu = neutrino;
@@ -43,6 +45,52 @@ using namespace nu::si::literals;
 
 namespace adi_detail {
 
+class Blinker
+{
+  public:
+	// Ctor
+	explicit
+	Blinker (si::Time period);
+
+	/**
+	 * True if blinking is active.
+	 */
+	bool
+	active() const noexcept;
+
+	/**
+	 * True if blinked object should be visible at the moment.
+	 */
+	bool
+	visibility_state() const noexcept;
+
+	/**
+	 * Update blinker with new condition to blink.
+	 * If it's true, blinker starts unless already blinking,
+	 * otherwise stops unless already stopped.
+	 */
+	void
+	update (bool condition);
+
+	/**
+	 * Update current time information, needed to properly blink
+	 * the blinker.
+	 */
+	void
+	update_current_time (si::Time now);
+
+	[[nodiscard]]
+	bool
+	operator== (Blinker const&) const = default;
+
+  private:
+	si::Time				_period;
+	std::optional<si::Time>	_start_timestamp;
+	bool					_active				{ false };
+	bool					_visibility_state	{ false };
+};
+
+
 // TODO For booleans use bitfields (:1) when C++ supports bitfields and in-class initialization (to save cache memory).
 // TODO Handle nans
 class Parameters
@@ -61,6 +109,7 @@ class Parameters
 	si::Angle					fov									= 120_deg;
 	bool						input_alert_visible					= false;
 	bool						show_vertical_speed_ladder			= false;
+	bool						dilated_shadows						= false;
 	// Velocity:
 	bool						speed_failure						= false;
 	bool						speed_failure_focus					= false;
@@ -188,6 +237,9 @@ class Parameters
 	bool						altitude_disagree					= false;
 	bool						roll_warning						= false;
 	bool						slip_skid_warning					= false;
+	// Blinkers (updated by the module, so that blinking causes repaints):
+	Blinker						speed_warning_blinker				{ 200_ms };
+	Blinker						decision_height_warning_blinker		{ 200_ms };
 	// Velocity ladder:
 	si::Velocity				vl_extent							= 124_kt;
 	int							vl_minimum							= 0;
@@ -207,6 +259,18 @@ class Parameters
 	 */
 	void
 	sanitize();
+
+	/**
+	 * Round continuous values to a fraction of a pixel on a canvas of given size
+	 * and reset the timestamp. Two quantized Parameters that compare equal
+	 * produce the same image.
+	 */
+	void
+	quantize (QSize canvas_size);
+
+	[[nodiscard]]
+	bool
+	operator== (Parameters const&) const = default;
 };
 
 
@@ -221,44 +285,49 @@ class Precomputed
 };
 
 
-class Blinker
+/**
+ * Part of the ADI rendered into its own image. The image is reused as long as
+ * the canvas metric and the parameters the layer depends on stay the same.
+ */
+class CachedLayer
 {
   public:
-	// Ctor
-	Blinker (si::Time period);
-
 	/**
-	 * True if blinking is active.
+	 * Predicate that tells whether two Parameters are equal in all values
+	 * used to render the layer.
 	 */
-	bool
-	active() const noexcept;
+	using SameInputs = bool (*) (Parameters const&, Parameters const&);
+
+  public:
+	// Ctor
+	explicit
+	CachedLayer (SameInputs);
 
 	/**
-	 * True if blinked object should be visible at the moment.
+	 * Return true if the layer needs to be rendered again.
 	 */
+	[[nodiscard]]
 	bool
-	visibility_state() const noexcept;
+	needs_update (xf::PaintRequest::Metric const&, Parameters const&) const;
 
 	/**
-	 * Update blinker with new condition to blink.
-	 * If it's true, blinker starts unless already blinking,
-	 * otherwise stops unless already stopped.
+	 * Clear the image (reallocate it if canvas size has changed) and remember
+	 * metric and parameters it's going to be rendered for.
+	 * Return true if the metric has changed since the last rendering.
 	 */
-	void
-	update (bool condition);
+	bool
+	prepare (xf::PaintRequest::Metric const&, Parameters const&);
 
-	/**
-	 * Update current time information, needed to properly blink
-	 * the blinker.
-	 */
-	void
-	update_current_time (si::Time now);
+	[[nodiscard]]
+	QImage&
+	image() noexcept
+		{ return _image; }
 
   private:
-	si::Time const			_period;
-	std::optional<si::Time>	_start_timestamp;
-	bool					_active				{ false };
-	bool					_visibility_state	{ false };
+	SameInputs								_same_inputs;
+	QImage									_image;
+	std::optional<xf::PaintRequest::Metric>	_metric;
+	std::optional<Parameters>				_parameters;
 };
 
 
@@ -270,7 +339,7 @@ class AdiPaintRequest
   public:
 	// Ctor
 	explicit
-	AdiPaintRequest (xf::PaintRequest const&, xf::InstrumentSupport const&, Parameters const&, Precomputed const&, Blinker const&, Blinker const&);
+	AdiPaintRequest (xf::PaintRequest const&, xf::InstrumentSupport const&, Parameters const&, Precomputed const&);
 
   public:
 	static inline QColor const				kLadderColor		{ 64, 51, 108, 0x80 };
@@ -280,6 +349,7 @@ class AdiPaintRequest
 	xf::PaintRequest const&					paint_request;
 	Parameters const&						params;
 	Precomputed const&						precomputed;
+	xf::InstrumentSupport const&			instrument_support;
 	xf::InstrumentPainter					painter;
 	std::shared_ptr<xf::InstrumentAids>		aids_ptr;
 	xf::InstrumentAids&						aids;
@@ -346,6 +416,60 @@ class AdiPaintRequest
 };
 
 
+/**
+ * Ladder scale (lines and numbers) pre-rendered for a range of values a few times longer
+ * than the visible part of the ladder. Scrolling only needs to blit the strip with a different
+ * offset. The strip gets re-rendered when the shown value leaves the covered range or when
+ * the metric or scale settings change.
+ */
+class ScaleStrip
+{
+  public:
+	// Length of the strip in visible ladder extents:
+	static constexpr float kExtents = 3.0f;
+
+	/**
+	 * Scale settings that affect the rendered strip (line/number spacing, extent, etc).
+	 */
+	using Settings = std::array<float, 5>;
+
+  public:
+	/**
+	 * Return true if the strip needs to be rendered again to show the ladder centered
+	 * at given value.
+	 */
+	[[nodiscard]]
+	bool
+	needs_update (xf::PaintRequest::Metric const&, Settings const&, float value, float extent) const;
+
+	/**
+	 * Clear (reallocate if size has changed) the image for rendering the scale
+	 * centered at given value.
+	 */
+	QImage&
+	prepare (xf::PaintRequest::Metric const&, Settings const&, QSize, float center_value);
+
+	[[nodiscard]]
+	QImage const&
+	image() const noexcept
+		{ return _image; }
+
+	/**
+	 * Value at the vertical center of the image.
+	 */
+	[[nodiscard]]
+	float
+	center_value() const noexcept
+		{ return _center_value; }
+
+  private:
+	QImage									_image;
+	std::optional<xf::PaintRequest::Metric>	_metric;
+	Settings								_settings		{ };
+	float									_center_value	{ 0.0f };
+};
+
+
 class ArtificialHorizon
 {
   public:
@@ -453,6 +577,9 @@ class VelocityLadder
 	void
 	paint_ladder_scale (AdiPaintRequest&, float x) const;
 
+	void
+	update_scale_strip (AdiPaintRequest&, float x);
+
 	void
 	paint_speed_limits (AdiPaintRequest&, float x) const;
 
@@ -493,6 +620,7 @@ class VelocityLadder
 	float			_margin;
 	int				_digits;
 	QPolygonF		_bug_shape;
+	ScaleStrip		_scale_strip;
 };
 
 
@@ -518,6 +646,9 @@ class AltitudeLadder
 	void
 	paint_ladder_scale (AdiPaintRequest&, float x) const;
 
+	void
+	update_scale_strip (AdiPaintRequest&, float x);
+
 	void
 	paint_altitude_tendency (AdiPaintRequest&, float x) const;
 
@@ -576,6 +707,7 @@ class AltitudeLadder
 	QRectF				_s_digits_box;
 	float				_margin;
 	std::optional<bool>	_previous_show_metric;
+	ScaleStrip			_scale_strip;
 };
 
 
@@ -596,6 +728,25 @@ class PaintingWork
 	void
 	precompute (AdiPaintRequest&, Parameters const&);
 
+	void
+	paint_layers (AdiPaintRequest&) const;
+
+	/**
+	 * Re-render layers whose inputs have changed and composite all of them
+	 * onto the canvas.
+	 */
+	void
+	paint_layers (AdiPaintRequest&);
+
+	/**
+	 * Render the layer with given function if it's outdated.
+	 * If dilated_shadows is true, painter's shadows are deferred and the shadow of the whole
+	 * layer is generated in one pass after painting.
+	 */
+	template<class PaintFunction>
+		void
+		update_layer (CachedLayer&, xf::PaintRequest const&, bool dilated_shadows, PaintFunction&&);
+
 	void
 	paint_center_cross (AdiPaintRequest&, bool center_box, bool rest) const;
 
@@ -637,8 +788,12 @@ class PaintingWork
 	ArtificialHorizon		_artificial_horizon;
 	VelocityLadder			_velocity_ladder;
 	AltitudeLadder			_altitude_ladder;
-	Blinker					_speed_warning_blinker				{ 200_ms };
-	Blinker					_decision_height_warning_blinker	{ 200_ms };
+
+	// Layers in compositing order:
+	CachedLayer				_horizon_layer;
+	CachedLayer				_overlay_layer;
+	CachedLayer				_velocity_ladder_layer;
+	CachedLayer				_altitude_ladder_layer;
 };
 
 } // namespace adi_detail
@@ -685,6 +840,9 @@ class ADI_IO: public xf::Instrument
 	// Style:
 	xf::Setting<si::Angle>		field_of_view										{ this, "field_of_view", 120_deg };
 	xf::Setting<bool>			show_vertical_speed_ladder							{ this, "show_vertical_speed_ladder", true };
+	// Generate shadows of the overlay (flight director, navigation, etc.) from the painted image
+	// instead of painting each shadowed element twice. Cheaper, but all shadows get default color:
+	xf::Setting<bool>			dilated_shadows										{ this, "dilated_shadows", false };
 	xf::Setting<si::Time>		focus_duration										{ this, "focus_duration", 10_s };
 	xf::Setting<si::Time>		focus_short_duration								{ this, "focus_short_duration", 5_s };
 
@@ -870,6 +1028,10 @@ class ADI: public ADI_IO
 	xf::SocketObserver							_fpv_computer;
 	adi_detail::PaintingWork					_painting_work;
 	nu::Synchronized<adi_detail::Parameters>	_parameters;
+	// Quantized copy of parameters used for the last repaint:
+	adi_detail::Parameters						_painted_parameters;
+	adi_detail::Blinker							_speed_warning_blinker				{ 200_ms };
+	adi_detail::Blinker							_decision_height_warning_blinker	{ 200_ms };
 	xf::EventTimestamper						_decision_height_became_visible;
 	xf::EventTimestamper						_altitude_agl_became_visible;
 	xf::EventTimestamper						_speed_failure_timestamp;
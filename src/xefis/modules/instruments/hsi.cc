@@ -16,6 +16,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/instrument/quantization.h>
 #include <xefis/support/instrument/text_layout.h>
 #include <xefis/support/universe/earth/utility.h>
 #include <xefis/support/universe/earth/wind_triangle.h>
@@ -29,11 +30,46 @@
 #include <QRadialGradient>
 
 // Standard:
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <tuple>
 
 
 namespace hsi_detail {
 
+static bool
+same_position (std::optional<si::LonLat> const& a, std::optional<si::LonLat> const& b)
+{
+	if (a && b)
+		return a->lon() == b->lon() && a->lat() == b->lat();
+	else
+		return !a && !b;
+}
+
+
+static void
+quantize_position (std::optional<si::LonLat>& position, si::Angle const resolution)
+{
+	if (position)
+	{
+		auto lon = position->lon();
+		auto lat = position->lat();
+		xf::quantize (lon, resolution);
+		xf::quantize (lat, resolution);
+		position = si::LonLat (lon, lat);
+	}
+}
+
+
+bool
+CircularArea::operator== (CircularArea const& other) const
+{
+	return same_position (center, other.center) && radius == other.radius;
+}
+
+
 void
 Parameters::sanitize()
 {
@@ -64,6 +100,103 @@ Parameters::sanitize()
 }
 
 
+void
+Parameters::quantize (QSize const canvas_size)
+{
+	// Update time itself is not painted, hint emphasis is a separate parameter:
+	update_time = 0_s;
+
+	if (canvas_size.isEmpty())
+		return;
+
+	// Antialiased painting makes sub-pixel movements visible, so use a quarter of a pixel:
+	constexpr double kSubpixels = 4.0;
+	auto const lesser_dimension = std::min (canvas_size.width(), canvas_size.height());
+	// Rotation of the rose measured at its rim; map scale based on range shown across the lesser dimension:
+	auto const angle = 1_rad / lesser_dimension / kSubpixels;
+	auto const length = range / lesser_dimension / kSubpixels;
+	auto const arc = 1_rad * (length / xf::kEarthMeanRadius);
+	// Trend vectors are the longest things computed from speeds:
+	auto const longest_trend = *std::max_element (trend_vector_durations.begin(), trend_vector_durations.end());
+
+	xf::quantize (heading_magnetic, angle);
+	xf::quantize (heading_true, angle);
+	xf::quantize (ap_heading_magnetic, angle);
+	xf::quantize (ap_track_magnetic, angle);
+	xf::quantize (track_magnetic, angle);
+	xf::quantize (course_setting_magnetic, angle);
+	xf::quantize (course_deviation, angle);
+	xf::quantize (true_home_direction, angle);
+	xf::quantize (wind_from_magnetic_heading, angle);
+	xf::quantize (altitude_reach_distance, length);
+	quantize_position (position, arc);
+	quantize_position (home, arc);
+
+	if (longest_trend > 0_s)
+	{
+		xf::quantize (ground_speed, length / longest_trend);
+		xf::quantize (true_air_speed, length / longest_trend);
+		xf::quantize (track_lateral_rotation, angle / longest_trend);
+	}
+}
+
+
+bool
+Parameters::operator== (Parameters const& other) const
+{
+	auto const comparable = [] (Parameters const& p) {
+		return std::tie (
+			p.update_time, p.display_mode, p.heading_mode, p.range, p.heading_magnetic, p.heading_true,
+			p.ap_visible, p.ap_line_visible, p.ap_heading_magnetic, p.ap_track_magnetic, p.ap_use_trk,
+			p.track_visible, p.track_magnetic, p.course_visible, p.course_setting_magnetic, p.course_deviation, p.course_to_flag,
+			p.navaid_selected_reference, p.navaid_selected_identifier, p.navaid_selected_distance, p.navaid_selected_eta,
+			p.navaid_selected_course_magnetic,
+			p.navaid_left_type, p.navaid_left_reference, p.navaid_left_identifier, p.navaid_left_distance,
+			p.navaid_left_initial_bearing_magnetic,
+			p.navaid_right_type, p.navaid_right_reference, p.navaid_right_identifier, p.navaid_right_distance,
+			p.navaid_right_initial_bearing_magnetic,
+			p.navigation_required_performance, p.navigation_actual_performance, p.center_on_track,
+			p.home_track_visible, p.true_home_direction, p.dist_to_home_ground, p.dist_to_home_vlos, p.dist_to_home_vert,
+			p.ground_speed, p.true_air_speed, p.track_lateral_rotation, p.altitude_reach_distance,
+			p.wind_from_magnetic_heading, p.wind_tas_speed,
+			p.navaids_visible, p.fix_visible, p.vor_visible, p.dme_visible, p.ndb_visible, p.loc_visible, p.arpt_visible,
+			p.navaids_loaded, p.highlighted_loc, p.positioning_hint, p.positioning_hint_emphasized, p.tcas_on, p.tcas_range,
+			p.arpt_runways_range_threshold, p.arpt_map_range_threshold, p.arpt_runway_extension_length,
+			p.trend_vector_durations, p.trend_vector_min_ranges, p.trend_vector_max_range, p.radio_range_pattern_scale,
+			p.round_clip, p.flight_range_warning, p.flight_range_critical, p.radio_range_warning, p.radio_range_critical
+		);
+	};
+
+	// LonLats are compared separately:
+	return comparable (*this) == comparable (other)
+		&& same_position (home, other.home)
+		&& same_position (position, other.position)
+		&& same_position (radio_position, other.radio_position);
+}
+
+
+/**
+ * Compare values used to render the map image, other than aircraft position and heading,
+ * which only move the image around.
+ */
+static bool
+same_map_inputs (Parameters const& a, Parameters const& b)
+{
+	auto const inputs = [] (Parameters const& p) {
+		return std::tie (
+			p.display_mode, p.range,
+			p.navaids_visible, p.fix_visible, p.vor_visible, p.dme_visible, p.ndb_visible, p.loc_visible, p.arpt_visible,
+			p.navaids_loaded, p.highlighted_loc, p.arpt_runways_range_threshold, p.arpt_map_range_threshold, p.arpt_runway_extension_length,
+			p.radio_range_pattern_scale, p.radio_range_warning, p.radio_range_critical
+		);
+	};
+
+	return inputs (a) == inputs (b)
+		&& a.position.has_value() == b.position.has_value()
+		&& same_position (a.radio_position, b.radio_position);
+}
+
+
 PaintingWork::PaintingWork (
 	xf::PaintRequest const& paint_request,
 	xf::InstrumentSupport const& instrument_support,
@@ -72,15 +205,20 @@ PaintingWork::PaintingWork (
 	ResizeCache& resize_cache,
 	CurrentNavaids& current_navaids,
 	Mutable& mutable_,
-	nu::Logger const& logger
+	nu::Logger const& logger,
+	MapCache* map_cache,
+	nu::WorkPerformer* work_performer
 ):
 	_logger (logger),
 	_paint_request (paint_request),
+	_instrument_support (instrument_support),
 	_navaid_storage (navaid_storage),
 	_p (parameters),
 	_c (resize_cache),
 	_current_navaids (current_navaids),
 	_mutable (mutable_),
+	_map_cache (map_cache),
+	_work_performer (work_performer),
 	_painter (instrument_support.get_painter (paint_request)),
 	_aids_ptr (instrument_support.get_aids (paint_request)),
 	_aids (*_aids_ptr)
@@ -379,8 +517,8 @@ PaintingWork::PaintingWork (
 void
 PaintingWork::paint()
 {
-	paint_radio_range_map();
-	paint_navaids();
+	paint_map();
+	paint_home();
 	paint_flight_ranges();
 	paint_altitude_reach();
 	paint_track (false);
@@ -577,7 +715,7 @@ PaintingWork::paint_navperf()
 void
 PaintingWork::paint_hints()
 {
-	if (!*_p.positioning_hint || !_p.position)
+	if (!_p.positioning_hint || !_p.position)
 		return;
 
 	auto const size = _paint_request.metric().canvas_size();
@@ -586,12 +724,12 @@ PaintingWork::paint_hints()
 	_painter.setClipping (false);
 
 	float const x = _p.display_mode == hsi::DisplayMode::Auxiliary ? 0.775f * size.width() : 0.725f * size.width();
-	QString hint = _p.positioning_hint->value_or ("");
+	QString hint = _p.positioning_hint.value_or ("");
 
 	// Box for emphasis:
 	QPen box_pen = Qt::NoPen;
 
-	if (_p.update_time < _p.positioning_hint.update_time() + 10_s)
+	if (_p.positioning_hint_emphasized)
 	{
 		if (hint == "")
 			hint = "---";
@@ -1521,6 +1659,122 @@ PaintingWork::paint_range()
 }
 
 
+MapImage
+PaintingWork::render_map (xf::PaintRequest::Metric const& metric,
+						  xf::InstrumentSupport const& instrument_support,
+						  xf::NavaidStorage const& navaid_storage,
+						  Parameters const& parameters,
+						  ResizeCache resize_cache,
+						  CurrentNavaids& current_navaids,
+						  nu::Logger const& logger)
+{
+	auto const half_size = static_cast<int> (std::ceil (kMapOversize * resize_cache.r));
+	QImage image (2 * half_size, 2 * half_size, QImage::Format_ARGB32_Premultiplied);
+	image.fill (Qt::transparent);
+
+	// Paint with the aircraft in the center of the image, clip only to the image itself:
+	resize_cache.aircraft_center_transform = QTransform::fromTranslate (half_size, half_size);
+	resize_cache.outer_map_clip = QPainterPath();
+	resize_cache.outer_map_clip.addRect (QRectF (-half_size, -half_size, 2 * half_size, 2 * half_size));
+	// Resize cache is already up to date, prevent recomputing it:
+	Mutable mutable_ { parameters.display_mode, parameters.range };
+	QTransform features_transform;
+
+	{
+		xf::PaintRequest const paint_request (image, metric, image.size());
+		PaintingWork work (paint_request, instrument_support, navaid_storage, parameters, resize_cache, current_navaids, mutable_, logger);
+		work.paint_radio_range_map();
+		work.paint_navaids();
+		features_transform = work._features_transform;
+	}
+
+	return { image, metric, parameters, features_transform };
+}
+
+
+void
+PaintingWork::paint_map()
+{
+	if (!_map_cache || !_p.position)
+	{
+		paint_radio_range_map();
+		paint_navaids();
+		return;
+	}
+
+	update_map_cache();
+
+	auto const& map = *_map_cache->map;
+	// Rotate the map from the heading it's been rendered for to the current one and move it,
+	// so that the aircraft position it's been rendered for lands where it should be now:
+	auto const map_center = get_feature_xy (*map.parameters.position);
+	auto const map_transform = map.features_transform.inverted()
+		* _features_transform
+		* QTransform::fromTranslate (map_center.x(), map_center.y())
+		* _c.aircraft_center_transform;
+
+	_painter.setTransform (_c.aircraft_center_transform);
+	_painter.setClipPath (_c.outer_map_clip);
+	_painter.setTransform (map_transform);
+	_painter.drawImage (QPointF (-0.5f * map.image.width(), -0.5f * map.image.height()), map.image);
+}
+
+
+void
+PaintingWork::update_map_cache()
+{
+	auto& cache = *_map_cache;
+	auto const& metric = _paint_request.metric();
+
+	auto const reusable = [&] (MapImage const& map) {
+		return map.metric == metric && same_map_inputs (map.parameters, _p);
+	};
+
+	// Take the map rendered in background, if it's ready:
+	if (cache.next_map.valid() && cache.next_map.wait_for (std::chrono::seconds (0)) == std::future_status::ready)
+		if (auto next_map = cache.next_map.get(); reusable (next_map))
+			cache.map = std::move (next_map);
+
+	if (!cache.map || !reusable (*cache.map))
+	{
+		// Nothing to show in the meantime, so render synchronously:
+		cache.map = render_map (metric, _instrument_support, _navaid_storage, _p, _c, _current_navaids, _logger);
+	}
+	else if (!cache.next_map.valid() && map_drifted (*cache.map))
+	{
+		if (_work_performer)
+		{
+			// Keep using the current map until the new one is ready. Use own navaids storage,
+			// since the shared one is only valid while the painting task holds its lock:
+			cache.next_map = _work_performer->submit ([
+				metric,
+				&instrument_support = _instrument_support,
+				&navaid_storage = _navaid_storage,
+				parameters = _p,
+				resize_cache = _c,
+				&logger = _logger
+			] {
+				CurrentNavaids current_navaids;
+				return render_map (metric, instrument_support, navaid_storage, parameters, resize_cache, current_navaids, logger);
+			});
+		}
+		else
+			cache.map = render_map (metric, _instrument_support, _navaid_storage, _p, _c, _current_navaids, _logger);
+	}
+}
+
+
+bool
+PaintingWork::map_drifted (MapImage const& map) const
+{
+	auto const rotation = map.features_transform.inverted() * _features_transform;
+	auto const rotation_angle = 1_rad * std::abs (std::atan2 (rotation.m12(), rotation.m11()));
+	auto const shift = xf::haversine_earth (*map.parameters.position, *_p.position);
+
+	return rotation_angle > kMapMaxRotation || shift > kMapMaxShift * _p.range;
+}
+
+
 void
 PaintingWork::paint_navaids()
 {
@@ -1536,33 +1790,10 @@ PaintingWork::paint_navaids()
 	retrieve_navaids();
 	paint_locs();
 
-	// Return feature position on screen relative to _c.aircraft_center_transform.
-	// Essentially does get_feature_xy() but it may additionally "limit-to-range" (which is used by eg. Home feature)
-	// to be drawn on the edge even if it so far that it shouldn't be visible at all).
-	auto position_feature = [&] (si::LonLat const& position, bool* limit_to_range = nullptr) -> QPointF
-	{
-		QPointF mapped_pos = get_feature_xy (position);
-
-		if (limit_to_range)
-		{
-			float const range = 0.95f * _c.r;
-			float const rpx = std::sqrt (mapped_pos.x() * mapped_pos.x() + mapped_pos.y() * mapped_pos.y());
-			*limit_to_range = rpx >= range;
-			if (*limit_to_range)
-			{
-				QTransform rot;
-				rot.rotate ((1_rad * std::atan2 (mapped_pos.y(), mapped_pos.x())).in<si::Degree>());
-				mapped_pos = rot.map (QPointF (range, 0.0));
-			}
-		}
-
-		return mapped_pos;
-	};
-
 	auto paint_navaid = [&] (xf::Navaid const& navaid)
 	{
 		QTransform feature_centered_transform = _c.aircraft_center_transform;
-		QPointF translation = position_feature (navaid.position());
+		QPointF translation = get_feature_xy (navaid.position());
 		feature_centered_transform.translate (translation.x(), translation.y());
 
 		QTransform feature_scaled_transform = feature_centered_transform;
@@ -1690,78 +1921,111 @@ PaintingWork::paint_navaids()
 	};
 
 	if (_p.fix_visible)
-		for (auto const& navaid: _current_navaids.fix_navs)
-			paint_navaid (navaid);
+		for (auto const* navaid: _current_navaids.fix_navs)
+			paint_navaid (*navaid);
 
 	if (_p.ndb_visible)
-		for (auto const& navaid: _current_navaids.ndb_navs)
-			paint_navaid (navaid);
+		for (auto const* navaid: _current_navaids.ndb_navs)
+			paint_navaid (*navaid);
 
 	if (_p.dme_visible)
-		for (auto const& navaid: _current_navaids.dme_navs)
-			paint_navaid (navaid);
+		for (auto const* navaid: _current_navaids.dme_navs)
+			paint_navaid (*navaid);
 
 	if (_p.vor_visible)
-		for (auto const& navaid: _current_navaids.vor_navs)
-			paint_navaid (navaid);
+		for (auto const* navaid: _current_navaids.vor_navs)
+			paint_navaid (*navaid);
 
 	if (_p.arpt_visible)
-		for (auto const& navaid: _current_navaids.arpt_navs)
-			paint_navaid (navaid);
-
-	if (_p.home)
-	{
-		// Whether the feature is in configured HSI range:
-		bool outside_range = false;
-		QPointF translation = position_feature (*_p.home, &outside_range);
-		QTransform feature_centered_transform = _c.aircraft_center_transform;
-		feature_centered_transform.translate (translation.x(), translation.y());
+		for (auto const* navaid: _current_navaids.arpt_navs)
+			paint_navaid (*navaid);
+}
 
-		// Line from aircraft to the HOME feature:
-		if (_p.home_track_visible)
-		{
-			float green_pen_width = 1.5f;
-			float shadow_pen_width = 2.5f;
 
-			if (_p.display_mode == hsi::DisplayMode::Auxiliary)
-			{
-				green_pen_width = 1.2f;
-				shadow_pen_width = 2.2f;
-			}
-
-			float const shadow_scale = shadow_pen_width / green_pen_width;
+void
+PaintingWork::paint_home()
+{
+	if (!_p.navaids_visible || !_p.position || !_p.home)
+		return;
 
-			QPen home_line_pen = _aids.get_pen (_c.home_pen.color(), green_pen_width, Qt::DashLine, Qt::RoundCap);
-			home_line_pen.setDashPattern (QVector<qreal>() << 7.5 << 12);
+	float const scale = 0.55f * _c.q;
 
-			QPen shadow_pen = _aids.get_pen (_c.black_shadow.color(), shadow_pen_width, Qt::DashLine, Qt::RoundCap);
-			shadow_pen.setDashPattern (QVector<qreal>() << 7.5 / shadow_scale << 12 / shadow_scale);
+	_painter.setTransform (_c.aircraft_center_transform);
+	_painter.setClipPath (_c.outer_map_clip);
 
-			_painter.setTransform (_c.aircraft_center_transform);
+	// Return feature position on screen relative to _c.aircraft_center_transform.
+	// Essentially does get_feature_xy() but it may additionally "limit-to-range" (which is used by eg. Home feature)
+	// to be drawn on the edge even if it so far that it shouldn't be visible at all).
+	auto position_feature = [&] (si::LonLat const& position, bool* limit_to_range = nullptr) -> QPointF
+	{
+		QPointF mapped_pos = get_feature_xy (position);
 
-			for (auto const& p: { shadow_pen, home_line_pen })
+		if (limit_to_range)
+		{
+			float const range = 0.95f * _c.r;
+			float const rpx = std::sqrt (mapped_pos.x() * mapped_pos.x() + mapped_pos.y() * mapped_pos.y());
+			*limit_to_range = rpx >= range;
+			if (*limit_to_range)
 			{
-				_painter.setPen (p);
-				_painter.drawLine (QPointF (0.f, 0.f), translation);
+				QTransform rot;
+				rot.rotate ((1_rad * std::atan2 (mapped_pos.y(), mapped_pos.x())).in<si::Degree>());
+				mapped_pos = rot.map (QPointF (range, 0.0));
 			}
 		}
 
-		_painter.setTransform (feature_centered_transform);
-		_painter.scale (scale, scale);
+		return mapped_pos;
+	};
+
+	// Whether the feature is in configured HSI range:
+	bool outside_range = false;
+	QPointF translation = position_feature (*_p.home, &outside_range);
+	QTransform feature_centered_transform = _c.aircraft_center_transform;
+	feature_centered_transform.translate (translation.x(), translation.y());
 
-		if (outside_range)
+	// Line from aircraft to the HOME feature:
+	if (_p.home_track_visible)
+	{
+		float green_pen_width = 1.5f;
+		float shadow_pen_width = 2.5f;
+
+		if (_p.display_mode == hsi::DisplayMode::Auxiliary)
 		{
-			_painter.setPen (_c.home_pen);
-			_painter.setBrush (Qt::black);
-			_painter.drawPolygon (_c.home_shape);
+			green_pen_width = 1.2f;
+			shadow_pen_width = 2.2f;
 		}
-		else
+
+		float const shadow_scale = shadow_pen_width / green_pen_width;
+
+		QPen home_line_pen = _aids.get_pen (_c.home_pen.color(), green_pen_width, Qt::DashLine, Qt::RoundCap);
+		home_line_pen.setDashPattern (QVector<qreal>() << 7.5 << 12);
+
+		QPen shadow_pen = _aids.get_pen (_c.black_shadow.color(), shadow_pen_width, Qt::DashLine, Qt::RoundCap);
+		shadow_pen.setDashPattern (QVector<qreal>() << 7.5 / shadow_scale << 12 / shadow_scale);
+
+		_painter.setTransform (_c.aircraft_center_transform);
+
+		for (auto const& p: { shadow_pen, home_line_pen })
 		{
-			_painter.setPen (_c.home_pen);
-			_painter.setBrush (_c.home_pen.color());
-			_painter.drawPolygon (_c.home_shape);
+			_painter.setPen (p);
+			_painter.drawLine (QPointF (0.f, 0.f), translation);
 		}
 	}
+
+	_painter.setTransform (feature_centered_transform);
+	_painter.scale (scale, scale);
+
+	if (outside_range)
+	{
+		_painter.setPen (_c.home_pen);
+		_painter.setBrush (Qt::black);
+		_painter.drawPolygon (_c.home_shape);
+	}
+	else
+	{
+		_painter.setPen (_c.home_pen);
+		_painter.setBrush (_c.home_pen.color());
+		_painter.drawPolygon (_c.home_shape);
+	}
 }
 
 
@@ -1874,13 +2138,13 @@ PaintingWork::paint_locs()
 	_painter.setPen (_c.lo_loc_pen);
 	xf::Navaid const* hi_loc = nullptr;
 
-	for (auto const& navaid: _current_navaids.loc_navs)
+	for (auto const* navaid: _current_navaids.loc_navs)
 	{
 		// Paint highlighted LOC at the end, so it's on top:
-		if (navaid.identifier() == _p.highlighted_loc)
-			hi_loc = &navaid;
+		if (navaid->identifier() == _p.highlighted_loc)
+			hi_loc = navaid;
 		else
-			paint_loc (navaid);
+			paint_loc (*navaid);
 	}
 
 	// Paint identifiers:
@@ -2004,9 +2268,9 @@ PaintingWork::retrieve_navaids()
 	_current_navaids.loc_navs.clear();
 	_current_navaids.arpt_navs.clear();
 
-	for (xf::Navaid const& navaid: _navaid_storage.get_navs (*_p.position, std::max (_p.range + 20_nmi, 2.f * _p.range)))
+	for (xf::Navaid const* navaid: _navaid_storage.get_navs (*_p.position, std::max (_p.range + 20_nmi, 2.f * _p.range)))
 	{
-		switch (navaid.type())
+		switch (navaid->type())
 		{
 			case xf::Navaid::LOC:
 				_current_navaids.loc_navs.push_back (navaid);
@@ -2119,6 +2383,14 @@ HSI::HSI (xf::ProcessingLoop& loop, xf::Graphics const& graphics, xf::NavaidStor
 { }
 
 
+HSI::~HSI()
+{
+	// Map rendered in background uses references to members of this HSI:
+	if (auto map_cache = _map_cache.lock(); map_cache->next_map.valid())
+		map_cache->next_map.wait();
+}
+
+
 void
 HSI::process (xf::Cycle const& cycle)
 {
@@ -2186,6 +2458,7 @@ HSI::process (xf::Cycle const& cycle)
 		params.position.reset();
 
 	params.navaids_visible = _io.orientation_heading_true.valid();
+	params.navaids_loaded = _navaid_storage.loaded();
 	params.fix_visible = _io.features_fix.value_or (false);
 	params.vor_visible = _io.features_vor.value_or (false);
 	params.dme_visible = _io.features_dme.value_or (false);
@@ -2193,7 +2466,8 @@ HSI::process (xf::Cycle const& cycle)
 	params.loc_visible = _io.features_loc.value_or (false);
 	params.arpt_visible = _io.features_arpt.value_or (false);
 	params.highlighted_loc = nu::to_qstring (_io.localizer_id.value_or (""));
-	params.positioning_hint.set (_io.position_source ? std::make_optional (nu::to_qstring (*_io.position_source)) : std::nullopt, _io.position_source.modification_timestamp());
+	params.positioning_hint = _io.position_source ? std::make_optional (nu::to_qstring (*_io.position_source)) : std::nullopt;
+	params.positioning_hint_emphasized = cycle.update_time() < _io.position_source.modification_timestamp() + 10_s;
 	params.tcas_on = _io.tcas_on.get_optional();
 	params.tcas_range = _io.tcas_range.get_optional();
 	params.arpt_runways_range_threshold = *_io.arpt_runways_range_threshold;
@@ -2237,7 +2511,15 @@ HSI::process (xf::Cycle const& cycle)
 	}
 
 	_parameters.store (params);
-	mark_dirty();
+
+	// Only repaint if something visible has changed:
+	params.quantize (canvas_size());
+
+	if (params != _painted_parameters)
+	{
+		_painted_parameters = std::move (params);
+		mark_dirty();
+	}
 }
 
 
@@ -2250,9 +2532,11 @@ HSI::paint (xf::PaintRequest paint_request) const
 		pp = _parameters.load(),
 		rc_lock = _resize_cache.lock(),
 		cn_lock = _current_navaids.lock(),
-		mu_lock = _mutable.lock()
+		mu_lock = _mutable.lock(),
+		mc_lock = _map_cache.lock(),
+		performer = work_performer()
 	] mutable {
 		pp.sanitize();
-		hsi_detail::PaintingWork (pr, _instrument_support, _navaid_storage, pp, *rc_lock, *cn_lock, *mu_lock, _logger).paint();
+		hsi_detail::PaintingWork (pr, _instrument_support, _navaid_storage, pp, *rc_lock, *cn_lock, *mu_lock, _logger, &*mc_lock, performer).paint();
 	});
 }
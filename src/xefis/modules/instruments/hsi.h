@@ -22,7 +22,6 @@
 #include <xefis/core/sockets/socket.h>
 #include <xefis/support/instrument/instrument_support.h>
 #include <xefis/utility/event_timestamper.h>
-#include <xefis/utility/temporal.h>
 #include <xefis/support/universe/earth/navaid_storage.h>
 
 // Neutrino:
@@ -35,6 +34,7 @@
 #include <array>
 #include <cstddef>
 #include <future>
+#include <optional>
 
 
 namespace nu = neutrino;
@@ -179,6 +179,11 @@ class CircularArea
   public:
 	si::LonLat	center;
 	si::Length	radius;
+
+  public:
+	[[nodiscard]]
+	bool
+	operator== (CircularArea const&) const;
 };
 
 
@@ -240,8 +245,11 @@ class Parameters
 	bool									ndb_visible								{ false };
 	bool									loc_visible								{ false };
 	bool									arpt_visible							{ false };
+	// Navaid storage returns no navaids until it's loaded:
+	bool									navaids_loaded							{ false };
 	QString									highlighted_loc;
-	xf::Temporal<std::optional<QString>>	positioning_hint;
+	std::optional<QString>					positioning_hint;
+	bool									positioning_hint_emphasized				{ false };
 	std::optional<bool>						tcas_on;
 	std::optional<si::Length>				tcas_range;
 	si::Length								arpt_runways_range_threshold;
@@ -264,6 +272,18 @@ class Parameters
 	 */
 	void
 	sanitize();
+
+	/**
+	 * Round continuous values to a fraction of a pixel on a canvas of given size
+	 * and reset the update time. Two quantized Parameters that compare equal
+	 * produce the same image.
+	 */
+	void
+	quantize (QSize canvas_size);
+
+	[[nodiscard]]
+	bool
+	operator== (Parameters const&) const;
 };
 
 
@@ -326,16 +346,59 @@ struct Mutable
 };
 
 
+/**
+ * Navaids and radio range map rendered into an image centered on the aircraft.
+ */
+struct MapImage
+{
+	QImage						image;
+	xf::PaintRequest::Metric	metric;
+	// Parameters (including aircraft position) the map has been rendered for:
+	Parameters					parameters;
+	// Rotation of ground features at the time of rendering:
+	QTransform					features_transform;
+};
+
+
+/**
+ * Rendered map reused between paints. As long as map inputs stay the same, the image
+ * is only rotated and translated to follow the aircraft. When it drifts too far,
+ * a new image is rendered in background.
+ */
+struct MapCache
+{
+	std::optional<MapImage>	map;
+	std::future<MapImage>	next_map;
+};
+
+
 class PaintingWork
 {
+	// Size of the map image relative to the map radius. Must be big enough to cover the map area
+	// when the image gets rotated and moved before a new one is rendered:
+	static constexpr float		kMapOversize		= 1.3f;
+	// How far (relative to the range) the aircraft may move before the map is rendered again:
+	static constexpr float		kMapMaxShift		= 0.1f;
+	// How much the map may be rotated before it's rendered again (labels get rotated, too):
+	static constexpr si::Angle	kMapMaxRotation		= 2_deg;
+
   public:
 	// Ctor
 	explicit
-	PaintingWork (xf::PaintRequest const&, xf::InstrumentSupport const&, xf::NavaidStorage const&, Parameters const&, ResizeCache&, CurrentNavaids&, Mutable&, nu::Logger const&);
+	PaintingWork (xf::PaintRequest const&, xf::InstrumentSupport const&, xf::NavaidStorage const&, Parameters const&, ResizeCache&, CurrentNavaids&, Mutable&, nu::Logger const&,
+				  MapCache* = nullptr, nu::WorkPerformer* = nullptr);
 
 	void
 	paint();
 
+	/**
+	 * Render navaids and radio range map into a new image with the aircraft in its center.
+	 * The image is big enough to cover the whole map area when rotated and moved by
+	 * the allowed drift.
+	 */
+	static MapImage
+	render_map (xf::PaintRequest::Metric const&, xf::InstrumentSupport const&, xf::NavaidStorage const&, Parameters const&, ResizeCache, CurrentNavaids&, nu::Logger const&);
+
   private:
 	void
 	paint_aircraft();
@@ -382,9 +445,32 @@ class PaintingWork
 	void
 	paint_range();
 
+	/**
+	 * Paint navaids and radio range map, using the map cache if available.
+	 */
+	void
+	paint_map();
+
+	/**
+	 * Use the cached map if it's still valid, otherwise render it again.
+	 * Start rendering the next map in background if the aircraft moved or turned too much.
+	 */
+	void
+	update_map_cache();
+
+	/**
+	 * Return true if the aircraft moved or turned too much for the map image to be reused.
+	 */
+	[[nodiscard]]
+	bool
+	map_drifted (MapImage const&) const;
+
 	void
 	paint_navaids();
 
+	void
+	paint_home();
+
 	void
 	paint_radio_range_map();
 
@@ -445,11 +531,14 @@ class PaintingWork
   private:
 	nu::Logger const&						_logger;
 	xf::PaintRequest const&					_paint_request;
+	xf::InstrumentSupport const&			_instrument_support;
 	xf::NavaidStorage const&				_navaid_storage;
 	Parameters const&						_p;
 	ResizeCache&							_c;
 	CurrentNavaids&							_current_navaids;
 	Mutable&								_mutable;
+	MapCache*								_map_cache;
+	nu::WorkPerformer*						_work_performer;
 
 	xf::InstrumentPainter					_painter;
 	std::shared_ptr<xf::InstrumentAids>		_aids_ptr;
@@ -586,6 +675,9 @@ class HSI: public HSI_IO
 	// Ctor
 	HSI (xf::ProcessingLoop&, xf::Graphics const&, xf::NavaidStorage const&, nu::Logger const&, std::string_view const instance = {});
 
+	// Dtor
+	~HSI();
+
 	// Module API
 	void
 	process (xf::Cycle const&) override;
@@ -600,9 +692,11 @@ class HSI: public HSI_IO
 	xf::NavaidStorage const&								_navaid_storage;
 	xf::InstrumentSupport									_instrument_support;
 	nu::Synchronized<hsi_detail::Parameters> mutable		_parameters;
+	hsi_detail::Parameters									_painted_parameters;
 	nu::Synchronized<hsi_detail::ResizeCache> mutable		_resize_cache;
 	nu::Synchronized<hsi_detail::CurrentNavaids> mutable	_current_navaids;
 	nu::Synchronized<hsi_detail::Mutable> mutable			_mutable;
+	nu::Synchronized<hsi_detail::MapCache> mutable			_map_cache;
 };
 
 #endif
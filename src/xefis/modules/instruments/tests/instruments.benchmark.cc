@@ -0,0 +1,360 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/core/graphics.h>
+#include <xefis/core/instrument.h>
+#include <xefis/core/paint_request.h>
+#include <xefis/core/screen_spec.h>
+#include <xefis/modules/instruments/adi.h>
+#include <xefis/modules/instruments/datatable.h>
+#include <xefis/modules/instruments/flaps.h>
+#include <xefis/modules/instruments/gear.h>
+#include <xefis/modules/instruments/horizontal_trim.h>
+#include <xefis/modules/instruments/hsi.h>
+#include <xefis/modules/instruments/label.h>
+#include <xefis/modules/instruments/linear_gauge.h>
+#include <xefis/modules/instruments/radial_gauge.h>
+#include <xefis/modules/instruments/vertical_trim.h>
+#include <xefis/modules/test/test_generator.h>
+#include <xefis/support/universe/earth/navaid_storage.h>
+#include <xefis/test/benchmark.h>
+#include <xefis/test/test_processing_loop.h>
+
+// Neutrino:
+#include <neutrino/exception.h>
+#include <neutrino/time.h>
+
+// Qt:
+#include <QImage>
+#include <QSizeF>
+
+// Standard:
+#include <cstddef>
+#include <format>
+#include <string_view>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+constexpr si::Time	kFrameTime		= 1 / 30_Hz;
+constexpr size_t	kWarmUpFrames	= 30;
+constexpr size_t	kFrames			= 300;
+
+
+/**
+ * Displays the instruments are painted for. Pen width and font height are the same as
+ * in the test instruments machine, so that the results are comparable with a live Screen.
+ */
+std::vector<std::pair<std::string_view, ScreenSpec>> const kScreens {
+	{ "7\" 800×480",		ScreenSpec (QRect (0, 0, 800, 480), 7_in, 60_Hz, 0.3525_mm, 3.15_mm) },
+	{ "15\" 1366×768",		ScreenSpec (QRect (0, 0, 1366, 768), 15_in, 60_Hz, 0.3525_mm, 3.15_mm) },
+	{ "13\" 2560×1600",		ScreenSpec (QRect (0, 0, 2560, 1600), 13.3_in, 60_Hz, 0.3525_mm, 3.15_mm) },
+};
+
+
+/**
+ * Paint the instrument offscreen on each of the test screens, advancing the processing loop
+ * (and so the test generators) by one frame before each painting. Reported times include
+ * both Instrument::paint() and the returned painting task, which is what a Screen waits for.
+ *
+ * \param	relative_size
+ *			Size of the instrument canvas relative to the screen size.
+ * \param	variant
+ *			Optional suffix for the reported labels.
+ */
+void
+benchmark_instrument (Benchmark& benchmark, TestProcessingLoop& loop, Instrument& instrument, QSizeF const relative_size, std::string_view const variant = {})
+{
+	for (auto const& [screen_name, spec]: kScreens)
+	{
+		auto const screen_size = spec.position_and_size().size();
+		auto const canvas_size = QSizeF (relative_size.width() * screen_size.width(), relative_size.height() * screen_size.height()).toSize();
+		auto const metric = PaintRequest::Metric (canvas_size, spec.pixel_density(), spec.base_pen_width(), spec.base_font_height());
+		auto const dots_per_meter = spec.pixel_density().in<si::DotsPerMeter>();
+
+		QImage canvas (canvas_size, QImage::Format_ARGB32_Premultiplied);
+		canvas.setDotsPerMeterX (dots_per_meter);
+		canvas.setDotsPerMeterY (dots_per_meter);
+
+		QSize previous_size;
+		std::vector<si::Time> samples;
+		samples.reserve (kFrames);
+
+		for (size_t frame = 0; frame < kWarmUpFrames + kFrames; ++frame)
+		{
+			loop.next_cycle();
+			canvas.fill (Qt::transparent);
+
+			auto const frame_time = nu::measure_time ([&] {
+				auto task = instrument.paint (PaintRequest (canvas, metric, previous_size));
+				auto result = task.get_future();
+				task();
+				result.get();
+			});
+
+			previous_size = canvas_size;
+
+			if (frame >= kWarmUpFrames)
+				samples.push_back (frame_time);
+		}
+
+		auto label = std::format ("{}, canvas {}×{}", screen_name, canvas_size.width(), canvas_size.height());
+
+		if (!variant.empty())
+			label += std::format (", {}", variant);
+
+		benchmark.report (label, std::move (samples));
+	}
+}
+
+
+xf::Benchmark b1 ("Instruments: ADI painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	ADI adi (loop, graphics, "adi");
+
+	adi.weight_on_wheels				<< false;
+	adi.speed_ias						<< generator.create_socket<si::Velocity> ("speed/ias", 0_kt, { 0_kt, 300_kt }, 10_kt / 1_s);
+	adi.speed_ias_lookahead				<< generator.create_socket<si::Velocity> ("speed/ias.lookahead", 25_kt, { 0_kt, 300_kt }, 8_kt / 1_s);
+	adi.speed_ias_minimum				<< 60_kt;
+	adi.speed_ias_maximum				<< 250_kt;
+	adi.speed_mach						<< generator.create_socket<double> ("speed/mach", 0.0, { 0.0, 0.85 }, 0.025 / 1_s);
+	adi.speed_ground					<< generator.create_socket<si::Velocity> ("speed/ground-speed", 0_kt, { 0_kt, 400_kt }, 13_kt / 1_s);
+	adi.speed_v1						<< 80_kt;
+	adi.speed_vr						<< 88_kt;
+	adi.speed_vref						<< 95_kt;
+	adi.orientation_pitch				<< generator.create_socket<si::Angle> ("orientation/pitch", 0_deg, { -30_deg, 30_deg }, 8_deg / 1_s);
+	adi.orientation_roll				<< generator.create_socket<si::Angle> ("orientation/roll", 0_deg, { -60_deg, 60_deg }, 15_deg / 1_s);
+	adi.orientation_heading_magnetic	<< generator.create_socket<si::Angle> ("orientation/heading.magnetic", 0_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic);
+	adi.orientation_heading_numbers_visible << true;
+	adi.track_lateral_magnetic			<< generator.create_socket<si::Angle> ("track/lateral.magnetic", 9_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic);
+	adi.track_vertical					<< generator.create_socket<si::Angle> ("track/vertical", 0_deg, { -13_deg, 13_deg }, 1_deg / 1_s);
+	adi.fpv_visible						<< true;
+	adi.slip_skid						<< generator.create_socket<si::Angle> ("slip-skid/angle", 0_deg, { -5_deg, 5_deg }, 0.5_deg / 1_s);
+	adi.aoa_alpha						<< generator.create_socket<si::Angle> ("aoa/alpha", 0_deg, { -7_deg, 15_deg }, 1_deg / 1_s);
+	adi.aoa_alpha_maximum				<< 13_deg;
+	adi.aoa_alpha_visible				<< true;
+	adi.altitude_amsl					<< generator.create_socket<si::Length> ("altitude/amsl", -200_ft, { -200_ft, 2000_ft }, 2000_ft / 1_min);
+	adi.altitude_agl_serviceable		<< true;
+	adi.altitude_agl					<< generator.create_socket<si::Length> ("altitude/agl", -4_ft, { -4_ft, 30_m }, 100_ft / 1_min);
+	adi.decision_height_type			<< "BARO";
+	adi.decision_height_setting			<< 300_ft;
+	adi.decision_height_amsl			<< 300_ft;
+	adi.landing_amsl					<< 140_ft;
+	adi.vertical_speed					<< generator.create_socket<si::Velocity> ("vertical-speed/speed", 0_fpm, { -6000_fpm, +6000_fpm }, 100_fpm / 1_s);
+	adi.pressure_qnh					<< 1013_hPa;
+	adi.pressure_display_hpa			<< true;
+	adi.flight_director_serviceable		<< true;
+	adi.flight_director_cmd_visible		<< true;
+	adi.flight_director_cmd_altitude	<< 1000_ft;
+	adi.flight_director_cmd_ias			<< 100_kt;
+	adi.flight_director_guidance_visible << true;
+	adi.flight_director_guidance_pitch	<< generator.create_socket<si::Angle> ("flight-director/guidance.pitch", 0_deg, { -5_deg, 5_deg }, 1_deg / 1_s);
+	adi.flight_director_guidance_roll	<< generator.create_socket<si::Angle> ("flight-director/guidance.roll", 0_deg, { -10_deg, 10_deg }, 2_deg / 1_s);
+	adi.flight_mode_fma_visible			<< true;
+	adi.flight_mode_fma_speed_hint		<< "THR REF";
+	adi.flight_mode_fma_lateral_hint	<< "HDG SEL";
+	adi.flight_mode_fma_vertical_hint	<< "VNAV PTH";
+
+	benchmark_instrument (benchmark, loop, adi, { 0.4, 0.6 });
+
+	adi.dilated_shadows = true;
+	benchmark_instrument (benchmark, loop, adi, { 0.4, 0.6 }, "dilated shadows");
+});
+
+
+xf::Benchmark b2 ("Instruments: HSI painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	NavaidStorage navaid_storage (TestProcessingLoop::logger, "share/nav/nav.dat.gz", "share/nav/fix.dat.gz", "share/nav/apt.dat.gz");
+	// Load before painting, so that the map contents don't change during the benchmark.
+	// Navigation data files aren't distributed with Xefis; without them the map has no navaids:
+	nu::Exception::catch_and_log (TestProcessingLoop::logger, [&] { navaid_storage.load(); });
+	HSI hsi (loop, graphics, navaid_storage, TestProcessingLoop::logger, "hsi");
+
+	hsi.arpt_runways_range_threshold	= 10_nmi;
+	hsi.arpt_map_range_threshold		= 1_nmi;
+	hsi.arpt_runway_extension_length	= 10_nmi;
+
+	hsi.range							<< 20_nmi;
+	hsi.speed_gs						<< generator.create_socket<si::Velocity> ("speed/ground-speed", 100_kt, { 100_kt, 400_kt }, 13_kt / 1_s);
+	hsi.speed_tas						<< generator.create_socket<si::Velocity> ("speed/true-airspeed", 100_kt, { 100_kt, 400_kt }, 17_kt / 1_s);
+	hsi.cmd_visible						<< true;
+	hsi.cmd_line_visible				<< true;
+	hsi.cmd_heading_magnetic			<< 90_deg;
+	hsi.orientation_heading_magnetic	<< generator.create_socket<si::Angle> ("orientation/heading.magnetic", 0_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic);
+	hsi.orientation_heading_true		<< generator.create_socket<si::Angle> ("orientation/heading.true", 10_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic);
+	hsi.heading_mode					<< hsi::HeadingMode::Magnetic;
+	hsi.position_longitude				<< generator.create_socket<si::Angle> ("position/longitude", 19.14_deg, { 19.14_deg, 20.14_deg }, 0.001_deg / 1_s);
+	hsi.position_latitude				<< generator.create_socket<si::Angle> ("position/latitude", 51.9_deg, { 51.9_deg, 52.9_deg }, 0.001_deg / 1_s);
+	hsi.position_source					<< "GPS";
+	hsi.track_visible					<< true;
+	hsi.track_lateral_magnetic			<< generator.create_socket<si::Angle> ("track/lateral.magnetic", 5_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic);
+	hsi.track_lateral_rotation			<< -1_deg / 1_s;
+	hsi.course_visible					<< true;
+	hsi.course_setting_magnetic			<< 45_deg;
+	hsi.course_deviation				<< generator.create_socket<si::Angle> ("course/deviation", 0_deg, { -10_deg, +10_deg }, 1_deg / 1_s);
+	hsi.course_to_flag					<< true;
+	hsi.wind_from_magnetic				<< 270_deg;
+	hsi.wind_speed_tas					<< 15_kt;
+	hsi.features_fix					<< true;
+	hsi.features_vor					<< true;
+	hsi.features_dme					<< true;
+	hsi.features_ndb					<< true;
+	hsi.features_loc					<< true;
+	hsi.features_arpt					<< true;
+
+	benchmark_instrument (benchmark, loop, hsi, { 0.4, 0.6 });
+});
+
+
+xf::Benchmark b3 ("Instruments: RadialGauge painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	RadialGauge<si::Power> gauge (loop, graphics, nullptr, "gauge");
+
+	gauge.format					= "{:3.0f}";
+	gauge.value_minimum				= 0_W;
+	gauge.value_maximum_warning		= 250_W;
+	gauge.value_maximum_critical	= 270_W;
+	gauge.value_maximum				= 280_W;
+
+	gauge.value						<< generator.create_socket<si::Power> ("value", 0_W, { -10_W, 290_W }, 20_W / 1_s);
+	gauge.reference					<< 240_W;
+	gauge.target					<< 200_W;
+	gauge.automatic					<< generator.create_socket<si::Power> ("automatic", 100_W, { 100_W, 150_W }, 5_W / 1_s);
+
+	benchmark_instrument (benchmark, loop, gauge, { 0.15, 0.2 });
+});
+
+
+xf::Benchmark b4 ("Instruments: LinearGauge painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	LinearGauge<si::Temperature> gauge (loop, graphics, nullptr, "gauge");
+
+	gauge.format					= "{:5.1f}";
+	gauge.value_minimum				= 25_degC;
+	gauge.value_maximum_warning		= 60_degC;
+	gauge.value_maximum_critical	= 65_degC;
+	gauge.value_maximum				= 65_degC;
+
+	gauge.value						<< generator.create_socket<si::Temperature> ("value", 25_degC, { 20_degC, 70_degC }, 5_K / 1_s);
+
+	benchmark_instrument (benchmark, loop, gauge, { 0.15, 0.1 });
+});
+
+
+xf::Benchmark b5 ("Instruments: Datatable painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	Datatable datatable (loop, graphics, "datatable");
+
+	datatable.set_label_font_size (1.1f);
+	datatable.set_value_font_size (1.3f);
+	datatable.add_line ("GS", generator.create_socket<si::Velocity> ("speed/ground-speed", 0_kt, { 0_kt, 400_kt }, 13_kt / 1_s));
+	datatable.add_line ("TAS", generator.create_socket<si::Velocity> ("speed/true-airspeed", 0_kt, { 0_kt, 400_kt }, 17_kt / 1_s));
+	datatable.add_line ("ALT", generator.create_socket<si::Length> ("altitude/amsl", 0_ft, { 0_ft, 2000_ft }, 100_ft / 1_s));
+	datatable.add_line ("HDG", generator.create_socket<si::Angle> ("heading", 0_deg, { 0_deg, 360_deg }, 2_deg / 1_s, TestGenerator::BorderCondition::Periodic));
+	datatable.add_line ("TEMP", generator.create_socket<si::Temperature> ("temperature", 0_degC, { -20_degC, 40_degC }, 1_K / 1_s), Qt::cyan);
+
+	benchmark_instrument (benchmark, loop, datatable, { 0.15, 0.15 });
+});
+
+xf::Benchmark b6 ("Instruments: Flaps painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	Flaps flaps (loop, graphics, "flaps");
+
+	flaps.maximum_angle				= 30_deg;
+	flaps.hide_retracted			= false;
+
+	flaps.current_angle				<< generator.create_socket<si::Angle> ("flaps/current", 0_deg, { 0_deg, 30_deg }, 2_deg / 1_s);
+	flaps.set_angle					<< 20_deg;
+
+	benchmark_instrument (benchmark, loop, flaps, { 0.1, 0.2 });
+});
+
+
+xf::Benchmark b7 ("Instruments: Gear painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	Gear gear (loop, graphics, "gear");
+
+	gear.requested_down				<< true;
+	gear.nose_up					<< false;
+	gear.nose_down					<< true;
+	gear.left_up					<< false;
+	gear.left_down					<< true;
+	gear.right_up					<< false;
+	gear.right_down					<< true;
+
+	benchmark_instrument (benchmark, loop, gear, { 0.1, 0.15 });
+});
+
+
+xf::Benchmark b8 ("Instruments: HorizontalTrim painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	HorizontalTrim trim (loop, graphics, "trim");
+
+	trim.label						= "RUDDER TRIM";
+
+	trim.trim_value					<< generator.create_socket<double> ("trim/value", -1.0, { -1.0, 1.0 }, 0.1 / 1_s);
+	trim.trim_reference				<< 0.0;
+	trim.trim_reference_minimum		<< -0.1;
+	trim.trim_reference_maximum		<< +0.1;
+
+	benchmark_instrument (benchmark, loop, trim, { 0.08, 0.12 });
+});
+
+
+xf::Benchmark b9 ("Instruments: VerticalTrim painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	TestGenerator generator (loop, "test generator");
+	VerticalTrim trim (loop, graphics, "trim");
+
+	trim.trim_value					<< generator.create_socket<double> ("trim/value", 0.0, { 0.0, 1.0 }, 0.1 / 1_s);
+	trim.trim_reference				<< 0.5;
+	trim.trim_reference_minimum		<< 0.35;
+	trim.trim_reference_maximum		<< 0.6;
+
+	benchmark_instrument (benchmark, loop, trim, { 0.1, 0.12 });
+});
+
+
+xf::Benchmark b10 ("Instruments: Label painting", [] (xf::Benchmark& benchmark) {
+	TestProcessingLoop loop (kFrameTime);
+	Graphics graphics (TestProcessingLoop::logger);
+	Label label (loop, graphics, "label");
+
+	label.label						= "AUTOPILOT";
+
+	benchmark_instrument (benchmark, loop, label, { 0.2, 0.05 });
+});
+
+
+} // namespace
+} // namespace xf::test
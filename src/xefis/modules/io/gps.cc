@@ -160,29 +160,27 @@ GPS::Connection::failure (std::string_view const reason)
 void
 GPS::Connection::serial_data_ready()
 {
-	_nmea_parser.feed (_serial_port->input_buffer());
-	_serial_port->input_buffer().clear();
-
+	auto input = BlobView (_serial_port->input_buffer());
 	bool try_next = true;
 
 	do {
 		try_next = true;
 
 		try {
-			auto const gps_message = _nmea_parser.process_next();
+			auto const gps_message = _nmea_parser.process_next (input);
 
 			std::visit (nu::overload {
-				[&] (xf::nmea::GPGGA const& msg) {
-					process_nmea_sentence (msg);
+				[&] (xf::nmea::GPGGA const* msg) {
+					process_nmea_sentence (*msg);
 				},
-				[&] (xf::nmea::GPGSA const& msg) {
-					process_nmea_sentence (msg);
+				[&] (xf::nmea::GPGSA const* msg) {
+					process_nmea_sentence (*msg);
 				},
-				[&] (xf::nmea::GPRMC const& msg) {
-					process_nmea_sentence (msg);
+				[&] (xf::nmea::GPRMC const* msg) {
+					process_nmea_sentence (*msg);
 				},
-				[&] (xf::nmea::PMTKACK const& msg) {
-					process_nmea_sentence (msg);
+				[&] (xf::nmea::PMTKACK const* msg) {
+					process_nmea_sentence (*msg);
 				},
 				[&] (std::monostate) noexcept {
 					try_next = false;
@@ -198,6 +196,9 @@ GPS::Connection::serial_data_ready()
 			_gps_module.logger() << "Exception when processing NMEA sentence: " << std::current_exception() << std::endl;
 		}
 	} while (try_next);
+
+	// Parser keeps partial sentences by itself:
+	_serial_port->input_buffer().clear();
 }
 
 
@@ -104,6 +104,10 @@ XBee::XBee (xf::ProcessingLoop& loop, nu::Logger const& logger, std::string_view
 	_io.failures.set_fallback (0);
 	_io.cca_failures.set_fallback (0);
 
+	// Delimiter (1B) + packet size (2B) + data (1B) + checksum (1B) gives
+	// at least 5 bytes:
+	_packet_reader.set_minimum_packet_size (5);
+
 	open_device();
 }
 
@@ -225,10 +229,7 @@ XBee::read()
 		failure ("read()");
 
 	if (!buffer.empty())
-	{
-		_input_buffer += buffer;
-		process_input();
-	}
+		process_input (buffer);
 }
 
 
@@ -757,88 +758,67 @@ XBee::vector_to_uint16 (std::vector<uint8_t> const& vector, uint16_t& result) co
 
 
 void
-XBee::process_input()
+XBee::process_input (std::string_view const data)
 {
-	ResponseAPI api;
-	std::string data;
+	auto const discarded_before = _packet_reader.discarded_bytes();
+	_packet_reader.feed (BlobView (reinterpret_cast<uint8_t const*> (data.data()), data.size()));
+	// Discard non-parseable data:
+	_io.input_errors = *_io.input_errors + nu::to_signed (_packet_reader.discarded_bytes() - discarded_before);
+}
 
-	while (process_packet (_input_buffer, api, data))
-	{
-		switch (api)
-		{
-			case ResponseAPI::RX64:
-				process_rx64_frame (data);
-				break;
 
-			case ResponseAPI::RX16:
-				process_rx16_frame (data);
-				break;
+std::size_t
+XBee::parse_packet (BlobView const packet)
+{
+	// Packet size:
+	uint32_t size = (static_cast<uint32_t> (packet[1]) << 8u) + static_cast<uint32_t> (packet[2]);
 
-			case ResponseAPI::TXStatus:
-				// Not really supported/handled. Just ignore.
-				break;
+	// Skip the delimiter if packet can't be valid:
+	if (size == 0)
+		return 1;
 
-			case ResponseAPI::ModemStatus:
-				process_modem_status_frame (data);
-				break;
+	if (packet.size() < size + 4u) // delimiter, size, checksum = 4B
+		return 0;
 
-			case ResponseAPI::ATResponse:
-				process_at_response_frame (data);
-				break;
-		}
+	// Checksum:
+	uint8_t checksum = 0;
+	for (std::size_t i = 3; i < size + 4u; ++i)
+		checksum += packet[i];
+	if (checksum != 0xff)
+	{
+		_logger << "Checksum invalid on input packet." << std::endl;
+		// Checksum invalid. Discard data up to next packet delimiter:
+		return 1;
 	}
-}
 
+	// Data is there, checksum is valid, what else do we need?
+	auto const api = static_cast<ResponseAPI> (packet[3]);
+	auto const data = std::string_view (reinterpret_cast<char const*> (packet.data()) + 4, size - 1);
 
-bool
-XBee::process_packet (std::string& input, ResponseAPI& api, std::string& data)
-{
-	for (;;)
+	switch (api)
 	{
-		std::string::size_type p = input.find (kPacketDelimiter);
-
-		if (p == std::string::npos)
-		{
-			input.clear();
-			return false;
-		}
-
-		// Discard non-parseable data:
-		input.erase (input.begin(), input.begin() + nu::to_signed (p));
-
-		_io.input_errors = *_io.input_errors + nu::to_signed (p);
-
-		// Delimiter (1B) + packet size (2B) + data (1B) + checksum (1B) gives
-		// at least 5 bytes:
-		if (input.size() < 5)
-			return false;
+		case ResponseAPI::RX64:
+			process_rx64_frame (data);
+			break;
 
-		// Packet size:
-		uint32_t size = (static_cast<uint32_t> (input[1]) << 8u) + static_cast<uint32_t> (input[2]);
-		if (input.size() < size + 4u) // delimiter, size, checksum = 4B
-			return false;
+		case ResponseAPI::RX16:
+			process_rx16_frame (data);
+			break;
 
-		// Checksum:
-		uint8_t checksum = 0;
-		for (std::string::size_type i = 3; i < size + 4u; ++i)
-			checksum += static_cast<uint8_t> (input[i]);
-		if (checksum != 0xff)
-		{
-			_logger << "Checksum invalid on input packet." << std::endl;
-			// Checksum invalid. Discard data up to next packet delimiter.
-			input.erase (0);
-			// Try parsing again:
-			continue;
-		}
+		case ResponseAPI::TXStatus:
+			// Not really supported/handled. Just ignore.
+			break;
 
-		// Data is there, checksum is valid, what else do we need?
-		api = static_cast<ResponseAPI> (input[3]);
-		data = input.substr (4, size - 1);
-		// Remove packet from buffer:
-		input.erase (input.begin(), input.begin() + size + 4u);
+		case ResponseAPI::ModemStatus:
+			process_modem_status_frame (data);
+			break;
 
-		return true;
+		case ResponseAPI::ATResponse:
+			process_at_response_frame (data);
+			break;
 	}
+
+	return size + 4u;
 }
 
 
@@ -20,6 +20,7 @@
 #include <xefis/core/setting.h>
 #include <xefis/core/sockets/module_socket.h>
 #include <xefis/support/sockets/socket_changed.h>
+#include <xefis/utility/packet_reader.h>
 #include <xefis/utility/smoother.h>
 
 // Neutrino:
@@ -340,19 +341,19 @@ class XBee:
 	vector_to_uint16 (std::vector<uint8_t> const& vector, uint16_t& result) const;
 
 	/**
-	 * Parse input buffer and react to input packets accordingly.
+	 * Feed input data to the packet reader and account discarded bytes.
 	 */
 	void
-	process_input();
+	process_input (std::string_view data);
 
 	/**
-	 * Parse out first packet from input buffer. If no packet can be parsed,
-	 * discard data up to the nearest packet delimiter, hoping that in future
-	 * more data appended will allow parsing out a packet.
-	 * On successful parse, return true and remove the packet from input buffer.
+	 * Parse out packet starting with packet delimiter and react to it accordingly.
+	 * Called by _packet_reader. Return number of bytes consumed or 0 if more data
+	 * is needed. On checksum error only the delimiter is consumed, so that data is
+	 * discarded up to the next packet delimiter.
 	 */
-	bool
-	process_packet (std::string& input, ResponseAPI& api, std::string& data);
+	std::size_t
+	parse_packet (BlobView packet);
 
 	/**
 	 * Parse RX from 64-bit address.
@@ -446,7 +447,7 @@ class XBee:
 	ConfigurationStep					_configuration_step		{ ConfigurationStep::Unconfigured };
 	int									_read_failure_count		{ 0 };
 	int									_write_failure_count	{ 0 };
-	std::string							_input_buffer;
+	xf::PacketReader					_packet_reader			{ Blob { kPacketDelimiter }, [this] (BlobView const packet) { return parse_packet (packet); } };
 	std::string							_output_buffer;
 	std::string							_last_at_command;
 	xf::Smoother<si::Power>				_rssi_smoother			{ 200_ms };
@@ -16,7 +16,6 @@
 
 // Xefis:
 #include <xefis/config/all.h>
-#include <xefis/support/universe/earth/magnetic_variation.h>
 #include <xefis/support/universe/earth/utility.h>
 
 // Neutrino:
@@ -25,9 +24,9 @@
 
 // Qt:
 #include <QtCore/QDate>
-#include <QtCore/QDateTime>
 
 // Standard:
+#include <cmath>
 #include <cstddef>
 
 
@@ -165,17 +164,20 @@ NavigationComputer::compute_magnetic_variation()
 {
 	if (_io.position_longitude && _io.position_latitude)
 	{
-		xf::MagneticVariation mv;
-		mv.set_position (si::LonLat (*_io.position_longitude, *_io.position_latitude));
-		if (_io.position_altitude_amsl)
-			mv.set_altitude_amsl (*_io.position_altitude_amsl);
-		else
-			mv.set_altitude_amsl (0_ft);
-		QDate today = QDateTime::fromSecsSinceEpoch (nu::utc_now().in<si::Second>()).date();
-		mv.set_date (today.year(), today.month(), today.day());
-		mv.update();
-		_io.magnetic_declination = mv.magnetic_declination();
-		_io.magnetic_inclination = mv.magnetic_inclination();
+		// Days since Unix epoch; calendar date is needed only when it changes:
+		auto const day = static_cast<int64_t> (std::floor (nu::utc_now().in<si::Second>() / 86'400.0));
+
+		if (day != _magnetic_variation_day)
+		{
+			QDate const today = QDate (1970, 1, 1).addDays (day);
+			_magnetic_variation.set_date (today.year(), today.month(), today.day());
+			_magnetic_variation_day = day;
+		}
+
+		auto const position = si::LonLat (*_io.position_longitude, *_io.position_latitude);
+		auto const result = _magnetic_variation.compute (position, _io.position_altitude_amsl.value_or (0_ft));
+		_io.magnetic_declination = result.magnetic_declination;
+		_io.magnetic_inclination = result.magnetic_inclination;
 	}
 	else
 	{
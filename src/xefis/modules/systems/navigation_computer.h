@@ -19,6 +19,7 @@
 #include <xefis/core/module.h>
 #include <xefis/core/sockets/module_socket.h>
 #include <xefis/support/sockets/socket_observer.h>
+#include <xefis/support/universe/earth/magnetic_variation_grid.h>
 #include <xefis/utility/smoother.h>
 #include <xefis/utility/range_smoother.h>
 
@@ -27,6 +28,8 @@
 
 // Standard:
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 
 
 namespace nu = neutrino;
@@ -134,6 +137,8 @@ class NavigationComputer: public NavigationComputerIO
 	xf::Smoother<si::AngularVelocity>	_track_lateral_rotation_smoother		{ 1500_ms };
 	xf::Smoother<si::Velocity>			_track_ground_speed_smoother			{ 2_s };
 	si::Time							_track_accumulated_dt					{ 0_s };
+	xf::MagneticVariationGrid			_magnetic_variation;
+	std::optional<int64_t>				_magnetic_variation_day;
 	xf::SocketObserver					_position_computer;
 	xf::SocketObserver					_magnetic_variation_computer;
 	xf::SocketObserver					_headings_computer;
@@ -21,8 +21,15 @@
 // Neutrino:
 #include <neutrino/numeric.h>
 
+// System:
+#if defined(__x86_64__) || defined(__i386__)
+#define XEFIS_ATMOSPHERIC_SCATTERING_AVX2 1
+#include <immintrin.h>
+#endif
+
 // Standard:
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cmath>
 #include <limits>
@@ -30,6 +37,106 @@
 
 
 namespace xf {
+namespace {
+
+// Precomputed values that correspond to the scattering coefficients of the sky at sea level, for wavelengths 680, 550 and 440 respectively:
+constexpr SpaceVector<double, RGBSpace> kRayleighBeta	= { 5.802e-6f, 13.558e-6f, 33.1e-6f };
+// Mie scattering doesn't change the color, so the coefficients are the same:
+constexpr SpaceVector<double, RGBSpace> kMieBeta		= { 21e-6f, 21e-6f, 21e-6f };
+
+using Lanes = std::array<double, AtmosphericScattering::kPacketSize>;
+
+
+#if defined(XEFIS_ATMOSPHERIC_SCATTERING_AVX2)
+
+/**
+ * Vectorized exp(). Range reduction to |r| ≤ ln(2)/2 and a degree-11 Taylor polynomial,
+ * accurate to a few ULPs for inputs in range [-708, 708].
+ * Compiled for AVX2 regardless of build flags; only call it if has_avx2() returns true.
+ */
+[[nodiscard]]
+__attribute__ ((target ("avx2")))
+inline __m256d
+exp_avx2 (__m256d x)
+{
+	static constexpr double kCoefficients[] = {
+		1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0, 1.0 / 720.0,
+		1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 1.0 / 2.0, 1.0, 1.0,
+	};
+
+	x = _mm256_max_pd (_mm256_min_pd (x, _mm256_set1_pd (708.0)), _mm256_set1_pd (-708.0));
+
+	auto const n = _mm256_round_pd (_mm256_mul_pd (x, _mm256_set1_pd (std::numbers::log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	// ln(2) split into high and low parts for exact reduction:
+	auto r = _mm256_sub_pd (x, _mm256_mul_pd (n, _mm256_set1_pd (6.93147180369123816490e-01)));
+	r = _mm256_sub_pd (r, _mm256_mul_pd (n, _mm256_set1_pd (1.90821492927058770002e-10)));
+
+	auto p = _mm256_set1_pd (kCoefficients[0]);
+
+	for (std::size_t i = 1; i < std::size (kCoefficients); ++i)
+		p = _mm256_add_pd (_mm256_mul_pd (p, r), _mm256_set1_pd (kCoefficients[i]));
+
+	// Compute 2^n by putting n + 1023 into the exponent bits. Adding 2^52 + 2^51 moves
+	// the integer value of n into the low bits of the mantissa:
+	auto const n_bits = _mm256_castpd_si256 (_mm256_add_pd (n, _mm256_set1_pd (6755399441055744.0)));
+	auto const two_to_n = _mm256_castsi256_pd (_mm256_slli_epi64 (_mm256_add_epi64 (n_bits, _mm256_set1_epi64x (1023)), 52));
+
+	return _mm256_mul_pd (p, two_to_n);
+}
+
+
+__attribute__ ((target ("avx2")))
+void
+exp_lanes_avx2 (Lanes const& x, Lanes& result)
+{
+	static_assert (AtmosphericScattering::kPacketSize == 4);
+	_mm256_storeu_pd (result.data(), exp_avx2 (_mm256_loadu_pd (x.data())));
+}
+
+
+/**
+ * Return true if the CPU supports AVX2. Checked once at first use.
+ */
+[[nodiscard]]
+bool
+has_avx2()
+{
+	static bool const supported = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports ("avx2") != 0;
+	}();
+
+	return supported;
+}
+
+#endif
+
+
+/**
+ * Compute exp() for all lanes.
+ */
+[[nodiscard]]
+Lanes
+exp_lanes (Lanes const& x)
+{
+	Lanes result;
+
+#if defined(XEFIS_ATMOSPHERIC_SCATTERING_AVX2)
+	if (has_avx2())
+	{
+		exp_lanes_avx2 (x, result);
+		return result;
+	}
+#endif
+
+	for (std::size_t lane = 0; lane < x.size(); ++lane)
+		result[lane] = nu::fast_exp (x[lane]);
+
+	return result;
+}
+
+} // namespace
+
 
 AtmosphericScattering::AtmosphericScattering (Parameters const& parameters):
 	_p (parameters)
@@ -190,11 +297,6 @@ AtmosphericScattering::compute_incident_light (SpaceLength<> const& observer_pos
 											   si::Length min_distance,
 											   si::Length max_distance) const
 {
-	// Precomputed values that correspond to the scattering coefficients of the sky at sea level, for wavelengths 680, 550 and 440 respectively:
-	static constexpr SpaceVector<double, RGBSpace> kRayleighBeta	= { 5.802e-6f, 13.558e-6f, 33.1e-6f };
-	// Mie scattering doesn't change the color, so the coefficients are the same:
-	static constexpr SpaceVector<double, RGBSpace> kMieBeta			= { 21e-6f, 21e-6f, 21e-6f };
-
 	auto intersections = ray_sphere_intersections (observer_position, ray_direction, _p.atmosphere_radius);
 
 	if (!intersections || intersections->second < 0_m)
@@ -217,13 +319,7 @@ AtmosphericScattering::compute_incident_light (SpaceLength<> const& observer_pos
 	si::Length sky_current_distance = min_distance;
 
 	// Compute phase functions (scattering intensity based on angle between sun and view direction):
-	auto const g = 0.76; // Mie asymmetry factor (approximates forward scattering).
-	auto const gg = nu::square (g);
-	auto const mu = dot_product (ray_direction, sun_direction); // Cosine of the angle between the sun direction and the ray direction.
-	auto const phase = RayleighMie<double> {
-		.r = 3.0 / (16.0 * std::numbers::pi) * (1.0 + mu * mu),
-		.m = 3.0 / (8.0 * std::numbers::pi) * ((1.0 - gg) * (1.0 + mu * mu)) / ((2.0 + gg) * std::pow (1.0 + gg - 2.0 * g * mu, 1.5)),
-	};
+	auto const phase = compute_phase (dot_product (ray_direction, sun_direction));
 
 	// Accumulate contributions from Rayleigh and Mie scattering:
 	auto contribution = RayleighMie<SpaceVector<double, RGBSpace>> { math::zero, math::zero };
@@ -265,6 +361,167 @@ AtmosphericScattering::compute_incident_light (SpaceLength<> const& observer_pos
 		sky_current_distance += sky_segment_length;
 	}
 
+	return compute_color (contribution, phase);
+}
+
+
+void
+AtmosphericScattering::compute_incident_light (SpaceLength<> const& observer_position,
+											   std::span<SpaceVector<double> const> ray_directions,
+											   SpaceVector<double> const& sun_direction,
+											   std::span<si::Length const> max_distances,
+											   std::span<SpaceVector<float, RGBSpace>> result) const
+{
+	for (std::size_t begin = 0; begin < ray_directions.size(); begin += kPacketSize)
+	{
+		auto const count = std::min (kPacketSize, ray_directions.size() - begin);
+
+		compute_incident_light_packet (observer_position,
+									   ray_directions.subspan (begin, count),
+									   sun_direction,
+									   max_distances.empty() ? max_distances : max_distances.subspan (begin, count),
+									   result.subspan (begin, count));
+	}
+}
+
+
+void
+AtmosphericScattering::compute_incident_light_packet (SpaceLength<> const& observer_position,
+													  std::span<SpaceVector<double> const> ray_directions,
+													  SpaceVector<double> const& sun_direction,
+													  std::span<si::Length const> max_distances,
+													  std::span<SpaceVector<float, RGBSpace>> result) const
+{
+	// Everything here is computed on raw doubles (meters) in structure-of-arrays layout,
+	// so that lane loops can be vectorized. Inactive lanes (rays missing the atmosphere
+	// or padding of the last packet) have zero segment length and contribute nothing.
+	auto const earth_radius = _p.earth_radius.in<si::Meter>();
+	auto const inv_rayleigh_threshold = _inv_rayleigh_threshold * 1_m;
+	auto const inv_mie_threshold = _inv_mie_threshold * 1_m;
+	auto const origin = observer_position / 1_m;
+	auto const num_samples = _p.num_viewing_direction_samples;
+
+	std::array<bool, kPacketSize> active {};
+	std::array<RayleighMie<double>, kPacketSize> phase {};
+	Lanes dx {}, dy {}, dz {}, start {}, segment {};
+
+	for (std::size_t lane = 0; lane < ray_directions.size(); ++lane)
+	{
+		auto const& ray_direction = ray_directions[lane];
+		auto const intersections = ray_sphere_intersections (observer_position, ray_direction, _p.atmosphere_radius);
+
+		if (!intersections || intersections->second < 0_m)
+			continue;
+
+		auto const [near, far] = *intersections;
+		auto const min_distance = near > 0_m ? near : 0_m;
+		auto const max_distance = max_distances.empty() ? far : std::min (far, max_distances[lane]);
+
+		active[lane] = true;
+		phase[lane] = compute_phase (dot_product (ray_direction, sun_direction));
+		dx[lane] = ray_direction[0];
+		dy[lane] = ray_direction[1];
+		dz[lane] = ray_direction[2];
+		start[lane] = min_distance.in<si::Meter>();
+		segment[lane] = (max_distance - min_distance).in<si::Meter>() / num_samples;
+	}
+
+	Lanes optical_depth_r {}, optical_depth_m {};
+	std::array<Lanes, 3> contribution_r {}, contribution_m {};
+
+	for (uint32_t i = 0; i < num_samples; ++i)
+	{
+		Lanes height, light_mu, neg_height_r, neg_height_m;
+
+		for (std::size_t lane = 0; lane < kPacketSize; ++lane)
+		{
+			auto const t = start[lane] + (i + 0.5) * segment[lane];
+			auto const x = origin[0] + t * dx[lane];
+			auto const y = origin[1] + t * dy[lane];
+			auto const z = origin[2] + t * dz[lane];
+			auto const radius = std::sqrt (x * x + y * y + z * z);
+
+			height[lane] = radius - earth_radius;
+			light_mu[lane] = (x * sun_direction[0] + y * sun_direction[1] + z * sun_direction[2]) / radius;
+			neg_height_r[lane] = -height[lane] * inv_rayleigh_threshold;
+			neg_height_m[lane] = -height[lane] * inv_mie_threshold;
+		}
+
+		auto const density_r = exp_lanes (neg_height_r);
+		auto const density_m = exp_lanes (neg_height_m);
+		Lanes hr {}, hm {}, tau_base_r {}, tau_base_m {};
+		std::array<bool, kPacketSize> lit {};
+
+		for (std::size_t lane = 0; lane < kPacketSize; ++lane)
+		{
+			if (!active[lane] || height[lane] < 0.0)
+				continue;
+
+			hr[lane] = density_r[lane] * segment[lane];
+			hm[lane] = density_m[lane] * segment[lane];
+			optical_depth_r[lane] += hr[lane];
+			optical_depth_m[lane] += hm[lane];
+
+			if (auto const light_optical_depth = sample_transmittance_lut (1_m * height[lane], light_mu[lane]))
+			{
+				lit[lane] = true;
+				tau_base_r[lane] = optical_depth_r[lane] + light_optical_depth->r.in<si::Meter>();
+				tau_base_m[lane] = 1.1f * (optical_depth_m[lane] + light_optical_depth->m.in<si::Meter>());
+			}
+		}
+
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			Lanes neg_tau;
+
+			for (std::size_t lane = 0; lane < kPacketSize; ++lane)
+				neg_tau[lane] = -(kRayleighBeta[channel] * tau_base_r[lane] + kMieBeta[channel] * tau_base_m[lane]);
+
+			auto const attenuation = exp_lanes (neg_tau);
+
+			for (std::size_t lane = 0; lane < kPacketSize; ++lane)
+			{
+				if (lit[lane])
+				{
+					contribution_r[channel][lane] += attenuation[lane] * hr[lane];
+					contribution_m[channel][lane] += attenuation[lane] * hm[lane];
+				}
+			}
+		}
+	}
+
+	for (std::size_t lane = 0; lane < result.size(); ++lane)
+	{
+		if (active[lane])
+		{
+			auto const contribution = RayleighMie<SpaceVector<double, RGBSpace>> {
+				{ contribution_r[0][lane], contribution_r[1][lane], contribution_r[2][lane] },
+				{ contribution_m[0][lane], contribution_m[1][lane], contribution_m[2][lane] },
+			};
+			result[lane] = compute_color (contribution, phase[lane]);
+		}
+		else
+			result[lane] = math::zero;
+	}
+}
+
+
+AtmosphericScattering::RayleighMie<double>
+AtmosphericScattering::compute_phase (double const mu)
+{
+	auto const g = 0.76; // Mie asymmetry factor (approximates forward scattering).
+	auto const gg = nu::square (g);
+
+	return {
+		.r = 3.0 / (16.0 * std::numbers::pi) * (1.0 + mu * mu),
+		.m = 3.0 / (8.0 * std::numbers::pi) * ((1.0 - gg) * (1.0 + mu * mu)) / ((2.0 + gg) * std::pow (1.0 + gg - 2.0 * g * mu, 1.5)),
+	};
+}
+
+
+SpaceVector<float, RGBSpace>
+AtmosphericScattering::compute_color (RayleighMie<SpaceVector<double, RGBSpace>> const& contribution, RayleighMie<double> const& phase) const
+{
 	auto const rayleigh_result = _p.rayleigh_factor * hadamard_product (contribution.r, kRayleighBeta) * phase.r;
 	auto const mie_result = _p.mie_factor * hadamard_product (contribution.m, kMieBeta) * phase.m;
 	auto const color_double = kIncidentLightScale * (rayleigh_result + mie_result);
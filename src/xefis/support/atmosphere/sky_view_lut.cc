@@ -0,0 +1,164 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "sky_view_lut.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/numeric.h>
+
+// Standard:
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <vector>
+
+
+namespace xf {
+
+SkyViewLUT::SkyViewLUT (AtmosphericScattering const& atmospheric_scattering, Parameters const& parameters):
+	_atmospheric_scattering (atmospheric_scattering),
+	_p (parameters),
+	_zenith_samples (std::max<std::size_t> (_p.zenith_samples, 2)),
+	_azimuth_samples (std::max<std::size_t> (_p.azimuth_samples, 2))
+{ }
+
+
+bool
+SkyViewLUT::update (si::Length const observer_radius, SpaceVector<double> const& sun_direction, nu::WorkPerformer* const work_performer)
+{
+	auto const earth_radius = _atmospheric_scattering.parameters().earth_radius;
+	auto const sun_elevation = 1_rad * std::asin (std::clamp (sun_direction[2], -1.0, 1.0));
+	auto const bucket = std::pair<int64_t, int64_t> {
+		std::llround (sun_elevation / _p.sun_elevation_bucket),
+		std::llround ((observer_radius - earth_radius) / _p.altitude_bucket),
+	};
+
+	if (_bucket == bucket)
+		return false;
+
+	_bucket = bucket;
+	_observer_position = { 0_m, 0_m, observer_radius };
+	_horizon_zenith = observer_radius > earth_radius
+		? 90_deg + 1_rad * std::acos (earth_radius / observer_radius)
+		: 90_deg;
+	_colors.resize (_zenith_samples * _azimuth_samples);
+
+	// In the LUT the sun is always at azimuth 0:
+	auto const lut_sun_direction = SpaceVector<double> { cos (sun_elevation), 0.0, sin (sun_elevation) };
+
+	if (work_performer)
+	{
+		std::vector<std::future<void>> rows;
+		rows.reserve (_zenith_samples);
+
+		for (std::size_t z = 0; z < _zenith_samples; ++z)
+			rows.push_back (work_performer->submit ([this, z, lut_sun_direction] { compute_row (z, lut_sun_direction); }));
+
+		for (auto& row: rows)
+			row.get();
+	}
+	else
+	{
+		for (std::size_t z = 0; z < _zenith_samples; ++z)
+			compute_row (z, lut_sun_direction);
+	}
+
+	_sun_light = _atmospheric_scattering.compute_incident_light (_observer_position, sun_direction, sun_direction);
+
+	return true;
+}
+
+
+SpaceVector<float, RGBSpace>
+SkyViewLUT::incident_light (SpaceVector<double> const& ray_direction, SpaceVector<double> const& sun_direction) const
+{
+	if (!ready())
+		return math::zero;
+
+	auto const zenith = 1_rad * std::acos (std::clamp (ray_direction[2], -1.0, 1.0));
+	// Angle between horizontal projections of the ray and the sun direction, 0…π:
+	auto const cross_z = ray_direction[0] * sun_direction[1] - ray_direction[1] * sun_direction[0];
+	auto const dot_xy = ray_direction[0] * sun_direction[0] + ray_direction[1] * sun_direction[1];
+	auto const azimuth = std::atan2 (std::abs (cross_z), dot_xy);
+
+	auto const z_coord = coordinate_for_zenith (zenith) * (_zenith_samples - 1);
+	auto const a_coord = std::sqrt (std::clamp (azimuth / std::numbers::pi, 0.0, 1.0)) * (_azimuth_samples - 1);
+	auto const z0 = std::min (static_cast<std::size_t> (z_coord), _zenith_samples - 2);
+	auto const a0 = std::min (static_cast<std::size_t> (a_coord), _azimuth_samples - 2);
+	auto const z_t = static_cast<float> (z_coord - z0);
+	auto const a_t = static_cast<float> (a_coord - a0);
+
+	auto const top = (1.0f - a_t) * _colors[index (z0, a0)] + a_t * _colors[index (z0, a0 + 1)];
+	auto const bottom = (1.0f - a_t) * _colors[index (z0 + 1, a0)] + a_t * _colors[index (z0 + 1, a0 + 1)];
+
+	return (1.0f - z_t) * top + z_t * bottom;
+}
+
+
+si::Angle
+SkyViewLUT::zenith_for_coordinate (double const coordinate) const
+{
+	if (coordinate < 0.5)
+		return _horizon_zenith * (1.0 - nu::square (1.0 - 2.0 * coordinate));
+	else
+		return _horizon_zenith + (180_deg - _horizon_zenith) * nu::square (2.0 * coordinate - 1.0);
+}
+
+
+double
+SkyViewLUT::coordinate_for_zenith (si::Angle const zenith) const
+{
+	if (zenith < _horizon_zenith)
+		return 0.5 * (1.0 - std::sqrt (std::max (0.0, 1.0 - zenith / _horizon_zenith)));
+	else
+		return 0.5 * (1.0 + std::sqrt (std::clamp ((zenith - _horizon_zenith) / (180_deg - _horizon_zenith), 0.0, 1.0)));
+}
+
+
+void
+SkyViewLUT::compute_row (std::size_t const zenith_index, SpaceVector<double> const& sun_direction)
+{
+	auto const earth_radius = _atmospheric_scattering.parameters().earth_radius;
+	auto const zenith = zenith_for_coordinate (static_cast<double> (zenith_index) / (_zenith_samples - 1));
+	auto ray_directions = std::vector<SpaceVector<double>>();
+	auto max_distances = std::vector<si::Length>();
+
+	ray_directions.reserve (_azimuth_samples);
+	max_distances.reserve (_azimuth_samples);
+
+	for (std::size_t a = 0; a < _azimuth_samples; ++a)
+	{
+		auto const azimuth = 1_rad * std::numbers::pi * nu::square (static_cast<double> (a) / (_azimuth_samples - 1));
+		auto const& ray_direction = ray_directions.emplace_back (sin (zenith) * cos (azimuth), sin (zenith) * sin (azimuth), cos (zenith));
+		auto& max_distance = max_distances.emplace_back (std::numeric_limits<si::Length>::infinity());
+
+		// Rays going towards the ground end on the ground:
+		if (auto const intersections = _atmospheric_scattering.ray_sphere_intersections (_observer_position, ray_direction, earth_radius))
+			if (intersections->second > 0_m)
+				max_distance = std::max (0_m, intersections->first);
+	}
+
+	// The whole row is integrated in SIMD packets:
+	auto const row = std::span (_colors).subspan (index (zenith_index, 0), _azimuth_samples);
+	_atmospheric_scattering.compute_incident_light (_observer_position, ray_directions, sun_direction, max_distances, row);
+}
+
+} // namespace xf
@@ -0,0 +1,150 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__ATMOSPHERE__SKY_VIEW_LUT_H__INCLUDED
+#define XEFIS__SUPPORT__ATMOSPHERE__SKY_VIEW_LUT_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/atmosphere/atmospheric_scattering.h>
+#include <xefis/support/color/spaces.h>
+#include <xefis/support/math/geometry_types.h>
+
+// Neutrino:
+#include <neutrino/work_performer.h>
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+namespace xf {
+
+/**
+ * Sky-view lookup table: incident light for all view directions from a single observer position,
+ * parametrized by view zenith angle and view azimuth relative to the sun.
+ * Ray marching happens only when the table is rebuilt, that is when the sun elevation or observer altitude
+ * moves to another bucket. Sampling is a bilinear interpolation, so it's cheap enough to be used per vertex
+ * every frame.
+ *
+ * All directions are in the observer's horizontal coordinates with Z axis pointing up,
+ * as in compute_cartesian_horizontal_coordinates().
+ */
+class SkyViewLUT
+{
+  public:
+	struct Parameters
+	{
+		// Number of view zenith angle samples; they're denser around the horizon:
+		uint32_t	zenith_samples			{ 128 };
+		// Number of azimuth samples, 0°…180° relative to the sun (the sky is symmetric); they're denser around the sun:
+		uint32_t	azimuth_samples			{ 64 };
+		// Size of sun elevation bucket; the LUT is rebuilt when the sun moves to another bucket:
+		si::Angle	sun_elevation_bucket	{ 0.1_deg };
+		// Size of observer altitude bucket; the LUT is rebuilt when the observer moves to another bucket:
+		si::Length	altitude_bucket			{ 100_m };
+	};
+
+  public:
+	// Ctor
+	explicit
+	SkyViewLUT (AtmosphericScattering const&, Parameters const&);
+
+	/**
+	 * Rebuild the LUT if the sun elevation or observer altitude changed bucket since the last rebuild.
+	 *
+	 * \param	observer_radius
+	 *			Distance of the observer from the planet center.
+	 * \param	sun_direction
+	 *			Normalized direction towards the sun.
+	 * \param	work_performer
+	 *			If not nullptr, rows of the LUT are computed in parallel on the work performer.
+	 *			Function waits for the computation to finish anyway.
+	 * \return	true if the LUT was rebuilt.
+	 */
+	bool
+	update (si::Length observer_radius, SpaceVector<double> const& sun_direction, nu::WorkPerformer* work_performer = nullptr);
+
+	/**
+	 * Return true if the LUT has been built at least once.
+	 */
+	[[nodiscard]]
+	bool
+	ready() const noexcept
+		{ return !_colors.empty(); }
+
+	/**
+	 * Return incident light coming from given direction. It's an approximation of
+	 * AtmosphericScattering::compute_incident_light() called for observer at { 0, 0, observer_radius }
+	 * with the ray limited by the ground.
+	 *
+	 * \param	ray_direction
+	 *			Normalized view direction.
+	 * \param	sun_direction
+	 *			Normalized direction towards the sun; only its azimuth is used, elevation is the one the LUT was built for.
+	 */
+	[[nodiscard]]
+	SpaceVector<float, RGBSpace>
+	incident_light (SpaceVector<double> const& ray_direction, SpaceVector<double> const& sun_direction) const;
+
+	/**
+	 * Return light coming directly from the sun. Computed exactly when the LUT is rebuilt,
+	 * since the Mie peak around the sun is too narrow to be interpolated.
+	 */
+	[[nodiscard]]
+	SpaceVector<float, RGBSpace> const&
+	sun_light() const noexcept
+		{ return _sun_light; }
+
+  private:
+	/**
+	 * Map normalized LUT coordinate to view zenith angle and back.
+	 * The mapping is non-linear to put more samples around the horizon.
+	 */
+	[[nodiscard]]
+	si::Angle
+	zenith_for_coordinate (double coordinate) const;
+
+	[[nodiscard]]
+	double
+	coordinate_for_zenith (si::Angle zenith) const;
+
+	/**
+	 * Compute one row of the LUT (all azimuths for given zenith index).
+	 */
+	void
+	compute_row (std::size_t zenith_index, SpaceVector<double> const& sun_direction);
+
+	[[nodiscard]]
+	std::size_t
+	index (std::size_t zenith_index, std::size_t azimuth_index) const noexcept
+		{ return zenith_index * _azimuth_samples + azimuth_index; }
+
+  private:
+	AtmosphericScattering const&				_atmospheric_scattering;
+	Parameters									_p;
+	std::size_t									_zenith_samples;
+	std::size_t									_azimuth_samples;
+	std::optional<std::pair<int64_t, int64_t>>	_bucket;
+	SpaceLength<>								_observer_position;
+	si::Angle									_horizon_zenith		{ 90_deg };
+	std::vector<SpaceVector<float, RGBSpace>>	_colors;
+	SpaceVector<float, RGBSpace>				_sun_light			{ math::zero };
+};
+
+} // namespace xf
+
+#endif
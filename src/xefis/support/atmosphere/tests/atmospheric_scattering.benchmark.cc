@@ -0,0 +1,75 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/atmosphere/atmospheric_scattering.h>
+#include <xefis/support/atmosphere/sky_view_lut.h>
+#include <xefis/support/math/geometry.h>
+#include <xefis/test/benchmark.h>
+
+// Standard:
+#include <cstddef>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+AtmosphericScattering const kScattering ({
+	.earth_radius = kEarthMeanRadius,
+	.atmosphere_radius = kEarthMeanRadius + 50_km,
+	.enable_tonemapping = true,
+});
+
+
+xf::Benchmark b1 ("AtmosphericScattering: single rays vs batch", [] (xf::Benchmark& benchmark) {
+	auto const observer_position = SpaceLength<> (0_m, 0_m, kEarthMeanRadius + 1_km);
+	auto const sun_direction = to_cartesian<void> (si::LonLat (0_deg, 5_deg));
+	auto ray_directions = std::vector<SpaceVector<double>>();
+
+	// Roughly as many rays as vertices of the sky dome:
+	for (auto altitude = -10_deg; altitude <= 90_deg; altitude += 2_deg)
+		for (auto azimuth = 0_deg; azimuth < 360_deg; azimuth += 5_deg)
+			ray_directions.push_back (to_cartesian<void> (si::LonLat (azimuth, altitude)));
+
+	auto colors = std::vector<SpaceVector<float, RGBSpace>> (ray_directions.size());
+
+	benchmark.measure ("single rays", 20, [&] {
+		for (std::size_t i = 0; i < ray_directions.size(); ++i)
+			colors[i] = kScattering.compute_incident_light (observer_position, ray_directions[i], sun_direction);
+	});
+
+	benchmark.measure ("batch", 20, [&] {
+		kScattering.compute_incident_light (observer_position, ray_directions, sun_direction, {}, colors);
+	});
+
+	xf::Benchmark::keep (colors);
+});
+
+
+xf::Benchmark b2 ("SkyViewLUT: rebuild", [] (xf::Benchmark& benchmark) {
+	auto lut = SkyViewLUT (kScattering, {});
+	auto altitude = 0_m;
+
+	benchmark.measure ("single thread", 10, [&] {
+		// Move to another altitude bucket each time to force the rebuild:
+		altitude += 1_km;
+		lut.update (kEarthMeanRadius + altitude, to_cartesian<void> (si::LonLat (0_deg, 5_deg)));
+	});
+
+	xf::Benchmark::keep (lut);
+});
+
+} // namespace
+} // namespace xf::test
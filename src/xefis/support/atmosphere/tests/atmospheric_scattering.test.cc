@@ -0,0 +1,91 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/atmosphere/atmospheric_scattering.h>
+#include <xefis/support/math/geometry.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+
+void
+verify_batch_matches_single_rays (std::string const& label, AtmosphericScattering const& scattering, si::Length const observer_height, si::Angle const sun_altitude)
+{
+	auto const observer_position = SpaceLength<> (0_m, 0_m, kEarthMeanRadius + observer_height);
+	auto const sun_direction = to_cartesian<void> (si::LonLat (0_deg, sun_altitude));
+	auto ray_directions = std::vector<SpaceVector<double>>();
+	auto max_distances = std::vector<si::Length>();
+
+	// Odd number of rays to also test the partially filled last packet:
+	for (auto altitude = -30_deg; altitude <= 90_deg; altitude += 7_deg)
+	{
+		for (auto azimuth = 0_deg; azimuth < 360_deg; azimuth += 25_deg)
+		{
+			auto const& ray_direction = ray_directions.emplace_back (to_cartesian<void> (si::LonLat (azimuth, altitude)));
+			auto& max_distance = max_distances.emplace_back (std::numeric_limits<si::Length>::infinity());
+
+			if (auto const intersections = AtmosphericScattering::ray_sphere_intersections (observer_position, ray_direction, kEarthMeanRadius))
+				if (intersections->second > 0_m)
+					max_distance = std::max (0_m, intersections->first);
+		}
+	}
+
+	auto batch = std::vector<SpaceVector<float, RGBSpace>> (ray_directions.size());
+	scattering.compute_incident_light (observer_position, ray_directions, sun_direction, max_distances, batch);
+
+	for (std::size_t i = 0; i < ray_directions.size(); ++i)
+	{
+		auto const single = scattering.compute_incident_light (observer_position, ray_directions[i], sun_direction, 0_m, max_distances[i]);
+
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			// The SIMD path may use a different exp() implementation than the scalar one:
+			auto const tolerance = 1e-4f + 0.02f * std::abs (single[channel]);
+
+			test_asserts::verify (label + ": ray " + std::to_string (i) + " channel " + std::to_string (channel) + " matches",
+								  std::abs (batch[i][channel] - single[channel]) <= tolerance);
+		}
+	}
+}
+
+
+nu::AutoTest t1 ("AtmosphericScattering: batch compute_incident_light() matches single rays", []{
+	auto const scattering = AtmosphericScattering ({
+		.earth_radius = kEarthMeanRadius,
+		.atmosphere_radius = kEarthMeanRadius + 50_km,
+		.enable_tonemapping = true,
+	});
+
+	verify_batch_matches_single_rays ("noon at ground level", scattering, 0_m, 60_deg);
+	verify_batch_matches_single_rays ("sunset at 10 km", scattering, 10_km, 1_deg);
+	verify_batch_matches_single_rays ("night in space", scattering, 100_km, -20_deg);
+});
+
+} // namespace
+} // namespace xf::test
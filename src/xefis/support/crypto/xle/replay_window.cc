@@ -0,0 +1,76 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "replay_window.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+
+
+namespace xf::crypto::xle {
+
+ReplayWindow::ReplayWindow (size_t const size):
+	_size (size),
+	// One spare block, so that the block containing the highest number can be partially filled
+	// while the oldest tracked block is still intact:
+	_blocks ((size + kBlockBits - 1) / kBlockBits + 1, 0)
+{
+	// Sequence number 0 is never sent, mark it as seen:
+	_blocks[block_index (0)] |= bit_mask (0);
+}
+
+
+ReplayWindow::Result
+ReplayWindow::check (SequenceNumber const sequence_number) const noexcept
+{
+	if (sequence_number > _highest)
+		return Result::Fresh;
+
+	if (_highest - sequence_number >= _size)
+		return Result::TooOld;
+
+	if (_blocks[block_index (sequence_number)] & bit_mask (sequence_number))
+		return Result::Duplicate;
+
+	return Result::Fresh;
+}
+
+
+void
+ReplayWindow::accept (SequenceNumber const sequence_number) noexcept
+{
+	if (sequence_number > _highest)
+	{
+		auto const current_block = _highest / kBlockBits;
+		auto const new_block = sequence_number / kBlockBits;
+
+		// Blocks entered for the first time must be cleared, since they still contain bits
+		// of sequence numbers one full ring earlier:
+		if (new_block - current_block >= _blocks.size())
+			std::fill (_blocks.begin(), _blocks.end(), 0);
+		else
+			for (auto block = current_block + 1; block <= new_block; ++block)
+				_blocks[block % _blocks.size()] = 0;
+
+		_highest = sequence_number;
+	}
+
+	_blocks[block_index (sequence_number)] |= bit_mask (sequence_number);
+}
+
+} // namespace xf::crypto::xle
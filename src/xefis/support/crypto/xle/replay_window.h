@@ -0,0 +1,114 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__CRYPTO__XLE__REPLAY_WINDOW_H__INCLUDED
+#define XEFIS__SUPPORT__CRYPTO__XLE__REPLAY_WINDOW_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace xf::crypto::xle {
+
+/**
+ * Anti-replay sliding window as in RFC 4303, using the ring-of-blocks bitmap from RFC 6479
+ * so that advancing the window costs at most one word write per 64 sequence numbers.
+ *
+ * Accepts each sequence number at most once. Numbers greater than the highest one seen
+ * so far are always fresh; lower numbers are fresh only if they're within the window and
+ * haven't been seen yet. Sequence number 0 is never valid.
+ */
+class ReplayWindow
+{
+  public:
+	using SequenceNumber = uint64_t;
+
+	enum class Result
+	{
+		Fresh,
+		Duplicate,
+		TooOld,
+	};
+
+  private:
+	using Block = uint64_t;
+
+	static constexpr size_t kBlockBits = 8 * sizeof (Block);
+
+  public:
+	/**
+	 * Ctor
+	 *
+	 * \param	size
+	 *			Number of most recent sequence numbers (including the highest one) that are tracked.
+	 *			Zero means only strictly increasing sequence numbers are accepted.
+	 */
+	explicit
+	ReplayWindow (size_t size);
+
+	/**
+	 * Return window size.
+	 */
+	[[nodiscard]]
+	size_t
+	size() const noexcept
+		{ return _size; }
+
+	/**
+	 * Return highest sequence number accepted so far (0 if none).
+	 */
+	[[nodiscard]]
+	SequenceNumber
+	highest() const noexcept
+		{ return _highest; }
+
+	/**
+	 * Check whether given sequence number would be accepted. Doesn't modify the window,
+	 * so it can be called before the packet is authenticated.
+	 */
+	[[nodiscard]]
+	Result
+	check (SequenceNumber) const noexcept;
+
+	/**
+	 * Mark sequence number as seen, advancing the window if needed.
+	 * Must only be called for numbers for which check() returned Result::Fresh.
+	 */
+	void
+	accept (SequenceNumber) noexcept;
+
+  private:
+	[[nodiscard]]
+	size_t
+	block_index (SequenceNumber const sequence_number) const noexcept
+		{ return (sequence_number / kBlockBits) % _blocks.size(); }
+
+	[[nodiscard]]
+	static Block
+	bit_mask (SequenceNumber const sequence_number) noexcept
+		{ return Block (1) << (sequence_number % kBlockBits); }
+
+  private:
+	size_t				_size;
+	SequenceNumber		_highest	{ 0 };
+	std::vector<Block>	_blocks;
+};
+
+} // namespace xf::crypto::xle
+
+#endif
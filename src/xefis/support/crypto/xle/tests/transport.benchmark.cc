@@ -0,0 +1,66 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/support/crypto/xle/transport.h>
+#include <xefis/test/benchmark.h>
+
+// Standard:
+#include <cstddef>
+#include <format>
+#include <random>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+xf::Benchmark b1 ("Xefis Lossy Encryption/Transport: per-packet cost", [] (xf::Benchmark& benchmark) {
+	Blob const key = nu::to_blob ("abcdefghijklmnop");
+	constexpr size_t kIterations = 20'000;
+
+	auto rnd = std::random_device ("hw");
+
+	for (size_t const packet_size: { 16u, 64u, 256u, 1024u })
+	{
+		auto tx = crypto::xle::Transmitter (rnd, { .ephemeral_session_key = key });
+		auto rx = crypto::xle::Receiver ({ .ephemeral_session_key = key });
+		Blob const plain_text (packet_size, 0x55);
+		Blob encrypted (packet_size + tx.ciphertext_expansion(), 0);
+		Blob decrypted (encrypted.size(), 0);
+
+		benchmark.measure (std::format ("encrypt_packet (Blob), {} B", packet_size), kIterations, [&]{
+			xf::Benchmark::keep (tx.encrypt_packet (plain_text));
+		});
+
+		benchmark.measure (std::format ("encrypt_packet (in-place), {} B", packet_size), kIterations, [&]{
+			xf::Benchmark::keep (tx.encrypt_packet (plain_text, encrypted));
+		});
+
+		// Receiver requires increasing sequence numbers, so encrypt a fresh packet for each iteration
+		// outside of the measured region:
+		std::vector<Blob> packets (kIterations + kIterations / 10);
+
+		for (auto& packet: packets)
+			packet = tx.encrypt_packet (plain_text);
+
+		auto next_packet = packets.begin();
+
+		benchmark.measure (std::format ("decrypt_packet (in-place), {} B", packet_size), kIterations, [&]{
+			xf::Benchmark::keep (rx.decrypt_packet (*next_packet++, decrypted));
+		});
+	}
+});
+
+} // namespace
+} // namespace xf::test
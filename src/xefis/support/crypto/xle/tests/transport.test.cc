@@ -18,8 +18,12 @@
 #include <neutrino/test/auto_test.h>
 
 // Standard:
+#include <algorithm>
 #include <cstddef>
+#include <optional>
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 
 namespace xf::test {
@@ -50,5 +54,128 @@ nu::AutoTest t1 ("Xefis Lossy Encryption/Transport: encryption and decryption",
 	test_asserts::verify ("encryption expansion is declared properly (2)", encrypted.size() - plain_text.size() == tx.ciphertext_expansion());
 });
 
+
+nu::AutoTest t2 ("Xefis Lossy Encryption/Transport: in-place encryption and decryption", []{
+	Blob const key = nu::to_blob ("abcdefghijklmnop");
+
+	auto rnd = std::random_device ("hw");
+	auto tx = crypto::xle::Transmitter (rnd, { .ephemeral_session_key = key });
+	auto rx = crypto::xle::Receiver ({ .ephemeral_session_key = key });
+
+	Blob const plain_text = nu::to_blob ("some plain text that is longer than the AES block size");
+	Blob encrypted (plain_text.size() + tx.ciphertext_expansion(), 0);
+	Blob decrypted (encrypted.size(), 0);
+
+	auto const encrypted_size = tx.encrypt_packet (plain_text, encrypted);
+	test_asserts::verify ("in-place encryption fills whole packet", encrypted_size == encrypted.size());
+
+	auto decrypted_size = rx.decrypt_packet (encrypted, decrypted);
+	test_asserts::verify ("in-place decryption works", BlobView (decrypted).substr (0, decrypted_size) == plain_text);
+
+	// Interoperability with the allocating API:
+	encrypted = tx.encrypt_packet (plain_text);
+	decrypted_size = rx.decrypt_packet (encrypted, decrypted);
+	test_asserts::verify ("in-place decryption of allocated packet works", BlobView (decrypted).substr (0, decrypted_size) == plain_text);
+
+	// Replay must be rejected:
+	bool replay_rejected = false;
+
+	try {
+		rx.decrypt_packet (encrypted, decrypted);
+	}
+	catch (crypto::xle::Transport::DecryptionFailure const& failure)
+	{
+		replay_rejected = failure.error_code() == crypto::xle::Transport::SeqNumReplayed;
+	}
+
+	test_asserts::verify ("replayed packet is rejected", replay_rejected);
+
+	// Tampered packet must be rejected:
+	bool tampering_detected = false;
+	encrypted = tx.encrypt_packet (plain_text);
+	encrypted[sizeof (crypto::xle::Transport::SequenceNumber) + 1] ^= 0x01;
+
+	try {
+		rx.decrypt_packet (encrypted, decrypted);
+	}
+	catch (crypto::xle::Transport::DecryptionFailure const& failure)
+	{
+		tampering_detected = failure.error_code() == crypto::xle::Transport::InvalidAuthentication;
+	}
+
+	test_asserts::verify ("tampered packet is rejected", tampering_detected);
+
+	// Too small output buffer:
+	bool length_error_thrown = false;
+	Blob too_small (encrypted.size() - 1, 0);
+
+	try {
+		tx.encrypt_packet (plain_text, too_small);
+	}
+	catch (std::length_error const&)
+	{
+		length_error_thrown = true;
+	}
+
+	test_asserts::verify ("too small output buffer is detected", length_error_thrown);
+});
+
+
+nu::AutoTest t3 ("Xefis Lossy Encryption/Transport: reordered packets are accepted exactly once", []{
+	Blob const key = nu::to_blob ("abcdefghijklmnop");
+	constexpr size_t kReplayWindowSize = 32;
+
+	auto rnd = std::random_device ("hw");
+	auto tx = crypto::xle::Transmitter (rnd, { .ephemeral_session_key = key });
+	auto rx = crypto::xle::Receiver ({ .ephemeral_session_key = key, .replay_window_size = kReplayWindowSize });
+
+	Blob const plain_text = nu::to_blob ("telemetry");
+	std::vector<Blob> packets;
+
+	for (size_t i = 0; i < 200; ++i)
+		packets.push_back (tx.encrypt_packet (plain_text));
+
+	// Shuffle packets within blocks smaller than the window, which simulates a multipath link:
+	auto prng = std::mt19937 (1);
+
+	for (size_t block = 0; block < packets.size(); block += kReplayWindowSize / 2)
+		std::shuffle (packets.begin() + block, packets.begin() + std::min (block + kReplayWindowSize / 2, packets.size()), prng);
+
+	auto const try_decrypt = [&rx] (Blob const& packet) -> std::optional<crypto::xle::Transport::ErrorCode> {
+		try {
+			std::ignore = rx.decrypt_packet (packet);
+			return std::nullopt;
+		}
+		catch (crypto::xle::Transport::DecryptionFailure const& failure)
+		{
+			return failure.error_code();
+		}
+	};
+
+	size_t accepted = 0;
+
+	for (auto const& packet: packets)
+		if (!try_decrypt (packet))
+			++accepted;
+
+	test_asserts::verify ("all reordered packets are accepted", accepted == packets.size());
+
+	size_t replays_rejected = 0;
+
+	for (auto const& packet: packets)
+		if (auto const error = try_decrypt (packet); error == crypto::xle::Transport::SeqNumReplayed || error == crypto::xle::Transport::SeqNumFromPast)
+			++replays_rejected;
+
+	test_asserts::verify ("all replayed packets are rejected", replays_rejected == packets.size());
+
+	// Packet older than the window:
+	auto const old_packet = tx.encrypt_packet (plain_text);
+
+	for (size_t i = 0; i < kReplayWindowSize; ++i)
+		std::ignore = rx.decrypt_packet (tx.encrypt_packet (plain_text));
+
+	test_asserts::verify ("packet older than the window is rejected", try_decrypt (old_packet) == crypto::xle::Transport::SeqNumFromPast);
+});
+
 } // namespace
 } // namespace xf::test
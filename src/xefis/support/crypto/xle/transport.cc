@@ -18,15 +18,42 @@
 #include <xefis/config/all.h>
 
 // Neutrino:
-#include <neutrino/crypto/aes.h>
 #include <neutrino/crypto/hkdf.h>
 #include <neutrino/crypto/utility.h>
 
+// Lib:
+#include <boost/endian/conversion.hpp>
+#include <cryptopp/misc.h>
+
 // Standard:
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstring>
 
 
 namespace xf::crypto::xle {
+namespace {
+
+void
+store_sequence_number (Transport::SequenceNumber const sequence_number, std::span<uint8_t> const output)
+{
+	// Always little-endian on the wire:
+	auto const little_endian = boost::endian::native_to_little (sequence_number);
+	std::memcpy (output.data(), &little_endian, sizeof (little_endian));
+}
+
+
+Transport::SequenceNumber
+load_sequence_number (std::span<uint8_t const> const input)
+{
+	Transport::SequenceNumber little_endian;
+	std::memcpy (&little_endian, input.data(), sizeof (little_endian));
+	return boost::endian::little_to_native (little_endian);
+}
+
+} // namespace
+
 
 Transport::Transport (Params const& params):
 	_hmac_size (params.hmac_size)
@@ -51,6 +78,32 @@ Transport::Transport (Params const& params):
 		.info = params.hkdf_user_info + nu::to_blob ("seq_num_encryption_key"),
 		.result_length = 32,
 	});
+
+	// Expand keys once. Per-packet code only resynchronizes IVs:
+	std::array<uint8_t, CryptoPP::AES::BLOCKSIZE> const zero_iv {};
+	_hmac.SetKey (_hmac_key->data(), _hmac_key->size());
+	_data_cipher.SetKeyWithIV (_data_encryption_key->data(), _data_encryption_key->size(), zero_iv.data(), zero_iv.size());
+	_seq_num_cipher.SetKeyWithIV (_seq_num_encryption_key->data(), _seq_num_encryption_key->size(), zero_iv.data(), zero_iv.size());
+}
+
+
+void
+Transport::compute_nonce (BlobView const data, std::span<uint8_t, kNonceSize> const result)
+{
+	_nonce_hash.Update (data.data(), data.size());
+	// TruncatedFinal() also restarts the hash for the next use:
+	_nonce_hash.TruncatedFinal (result.data(), result.size());
+}
+
+
+void
+Transport::aes_ctr_xor_in_place (CTRCipher& cipher, std::span<uint8_t const, kNonceSize> const nonce, std::span<uint8_t> const data)
+{
+	// Nonce goes into the upper half of the IV, the lower half is the block counter:
+	std::array<uint8_t, CryptoPP::AES::BLOCKSIZE> iv {};
+	std::copy (nonce.begin(), nonce.end(), iv.begin());
+	cipher.Resynchronize (iv.data(), iv.size());
+	cipher.ProcessData (data.data(), data.data(), data.size());
 }
 
 
@@ -73,94 +126,143 @@ Transmitter::Transmitter (std::random_device& random_device, Params const& param
  *         hmac (_hmac_size B);
  *     };
  * };
+ *
+ * Nonce for the data is derived from the sequence number. Nonce for the sequence number
+ * is derived from the encrypted salt and HMAC, which are unique for each packet.
  */
 Blob
 Transmitter::encrypt_packet (BlobView const data)
 {
-	++_sequence_number;
+	Blob encrypted_packet (data.size() + ciphertext_expansion(), 0);
+	encrypt_packet (data, encrypted_packet);
+	return encrypted_packet;
+}
 
-	// It's required that to_blob() gives little-endian encoding:
-	auto const binary_sequence_number = nu::to_blob (_sequence_number);
-	auto const salt = nu::random_blob (kDataSaltSize, _random_device);
-	auto const full_hmac = nu::compute_hmac<kSignatureHMACHashAlgorithm> ({
-		.data = data + salt + binary_sequence_number,
-		.key = *_hmac_key,
-	});
 
-	if (full_hmac.size() < _hmac_size)
+size_t
+Transmitter::encrypt_packet (BlobView const data, std::span<uint8_t> const output)
+{
+	auto const packet_size = data.size() + ciphertext_expansion();
+
+	if (output.size() < packet_size)
+		throw std::length_error ("output buffer too small for the encrypted packet");
+
+	if (SignatureHMAC::DIGESTSIZE < _hmac_size)
 		throw std::logic_error ("HMAC size doesn't fit requirements");
 
-	auto const hmac = full_hmac.substr (0, _hmac_size);
-	auto const encrypted_data = nu::aes_ctr_xor ({
-		.data = data + salt + hmac,
-		.key = *_data_encryption_key,
-		.nonce = nu::compute_hash<kDataNonceHashAlgorithm> (binary_sequence_number).substr (0, 8),
-	});
-	auto const encrypted_sequence_number = nu::aes_ctr_xor ({
-		.data = binary_sequence_number,
-		.key = *_seq_num_encryption_key,
-		// Encrypted data must be at least 8 bytes, but longer is better for better entropy to avoid
-		// repeating nonce ever. That's why data salt is added before encryption.
-		.nonce = nu::compute_hash<kSeqNumNonceHashAlgorithm> (encrypted_data).substr (0, 8),
-	});
-	auto const encrypted_packet = encrypted_sequence_number + encrypted_data;
+	++_sequence_number;
 
-	return encrypted_packet;
+	auto const sequence_number_field = output.first (sizeof (SequenceNumber));
+	auto const encrypted_data = output.subspan (sizeof (SequenceNumber), packet_size - sizeof (SequenceNumber));
+	auto const salt_field = encrypted_data.subspan (data.size(), kDataSaltSize);
+	auto const hmac_field = encrypted_data.subspan (data.size() + kDataSaltSize, _hmac_size);
+
+	store_sequence_number (_sequence_number, sequence_number_field);
+	std::copy (data.begin(), data.end(), encrypted_data.begin());
+
+	for (size_t i = 0; i < salt_field.size(); i += sizeof (std::random_device::result_type))
+	{
+		auto const random = _random_device();
+		std::memcpy (salt_field.data() + i, &random, std::min (sizeof (random), salt_field.size() - i));
+	}
+
+	// HMAC of data + salt + binary_sequence_number. Data and salt are already adjacent in the output buffer:
+	std::array<uint8_t, SignatureHMAC::DIGESTSIZE> full_hmac;
+	_hmac.Update (encrypted_data.data(), data.size() + kDataSaltSize);
+	_hmac.Update (sequence_number_field.data(), sequence_number_field.size());
+	_hmac.Final (full_hmac.data());
+	std::copy_n (full_hmac.begin(), _hmac_size, hmac_field.begin());
+
+	std::array<uint8_t, kNonceSize> nonce;
+	compute_nonce (BlobView (sequence_number_field.data(), sequence_number_field.size()), nonce);
+	aes_ctr_xor_in_place (_data_cipher, nonce, encrypted_data);
+
+	// Encrypted data must be at least 8 bytes, but longer is better for better entropy to avoid
+	// repeating nonce ever. That's why data salt is added before encryption. Hashing just the encrypted
+	// salt and HMAC keeps this cost independent of the packet size:
+	auto const encrypted_trailer = encrypted_data.last (kDataSaltSize + _hmac_size);
+	compute_nonce (BlobView (encrypted_trailer.data(), encrypted_trailer.size()), nonce);
+	aes_ctr_xor_in_place (_seq_num_cipher, nonce, sequence_number_field);
+
+	return packet_size;
 }
 
 
+Receiver::Receiver (Params const& params):
+	Transport (params),
+	_replay_window (params.replay_window_size)
+{ }
+
+
 Blob
 Receiver::decrypt_packet (BlobView const encrypted_packet, std::optional<SequenceNumber> const maximum_allowed_sequence_number)
 {
-	auto const encrypted_sequence_number = encrypted_packet.substr (0, sizeof (_sequence_number));
-	auto const encrypted_data = encrypted_packet.substr (sizeof (_sequence_number));
-	auto const binary_sequence_number = nu::aes_ctr_xor ({
-		.data = encrypted_sequence_number,
-		.key = *_seq_num_encryption_key,
-		.nonce = nu::compute_hash<kSeqNumNonceHashAlgorithm> (encrypted_data).substr (0, 8),
-	});
-	auto const data_with_hmac = nu::aes_ctr_xor ({
-		.data = encrypted_data,
-		.key = *_data_encryption_key,
-		.nonce = nu::compute_hash<kDataNonceHashAlgorithm> (binary_sequence_number).substr (0, 8),
-	});
+	Blob data (std::max (encrypted_packet.size(), sizeof (SequenceNumber)) - sizeof (SequenceNumber), 0);
+	data.resize (decrypt_packet (encrypted_packet, data, maximum_allowed_sequence_number));
+	return data;
+}
+
+
+size_t
+Receiver::decrypt_packet (BlobView const encrypted_packet,
+						  std::span<uint8_t> const output,
+						  std::optional<SequenceNumber> const maximum_allowed_sequence_number)
+{
+	if (encrypted_packet.size() < sizeof (SequenceNumber) + kDataSaltSize + _hmac_size)
+		throw DecryptionFailure (ErrorCode::HMACTooShort, "HMAC too short");
 
-	if (data_with_hmac.size() >= kDataSaltSize + _hmac_size)
+	if (SignatureHMAC::DIGESTSIZE < _hmac_size)
+		throw std::logic_error ("HMAC size doesn't fit requirements");
+
+	auto const encrypted_data = encrypted_packet.substr (sizeof (SequenceNumber));
+
+	if (output.size() < encrypted_data.size())
+		throw std::length_error ("output buffer too small for the decrypted packet");
+
+	std::array<uint8_t, sizeof (SequenceNumber)> binary_sequence_number;
+	std::array<uint8_t, kNonceSize> nonce;
+	std::copy_n (encrypted_packet.begin(), binary_sequence_number.size(), binary_sequence_number.begin());
+	compute_nonce (encrypted_data.substr (encrypted_data.size() - kDataSaltSize - _hmac_size), nonce);
+	aes_ctr_xor_in_place (_seq_num_cipher, nonce, binary_sequence_number);
+
+	auto const data_with_hmac = output.first (encrypted_data.size());
+	std::copy (encrypted_data.begin(), encrypted_data.end(), data_with_hmac.begin());
+	compute_nonce (BlobView (binary_sequence_number.data(), binary_sequence_number.size()), nonce);
+	aes_ctr_xor_in_place (_data_cipher, nonce, data_with_hmac);
+
+	auto const data_size = data_with_hmac.size() - kDataSaltSize - _hmac_size;
+	auto const hmac = data_with_hmac.subspan (data_size + kDataSaltSize);
+
+	std::array<uint8_t, SignatureHMAC::DIGESTSIZE> computed_full_hmac;
+	_hmac.Update (data_with_hmac.data(), data_size + kDataSaltSize);
+	_hmac.Update (binary_sequence_number.data(), binary_sequence_number.size());
+	_hmac.Final (computed_full_hmac.data());
+
+	if (!CryptoPP::VerifyBufsEqual (computed_full_hmac.data(), hmac.data(), hmac.size()))
+		throw DecryptionFailure (ErrorCode::InvalidAuthentication, "invalid authentication");
+
+	auto const sequence_number = load_sequence_number (binary_sequence_number);
+
+	switch (_replay_window.check (sequence_number))
 	{
-		auto data = BlobView (data_with_hmac);
-		auto salt = data;
-		auto hmac = data;
-		data.remove_suffix (kDataSaltSize + _hmac_size);
-		salt.remove_prefix (data.size());
-		salt.remove_suffix (_hmac_size);
-		hmac.remove_prefix (data.size() + kDataSaltSize);
-
-		auto const computed_full_hmac = nu::compute_hmac<kSignatureHMACHashAlgorithm> ({
-			.data = Blob (data) + salt + binary_sequence_number,
-			.key = *_hmac_key,
-		});
-		auto computed_hmac = BlobView (computed_full_hmac).substr (0, _hmac_size);
-
-		if (computed_hmac == hmac)
-		{
-			auto const sequence_number = nu::parse<SequenceNumber> (binary_sequence_number);
-
-			if (sequence_number <= _sequence_number)
-				throw DecryptionFailure (ErrorCode::SeqNumFromPast, "sequence number from past is invalid");
-
-			if (maximum_allowed_sequence_number)
-				if (sequence_number > *maximum_allowed_sequence_number)
-					throw DecryptionFailure (ErrorCode::SeqNumFromFarFuture, "sequence number from far future is invalid");
-
-			_sequence_number = sequence_number;
-
-			return Blob (data);
-		}
-		else
-			throw DecryptionFailure (ErrorCode::InvalidAuthentication, "invalid authentication");
+		case ReplayWindow::Result::Fresh:
+			break;
+
+		case ReplayWindow::Result::Duplicate:
+			throw DecryptionFailure (ErrorCode::SeqNumReplayed, "sequence number already seen is invalid");
+
+		case ReplayWindow::Result::TooOld:
+			throw DecryptionFailure (ErrorCode::SeqNumFromPast, "sequence number from past is invalid");
 	}
-	else
-		throw DecryptionFailure (ErrorCode::HMACTooShort, "HMAC too short");
+
+	if (maximum_allowed_sequence_number)
+		if (sequence_number > *maximum_allowed_sequence_number)
+			throw DecryptionFailure (ErrorCode::SeqNumFromFarFuture, "sequence number from far future is invalid");
+
+	_replay_window.accept (sequence_number);
+	_sequence_number = _replay_window.highest();
+
+	return data_size;
 }
 
 } // namespace xf::crypto::xle
@@ -18,15 +18,24 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/crypto/xle/replay_window.h>
 
 // Neutrino:
 #include <neutrino/crypto/hash.h>
 #include <neutrino/crypto/secure.h>
 #include <neutrino/exception.h>
 
+// Lib:
+#include <cryptopp/aes.h>
+#include <cryptopp/hmac.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha3.h>
+
 // Standard:
 #include <cstddef>
+#include <cstdint>
 #include <random>
+#include <span>
 
 
 namespace xf::crypto::xle {
@@ -50,6 +59,9 @@ class Transport
 		BlobView	seq_num_encryption_secret	{ };
 		size_t		hmac_size					{ 12 };
 		BlobView	hkdf_user_info				{ };
+		// Receiver only: how many most recent sequence numbers are tracked so that reordered
+		// packets can still be accepted exactly once. 0 accepts only increasing numbers:
+		size_t		replay_window_size			{ 64 };
 	};
 
 	enum ErrorCode
@@ -58,6 +70,7 @@ class Transport
 		InvalidAuthentication,
 		SeqNumFromPast,
 		SeqNumFromFarFuture,
+		SeqNumReplayed,
 	};
 
 	class DecryptionFailure: public nu::Exception
@@ -74,6 +87,14 @@ class Transport
 	};
 
   protected:
+	// Size of nonces taken from hash results and used as the upper half of AES-CTR IVs:
+	static constexpr size_t kNonceSize = 8;
+
+	// Crypto++ counterparts of the algorithms below, used on the per-packet path:
+	using SignatureHMAC		= CryptoPP::HMAC<CryptoPP::SHA3_256>;
+	using NonceHash			= CryptoPP::SHA3_256;
+	using CTRCipher			= CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption;
+
 	static constexpr nu::Hash::Algorithm const kSignatureHMACHashAlgorithm				= nu::Hash::SHA3_256;
 	static constexpr nu::Hash::Algorithm const kDataEncryptionKeyHKDFHashAlgorithm		= nu::Hash::SHA3_256;
 	static constexpr nu::Hash::Algorithm const kDataNonceHashAlgorithm					= nu::Hash::SHA3_256;
@@ -109,12 +130,32 @@ class Transport
 	data_encryption_key_hash() const
 		{ return nu::compute_hash<nu::Hash::SHA3_256> (*_data_encryption_key); }
 
+  protected:
+	/**
+	 * Compute truncated hash of given data into a stack-allocated nonce.
+	 */
+	void
+	compute_nonce (BlobView data, std::span<uint8_t, kNonceSize> result);
+
+	/**
+	 * XOR data in place with AES-CTR keystream, using given cipher and nonce as IV.
+	 * Cipher must be already keyed; only the IV is reset.
+	 */
+	static void
+	aes_ctr_xor_in_place (CTRCipher&, std::span<uint8_t const, kNonceSize> nonce, std::span<uint8_t> data);
+
   protected:
 	size_t				_hmac_size;
 	nu::Secure<Blob>	_hmac_key;
 	nu::Secure<Blob>	_data_encryption_key;
 	nu::Secure<Blob>	_seq_num_encryption_key;
 	SequenceNumber		_sequence_number	{ 0 };
+	// Pre-keyed contexts reused across packets, so that key schedules (AES-NI accelerated by Crypto++
+	// when available) and HMAC inner/outer pads are computed only once per session:
+	SignatureHMAC		_hmac;
+	NonceHash			_nonce_hash;
+	CTRCipher			_data_cipher;
+	CTRCipher			_seq_num_cipher;
 };
 
 
@@ -134,6 +175,17 @@ class Transmitter: public Transport
 	Blob
 	encrypt_packet (BlobView);
 
+	/**
+	 * Encrypt next packet into caller-provided buffer without any heap allocations.
+	 * Buffer must be at least data.size() + ciphertext_expansion() bytes long.
+	 *
+	 * \returns	number of bytes written to the output buffer.
+	 * \throws		std::logic_error if computed HMAC size < configured hmac_size.
+	 * \throws		std::length_error if output buffer is too small.
+	 */
+	size_t
+	encrypt_packet (BlobView data, std::span<uint8_t> output);
+
   private:
 	std::random_device& _random_device;
 };
@@ -143,7 +195,8 @@ class Receiver: public Transport
 {
   public:
 	// Ctor
-	using Transport::Transport;
+	explicit
+	Receiver (Params const&);
 
 	/**
 	 * Return next decrypted packet.
@@ -153,6 +206,30 @@ class Receiver: public Transport
 	[[nodiscard]]
 	Blob
 	decrypt_packet (BlobView data, std::optional<SequenceNumber> maximum_allowed_sequence_number = std::nullopt);
+
+	/**
+	 * Decrypt next packet into caller-provided buffer without any heap allocations.
+	 * Output buffer is also used as scratch space for the salt and HMAC, so it must be
+	 * at least encrypted_packet.size() - sizeof (SequenceNumber) bytes long. Plain text
+	 * is placed at the beginning of the buffer.
+	 *
+	 * \returns	size of the decrypted plain text.
+	 * \throws		DecryptionFailure on various occasions.
+	 * \throws		std::length_error if output buffer is too small.
+	 */
+	size_t
+	decrypt_packet (BlobView encrypted_packet, std::span<uint8_t> output, std::optional<SequenceNumber> maximum_allowed_sequence_number = std::nullopt);
+
+	/**
+	 * Return the replay window.
+	 */
+	[[nodiscard]]
+	ReplayWindow const&
+	replay_window() const noexcept
+		{ return _replay_window; }
+
+  private:
+	ReplayWindow _replay_window;
 };
 
 
@@ -96,7 +96,7 @@ CHRUM6::CHRUM6 (nu::SerialPort* serial_port, nu::Logger const& logger):
 	_serial_port->set_data_ready_callback (std::bind (&CHRUM6::serial_ready, this));
 	_serial_port->set_failure_callback (std::bind (&CHRUM6::serial_failure, this));
 
-	_packet_reader = std::make_unique<PacketReader> (Blob { 's', 'n', 'p' }, std::bind (&CHRUM6::parse_packet, this));
+	_packet_reader = std::make_unique<PacketReader> (Blob { 's', 'n', 'p' }, [this] (BlobView const packet) { return parse_packet (packet); });
 	_packet_reader->set_minimum_packet_size (7);
 	_packet_reader->set_buffer_capacity (4096);
 
@@ -265,10 +265,8 @@ CHRUM6::make_packet (uint32_t address, bool write_operation, uint32_t data)
 
 
 std::size_t
-CHRUM6::parse_packet()
+CHRUM6::parse_packet (BlobView const packet)
 {
-	Blob& packet = _packet_reader->buffer();
-
 	// Packet type byte:
 	uint8_t packet_type = packet[3];
 
@@ -611,7 +611,7 @@ class CHRUM6
 	 * Call various processing functions.
 	 */
 	std::size_t
-	parse_packet();
+	parse_packet (BlobView packet);
 
 	/**
 	 * Sends packet through serial port.
@@ -34,6 +34,14 @@ InstrumentPainter::InstrumentPainter (QPaintDevice& device, TextPainter::Cache&
 }
 
 
+void
+InstrumentPainter::set_shadow_mode (ShadowMode const mode) noexcept
+{
+	ShadowPainter::set_shadow_mode (mode);
+	set_glyph_shadows_enabled (mode == ShadowMode::Repaint);
+}
+
+
 void
 InstrumentPainter::save_context (std::function<void()> paint_callback)
 {
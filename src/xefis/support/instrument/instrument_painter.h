@@ -38,6 +38,14 @@ class InstrumentPainter:
 	explicit
 	InstrumentPainter (QPaintDevice&, TextPainter::Cache&);
 
+	/**
+	 * Set shadow mode for both shadow painting and text. In ShadowMode::Deferred glyphs
+	 * are drawn without their baked shadows, since the shadow is added to the whole
+	 * image afterwards.
+	 */
+	void
+	set_shadow_mode (ShadowMode mode) noexcept;
+
 	/**
 	 * Calls save(), then the provided callback and then restore().
 	 * It's exception-safe meaning that restore() will be called
@@ -73,7 +73,7 @@ class InstrumentSupport
   private:
 	Graphics const&									_graphics;
 	nu::Synchronized<Data> mutable					_data;
-	static inline thread_local TextPainter::Cache	_text_painter_cache;
+	static inline TextPainter::Cache				_text_painter_cache;
 };
 
 
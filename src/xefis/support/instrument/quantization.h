@@ -0,0 +1,56 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__INSTRUMENT__QUANTIZATION_H__INCLUDED
+#define XEFIS__SUPPORT__INSTRUMENT__QUANTIZATION_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Standard:
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+
+namespace xf {
+
+/**
+ * Round value to the nearest multiple of resolution.
+ * Instruments use it on copies of their parameters to detect changes
+ * that would actually be visible on the screen. Value is left unchanged
+ * if resolution is zero or not finite.
+ */
+template<class Value>
+	inline void
+	quantize (Value& value, std::type_identity_t<Value> const resolution)
+	{
+		auto const steps = static_cast<double> (value / resolution);
+
+		if (std::isfinite (steps))
+			value = std::round (steps) * resolution;
+	}
+
+
+template<class Value>
+	inline void
+	quantize (std::optional<Value>& value, std::type_identity_t<Value> const resolution)
+	{
+		if (value)
+			quantize (*value, resolution);
+	}
+
+} // namespace xf
+
+#endif
@@ -20,15 +20,88 @@
 // Neutrino:
 #include <neutrino/scope_exit.h>
 
+// System:
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // Standard:
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 
 namespace xf {
 
+/**
+ * Element-wise maximum of two byte arrays, stored in target. Target may be the same as
+ * one of the sources.
+ */
+static inline void
+max_of (uint8_t* target, uint8_t const* a, uint8_t const* b, std::size_t const size)
+{
+	std::size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 16 <= size; i += 16)
+	{
+		auto const va = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (a + i));
+		auto const vb = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (b + i));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (target + i), _mm_max_epu8 (va, vb));
+	}
+#endif
+
+	for (; i < size; ++i)
+		target[i] = std::max (a[i], b[i]);
+}
+
+
+/**
+ * Running maximum over windows of given size (van Herk/Gil-Werman algorithm), so that
+ * the cost doesn't depend on the window size: result[i] = max (source[i], …, source[i + window - 1])
+ * for i in [0, count). Elements are blocks of lanes bytes, compared lane by lane.
+ * Source must have count + window - 1 elements; prefix and suffix are scratch buffers.
+ */
+static void
+running_max (uint8_t const* source, uint8_t* result, std::size_t const count, std::size_t const window, std::size_t const lanes,
+			 std::vector<uint8_t>& prefix, std::vector<uint8_t>& suffix)
+{
+	auto const source_count = count + window - 1;
+	auto const element = [lanes] (auto* data, std::size_t const index) { return data + index * lanes; };
+
+	prefix.resize (source_count * lanes);
+	suffix.resize (source_count * lanes);
+
+	// Maximums from the beginning of each window-sized block:
+	for (std::size_t i = 0; i < source_count; ++i)
+	{
+		if (i % window == 0)
+			std::copy_n (element (source, i), lanes, element (prefix.data(), i));
+		else
+			max_of (element (prefix.data(), i), element (prefix.data(), i - 1), element (source, i), lanes);
+	}
+
+	// Maximums to the end of each window-sized block:
+	for (std::size_t i = source_count; i-- > 0; )
+	{
+		if (i == source_count - 1 || i % window == window - 1)
+			std::copy_n (element (source, i), lanes, element (suffix.data(), i));
+		else
+			max_of (element (suffix.data(), i), element (suffix.data(), i + 1), element (source, i), lanes);
+	}
+
+	// Each window spans the end of one block and the beginning of the next one:
+	for (std::size_t i = 0; i < count; ++i)
+		max_of (element (result, i), element (suffix.data(), i), element (prefix.data(), i + window - 1), lanes);
+}
+
+
 void
 ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 {
+	if (_shadow_mode == ShadowMode::Repaint)
 	{
 		auto const saved_pen = pen();
 		nu::ScopeExit pen_restore ([&]{ setPen (saved_pen); });
@@ -39,6 +112,9 @@ ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 		QPen new_pen = saved_pen;
 		new_pen.setColor (shadow.color());
 		new_pen.setWidthF (new_width);
+
+		// Dash pattern is relative to pen width, so it has to be rescaled to keep dashes in place:
+		if (saved_pen.style() != Qt::SolidLine && saved_pen.style() != Qt::NoPen)
 		{
 			auto dash_pattern = saved_pen.dashPattern();
 			auto const factor = old_width / new_width;
@@ -48,6 +124,7 @@ ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 
 			new_pen.setDashPattern (dash_pattern);
 		}
+
 		setPen (new_pen);
 
 		paint_function (true);
@@ -56,4 +133,73 @@ ShadowPainter::paint (Shadow const& shadow, PaintFunction paint_function)
 	paint_function (false);
 }
 
+
+void
+ShadowPainter::add_dilated_shadow (QImage& image, Shadow const& shadow)
+{
+	if (image.isNull())
+		return;
+
+	if (image.format() != QImage::Format_ARGB32_Premultiplied)
+		image.convertTo (QImage::Format_ARGB32_Premultiplied);
+
+	auto const width = static_cast<std::size_t> (image.width());
+	auto const height = image.height();
+	auto const radius = static_cast<std::size_t> (std::max (1, static_cast<int> (std::lround (shadow.width()))));
+	auto const window = 2 * radius + 1;
+	std::vector<uint8_t> prefix;
+	std::vector<uint8_t> suffix;
+
+	// Alpha channel dilated horizontally, with radius zero rows above and below, so that
+	// the vertical pass doesn't need to check bounds:
+	std::vector<uint8_t> dilated_rows ((height + 2 * radius) * width, 0);
+	std::vector<uint8_t> padded_row (width + 2 * radius, 0);
+
+	for (int y = 0; y < height; ++y)
+	{
+		auto const* const pixels = reinterpret_cast<QRgb const*> (image.constScanLine (y));
+
+		for (std::size_t x = 0; x < width; ++x)
+			padded_row[radius + x] = qAlpha (pixels[x]);
+
+		running_max (padded_row.data(), dilated_rows.data() + (radius + y) * width, width, window, 1, prefix, suffix);
+	}
+
+	// Dilate vertically, whole rows at once:
+	std::vector<uint8_t> dilated (height * width);
+	running_max (dilated_rows.data(), dilated.data(), height, window, width, prefix, suffix);
+
+	// Composite the shadow under the image:
+	auto const shadow_color = qPremultiply (shadow.color().rgba());
+	auto const shadow_r = static_cast<uint32_t> (qRed (shadow_color));
+	auto const shadow_g = static_cast<uint32_t> (qGreen (shadow_color));
+	auto const shadow_b = static_cast<uint32_t> (qBlue (shadow_color));
+	auto const shadow_a = static_cast<uint32_t> (qAlpha (shadow_color));
+
+	for (int y = 0; y < height; ++y)
+	{
+		auto* const pixels = reinterpret_cast<QRgb*> (image.scanLine (y));
+		auto const* const dilated_row = dilated.data() + y * width;
+
+		for (std::size_t x = 0; x < width; ++x)
+		{
+			auto const pixel = pixels[x];
+			// Shadow coverage times transparency of the pixel over it, in range 0…255²:
+			auto const factor = dilated_row[x] * (255u - qAlpha (pixel));
+
+			if (factor != 0)
+			{
+				auto const blend = [factor] (uint32_t const component) {
+					return (component * factor + 255u * 255u / 2u) / (255u * 255u);
+				};
+
+				pixels[x] = qRgba (qRed (pixel) + blend (shadow_r),
+								   qGreen (pixel) + blend (shadow_g),
+								   qBlue (pixel) + blend (shadow_b),
+								   qAlpha (pixel) + blend (shadow_a));
+			}
+		}
+	}
+}
+
 } // namespace xf
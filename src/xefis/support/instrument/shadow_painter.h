@@ -19,10 +19,12 @@
 #include <xefis/support/instrument/shadow.h>
 
 // Qt:
+#include <QtGui/QImage>
 #include <QtGui/QPainter>
 
 // Standard:
 #include <cstddef>
+#include <functional>
 
 
 namespace xf {
@@ -33,6 +35,18 @@ class ShadowPainter: virtual public QPainter
 	using DefaultPaintFunction	= std::function<void()>;
 	using PaintFunction			= std::function<void (bool painting_shadow)>;
 
+	/**
+	 * How paint() draws shadows.
+	 */
+	enum class ShadowMode
+	{
+		// Call the paint function twice, first time with widened pen in shadow color:
+		Repaint,
+		// Call the paint function only once, without the shadow. The shadow is expected
+		// to be added to the whole painted image afterwards with add_dilated_shadow():
+		Deferred,
+	};
+
   public:
 	// Ctor
 	ShadowPainter() = default;
@@ -41,10 +55,22 @@ class ShadowPainter: virtual public QPainter
 	explicit
 	ShadowPainter (QPaintDevice&);
 
+	/**
+	 * Set shadow mode used by paint(). Default is ShadowMode::Repaint.
+	 */
+	void
+	set_shadow_mode (ShadowMode mode) noexcept
+		{ _shadow_mode = mode; }
+
+	[[nodiscard]]
+	ShadowMode
+	shadow_mode() const noexcept
+		{ return _shadow_mode; }
+
 	/**
 	 * Add a shadow under painted primitives.
-	 * The PaintFunction will be called twice with different state of the
-	 * painter to "repaint" the shadow.
+	 * In ShadowMode::Repaint the PaintFunction will be called twice with different state
+	 * of the painter to "repaint" the shadow. In ShadowMode::Deferred it's called only once.
 	 */
 	void
 	paint (Shadow const&, PaintFunction);
@@ -54,6 +80,18 @@ class ShadowPainter: virtual public QPainter
 	 */
 	void
 	paint (Shadow const&, DefaultPaintFunction);
+
+	/**
+	 * Add shadow under everything painted on the image in a single pass: dilate the alpha
+	 * channel by the shadow width and composite the shadow color beneath existing pixels.
+	 * Use it on images painted in ShadowMode::Deferred. The image must not be painted on
+	 * while this function runs.
+	 */
+	static void
+	add_dilated_shadow (QImage&, Shadow const&);
+
+  private:
+	ShadowMode	_shadow_mode	{ ShadowMode::Repaint };
 };
 
 
@@ -22,24 +22,69 @@
 #include <neutrino/qt/qfontmetrics.h>
 
 // Qt:
+#include <QHashFunctions>
 #include <QPainterPath>
 
 // Standard:
+#include <algorithm>
 #include <cstddef>
 #include <cmath>
+#include <cstring>
 
 
 namespace xf {
 
-TextPainter::Cache::Glyph::Glyph (QFont const& font, QColor color, QChar character, QPointF position_correction, std::optional<Shadow> shadow):
-	data (std::make_shared<Data>())
+TextPainter::Cache::Cache (std::size_t const max_bytes):
+	_max_bytes (max_bytes)
+{ }
+
+
+std::size_t
+TextPainter::Cache::FontHash::operator() (Font const& font) const
+{
+	return qHashMulti (0, font.font, font.color.rgba(), font.shadow_width, font.position_correction.x(), font.position_correction.y());
+}
+
+
+QImage
+TextPainter::Cache::get_glyphs (Font const& font, QString const& text, std::optional<Shadow> const shadow, std::vector<Glyph>& result)
 {
-	QFontMetricsF metrics (font);
-	position_correction.setX (position_correction.x() * metrics.horizontalAdvance ("0"));
-	position_correction.setY (position_correction.y() * nu::line_height (metrics));
-	QSize size (std::ceil (metrics.horizontalAdvance (character)) + 1, std::ceil (nu::line_height (metrics)) + 1);
+	auto data = _data.lock();
+	auto& atlas = data->atlases[font];
+	auto const previous_bytes = static_cast<std::size_t> (atlas.image.sizeInBytes());
+	atlas.last_use = ++data->use_counter;
+	result.clear();
+
+	for (QChar const c: text)
+	{
+		auto glyph = atlas.glyphs.find (c.unicode());
+
+		if (glyph == atlas.glyphs.end())
+			glyph = atlas.glyphs.emplace (c.unicode(), add_glyph (atlas, font, c, shadow)).first;
+
+		result.push_back (glyph->second);
+	}
+
+	if (auto const bytes = static_cast<std::size_t> (atlas.image.sizeInBytes()); bytes != previous_bytes)
+	{
+		data->total_bytes += bytes - previous_bytes;
+		evict (*data, atlas);
+	}
+
+	return atlas.image;
+}
+
+
+TextPainter::Cache::Glyph
+TextPainter::Cache::add_glyph (Atlas& atlas, Font const& font, QChar const character, std::optional<Shadow> const shadow)
+{
+	QFontMetricsF metrics (font.font);
+	QPointF const position_correction (font.position_correction.x() * metrics.horizontalAdvance ("0"),
+									   font.position_correction.y() * nu::line_height (metrics));
+	QSize const size (std::ceil (metrics.horizontalAdvance (character)) + 1, std::ceil (nu::line_height (metrics)) + 1);
+	Glyph const glyph { allocate (atlas, size * Rank), size };
 	QImage image (size, QImage::Format_ARGB32_Premultiplied);
-	QColor alpha = color;
+	QColor alpha = font.color;
 	alpha.setAlpha (0);
 	QPainter painter (&image);
 	painter.setRenderHint (QPainter::Antialiasing, true);
@@ -50,7 +95,7 @@ TextPainter::Cache::Glyph::Glyph (QFont const& font, QColor color, QChar charact
 
 	if (shadow)
 	{
-		QColor shadow_color = color.darker (800);
+		QColor shadow_color = font.color.darker (800);
 		shadow_color.setAlpha (100);
 		shadow_pen.setColor (shadow_color);
 		shadow_pen.setWidthF (shadow->width_for_pen (shadow_pen));
@@ -67,7 +112,7 @@ TextPainter::Cache::Glyph::Glyph (QFont const& font, QColor color, QChar charact
 			QPointF position (fx, fy + metrics.ascent());
 			position += position_correction;
 			QPainterPath glyph_path;
-			glyph_path.addText (position, font, character);
+			glyph_path.addText (position, font.font, character);
 
 			QPainterPath clip_path;
 			clip_path.addRect (image.rect());
@@ -85,12 +130,82 @@ TextPainter::Cache::Glyph::Glyph (QFont const& font, QColor color, QChar charact
 
 			painter.setClipping (false);
 			painter.setPen (Qt::NoPen);
-			painter.setBrush (color);
+			painter.setBrush (font.color);
 			painter.drawPath (glyph_path);
 
-			data->positions[x][y] = image;
+			copy_pixels (image, atlas.image, glyph.variant (x, y).topLeft());
 		}
 	}
+
+	return glyph;
+}
+
+
+QPoint
+TextPainter::Cache::allocate (Atlas& atlas, QSize const block)
+{
+	auto const width = std::max ({ kMinAtlasWidth, block.width(), atlas.image.width() });
+
+	// Start new shelf if the block doesn't fit in the current one:
+	if (atlas.next_position.x() + block.width() > width)
+	{
+		atlas.next_position = QPoint (0, atlas.next_position.y() + atlas.shelf_height);
+		atlas.shelf_height = 0;
+	}
+
+	auto const required_height = atlas.next_position.y() + block.height();
+
+	if (width > atlas.image.width() || required_height > atlas.image.height())
+	{
+		// Other threads may still use the old image, so create a new one instead of resizing in place.
+		// Double the height to keep the number of reallocations low:
+		QImage enlarged (width, std::max (required_height, 2 * atlas.image.height()), QImage::Format_ARGB32_Premultiplied);
+		enlarged.fill (Qt::transparent);
+
+		if (!atlas.image.isNull())
+			copy_pixels (atlas.image, enlarged, QPoint (0, 0));
+
+		atlas.image = enlarged;
+	}
+
+	auto const position = atlas.next_position;
+	atlas.next_position.rx() += block.width();
+	atlas.shelf_height = std::max (atlas.shelf_height, block.height());
+	return position;
+}
+
+
+void
+TextPainter::Cache::copy_pixels (QImage const& source, QImage& target, QPoint const position)
+{
+	auto const bytes_per_pixel = target.depth() / 8;
+	auto const row_bytes = static_cast<std::size_t> (source.width() * bytes_per_pixel);
+
+	for (int row = 0; row < source.height(); ++row)
+	{
+		auto* const target_row = const_cast<uchar*> (target.constScanLine (position.y() + row)) + position.x() * bytes_per_pixel;
+		std::memcpy (target_row, source.constScanLine (row), row_bytes);
+	}
+}
+
+
+void
+TextPainter::Cache::evict (Data& data, Atlas const& in_use) const
+{
+	while (data.total_bytes > _max_bytes)
+	{
+		auto lru = data.atlases.end();
+
+		for (auto atlas = data.atlases.begin(); atlas != data.atlases.end(); ++atlas)
+			if (&atlas->second != &in_use && (lru == data.atlases.end() || atlas->second.last_use < lru->second.last_use))
+				lru = atlas;
+
+		if (lru == data.atlases.end())
+			break;
+
+		data.total_bytes -= static_cast<std::size_t> (lru->second.image.sizeInBytes());
+		data.atlases.erase (lru);
+	}
 }
 
 
@@ -192,38 +307,23 @@ TextPainter::fast_draw_text (QRectF const& target, Qt::Alignment flags, QString
 
 	QColor color = pen().color();
 
-	float const shadow_width = shadow ? shadow->width_for_pen (pen()) : 0.0f;
-
-	// Find/insert to font cache:
-	Cache::Font const required_font { font(), color, shadow_width };
-	Cache::Glyphs* glyphs_cache { nullptr };
+	if (!_glyph_shadows_enabled)
+		shadow.reset();
 
-	if (!_cache.last || _cache.last->font != required_font)
-	{
-		if (auto it = _cache.fonts.find (required_font); it != _cache.fonts.end())
-			_cache.last = Cache::Last { required_font, &it->second };
-		else
-		{
-			it = _cache.fonts.emplace (required_font, Cache::Glyphs()).first;
-			_cache.last = Cache::Last { required_font, &it->second };
-		}
-	}
+	float const shadow_width = shadow ? shadow->width_for_pen (pen()) : 0.0f;
 
-	glyphs_cache = _cache.last->glyphs;
+	// All glyphs come from a single atlas image:
+	Cache::Font const required_font { font(), color, shadow_width, _position_correction };
+	QImage const atlas = _cache.get_glyphs (required_font, text, shadow, _glyphs);
 
-	for (QString::ConstIterator c = text.begin(); c != text.end(); ++c)
+	for (std::size_t i = 0; i < _glyphs.size(); ++i)
 	{
-		auto glyph = glyphs_cache->find (*c);
-
-		if (glyph == glyphs_cache->end())
-			glyph = glyphs_cache->insert ({ *c, Cache::Glyph (font(), color, *c, _position_correction, shadow) }).first;
-
 		float fx = nu::floored_mod<float> (offset.x(), 1.f);
 		float fy = nu::floored_mod<float> (offset.y(), 1.f);
-		int dx = std::clamp<int> (fx * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
-		int dy = std::clamp<int> (fy * Cache::Glyph::Rank, 0, Cache::Glyph::Rank - 1);
-		drawImage (QPoint (offset.x(), offset.y()), glyph->second.data->positions[dx][dy]);
-		offset.rx() += metrics.horizontalAdvance (*c);
+		int dx = std::clamp<int> (fx * Cache::Rank, 0, Cache::Rank - 1);
+		int dy = std::clamp<int> (fy * Cache::Rank, 0, Cache::Rank - 1);
+		drawImage (QPoint (offset.x(), offset.y()), atlas, _glyphs[i].variant (dx, dy));
+		offset.rx() += metrics.horizontalAdvance (text[i]);
 	}
 
 	if (saved_transform)
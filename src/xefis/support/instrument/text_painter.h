@@ -18,16 +18,19 @@
 #include <xefis/config/all.h>
 #include <xefis/support/instrument/shadow.h>
 
+// Neutrino:
+#include <neutrino/synchronized.h>
+
 // Qt:
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 
 // Standard:
 #include <cstddef>
-#include <map>
-#include <memory>
+#include <cstdint>
 #include <optional>
-#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 
 namespace xf {
@@ -40,37 +43,38 @@ class TextPainter: virtual public QPainter
 {
   public:
 	/**
-	 * Stores drawn glyphs.
+	 * Stores drawn glyphs. Each glyph is rendered in Rank × Rank variants shifted by
+	 * subpixel offsets. All glyphs of the same font (including color and shadow) are
+	 * packed into a single atlas image, so that drawing a text only needs blits from one
+	 * image.
+	 *
+	 * Cache is thread-safe and can be shared by painters working in different threads.
+	 * Total size of atlases is limited; when the limit is exceeded, least recently used
+	 * atlases are dropped.
 	 */
 	class Cache
 	{
 		friend class TextPainter;
 
-		class Glyph
+	  public:
+		static constexpr int			Rank				= 8;
+		static constexpr int			kMinAtlasWidth		= 2048;
+		static constexpr std::size_t	kDefaultMaxBytes	= 128 * 1024 * 1024;
+
+	  private:
+		/**
+		 * Position of a glyph in the atlas. Variant for subpixel position (x, y)
+		 * is at origin + (x * size.width(), y * size.height()).
+		 */
+		struct Glyph
 		{
-		  public:
-			static constexpr int Rank = 8;
-
-		  private:
-			struct Data
-			{
-				QImage positions[Rank][Rank];
-			};
-
-		  public:
-			/**
-			 * Generate all images for given character and font.
-			 */
-			explicit
-			Glyph (QFont const&, QColor, QChar, QPointF position_correction, std::optional<Shadow> shadow);
-
-			Glyph (Glyph const& other);
+			QPoint	origin;
+			QSize	size;
 
-			Glyph&
-			operator= (Glyph const& other);
-
-		  public:
-			std::shared_ptr<Data> data;
+			[[nodiscard]]
+			QRect
+			variant (int x, int y) const noexcept
+				{ return QRect (origin + QPoint (x * size.width(), y * size.height()), size); }
 		};
 
 		struct Font
@@ -78,9 +82,7 @@ class TextPainter: virtual public QPainter
 			QFont	font;
 			QColor	color;
 			float	shadow_width;
-
-			bool
-			operator< (Font const&) const;
+			QPointF	position_correction;
 
 			bool
 			operator== (Font const&) const;
@@ -89,19 +91,77 @@ class TextPainter: virtual public QPainter
 			operator!= (Font const&) const;
 		};
 
-		using Glyphs	= std::map<QChar, Glyph>;
-		using Fonts		= std::map<Font, Glyphs>;
+		struct FontHash
+		{
+			std::size_t
+			operator() (Font const&) const;
+		};
 
-		struct Last
+		struct Atlas
 		{
-			Last (Font const&, Glyphs*);
+			QImage									image;
+			std::unordered_map<char16_t, Glyph>		glyphs;
+			// Shelf packing state:
+			QPoint									next_position;
+			int										shelf_height	{ 0 };
+			// Value of the use counter at the last use, for LRU eviction:
+			uint64_t								last_use		{ 0 };
+		};
 
-			Font	font;
-			Glyphs*	glyphs;
+		struct Data
+		{
+			std::unordered_map<Font, Atlas, FontHash>	atlases;
+			std::size_t									total_bytes		{ 0 };
+			uint64_t									use_counter		{ 0 };
 		};
 
-		Fonts				fonts;
-		std::optional<Last>	last;
+	  public:
+		// Ctor
+		explicit
+		Cache (std::size_t max_bytes = kDefaultMaxBytes);
+
+	  private:
+		/**
+		 * Find glyphs for all characters of the text, rendering missing ones.
+		 * Positions are stored in the result vector.
+		 * Return the atlas image. It's a shallow copy, so it stays valid even
+		 * if the atlas gets evicted or reallocated by another thread.
+		 */
+		QImage
+		get_glyphs (Font const&, QString const&, std::optional<Shadow>, std::vector<Glyph>& result);
+
+		/**
+		 * Render all variants of a glyph and place them in the atlas.
+		 */
+		static Glyph
+		add_glyph (Atlas&, Font const&, QChar, std::optional<Shadow>);
+
+		/**
+		 * Return place for a new glyph block of given size in the atlas,
+		 * enlarging the atlas image if necessary.
+		 */
+		static QPoint
+		allocate (Atlas&, QSize);
+
+		/**
+		 * Copy pixels of the source image into the target at given position.
+		 * Writes to the target's data without detaching it: other threads may hold shallow
+		 * copies of the atlas image, but they never read areas that haven't been published
+		 * yet under the lock.
+		 */
+		static void
+		copy_pixels (QImage const& source, QImage& target, QPoint position);
+
+		/**
+		 * Drop least recently used atlases (except the one in use) until
+		 * the total size fits in the limit.
+		 */
+		void
+		evict (Data&, Atlas const& in_use) const;
+
+	  private:
+		nu::Synchronized<Data>	_data;
+		std::size_t				_max_bytes;
 	};
 
   public:
@@ -119,6 +179,14 @@ class TextPainter: virtual public QPainter
 	void
 	set_font_position_correction (QPointF correction);
 
+	/**
+	 * Enable or disable shadows baked into glyphs. When disabled, fast_draw_text() ignores
+	 * the shadow argument and draws shadow-free glyphs. Default is enabled.
+	 */
+	void
+	set_glyph_shadows_enabled (bool enabled) noexcept
+		{ _glyph_shadows_enabled = enabled; }
+
 	QRectF
 	get_text_box (QPointF const& position, Qt::Alignment flags, QString const& text) const;
 
@@ -145,38 +213,21 @@ class TextPainter: virtual public QPainter
 	apply_alignment (QRectF& rect, Qt::Alignment flags);
 
   private:
-	Cache&	_cache;
-	QPointF	_position_correction;
+	Cache&						_cache;
+	QPointF						_position_correction;
+	bool						_glyph_shadows_enabled	{ true };
+	// Reused between calls to avoid allocations:
+	std::vector<Cache::Glyph>	_glyphs;
 };
 
 
-inline
-TextPainter::Cache::Glyph::Glyph (Glyph const& other):
-	data (other.data)
-{ }
-
-
-inline TextPainter::Cache::Glyph&
-TextPainter::Cache::Glyph::operator= (Glyph const& other)
-{
-	data = other.data;
-	return *this;
-}
-
-
-inline bool
-TextPainter::Cache::Font::operator< (Font const& other) const
-{
-	return std::tuple (font, color.rgba(), shadow_width) < std::tuple (other.font, other.color.rgba(), other.shadow_width);
-}
-
-
 inline bool
 TextPainter::Cache::Font::operator== (Font const& other) const
 {
 	return font == other.font
 		&& color == other.color
-		&& shadow_width == other.shadow_width;
+		&& shadow_width == other.shadow_width
+		&& position_correction == other.position_correction;
 }
 
 
@@ -187,12 +238,6 @@ TextPainter::Cache::Font::operator!= (Font const& other) const
 }
 
 
-inline
-TextPainter::Cache::Last::Last (Font const& font, Glyphs* glyphs):
-	font (font),
-	glyphs (glyphs)
-{ }
-
 } // namespace xf
 
 #endif
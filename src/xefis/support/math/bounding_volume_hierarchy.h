@@ -0,0 +1,412 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__MATH__BOUNDING_VOLUME_HIERARCHY_H__INCLUDED
+#define XEFIS__SUPPORT__MATH__BOUNDING_VOLUME_HIERARCHY_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/concepts.h>
+#include <xefis/support/math/geometry_types.h>
+
+// Standard:
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+namespace xf {
+
+/**
+ * Bounding-volume hierarchy of axis-aligned boxes used to speed up ray queries.
+ * Primitives are identified by their index in the vector passed to build().
+ * Boxes of primitives can be updated later with update() and the tree refitted
+ * with refit(), which is much cheaper than rebuilding the tree as long as the
+ * primitives don't move too far relative to each other.
+ */
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	class BoundingVolumeHierarchy
+	{
+	  public:
+		static constexpr std::size_t kMaxLeafSize = 4;
+
+		struct Box
+		{
+			SpaceVector<Scalar, Space>	min;
+			SpaceVector<Scalar, Space>	max;
+
+			/**
+			 * Extend the box so that it also encloses the other one.
+			 */
+			void
+			extend (Box const&);
+
+			[[nodiscard]]
+			bool
+			operator== (Box const&) const = default;
+		};
+
+		struct Hit
+		{
+			std::size_t	primitive;
+			Scalar		distance;
+		};
+
+	  private:
+		struct Node
+		{
+			Box				box;
+			// Index of the first primitive in _primitives for leaves, index of the right child for inner nodes
+			// (left child always directly follows its parent):
+			uint32_t		first;
+			// Number of primitives for leaves, 0 for inner nodes:
+			uint32_t		count;
+			uint32_t		parent;
+			bool			dirty	{ false };
+		};
+
+		static constexpr auto kNoParent = std::numeric_limits<uint32_t>::max();
+
+	  public:
+		/**
+		 * Build the tree from scratch.
+		 */
+		void
+		build (std::vector<Box> boxes);
+
+		/**
+		 * Return number of primitives in the tree.
+		 */
+		[[nodiscard]]
+		std::size_t
+		size() const noexcept
+			{ return _boxes.size(); }
+
+		/**
+		 * Set new box for given primitive. The tree is not valid until refit() is called.
+		 */
+		void
+		update (std::size_t primitive, Box const&);
+
+		/**
+		 * Recompute boxes of nodes containing primitives changed with update().
+		 */
+		void
+		refit();
+
+		/**
+		 * Find nearest primitive hit by the ray.
+		 *
+		 * \param	intersect_primitive
+		 *			Callback (std::size_t primitive) -> std::optional<Scalar> that returns the distance along the ray
+		 *			at which the ray hits the primitive, if it hits at all. It's called only for primitives whose
+		 *			boxes are hit by the ray not farther than the nearest hit found so far.
+		 */
+		template<class Intersect>
+			[[nodiscard]]
+			std::optional<Hit>
+			intersect (SpaceVector<Scalar, Space> const& ray_origin,
+					   SpaceVector<double, Space> const& ray_direction,
+					   Intersect&& intersect_primitive) const;
+
+	  private:
+		/**
+		 * Build subtree for primitives [begin, end) of _primitives and return index of its root node.
+		 */
+		uint32_t
+		build_node (uint32_t begin, uint32_t end, uint32_t parent);
+
+		/**
+		 * Recompute node box from its children or primitives.
+		 */
+		void
+		recompute_box (Node&);
+
+		/**
+		 * Return distance along the ray at which it enters the box, if it hits it at all.
+		 */
+		[[nodiscard]]
+		static std::optional<double>
+		ray_box_entry (std::array<double, 3> const& origin, std::array<double, 3> const& inv_direction, Box const&);
+
+	  private:
+		std::vector<Box>		_boxes;
+		std::vector<Node>		_nodes;
+		// Primitive indices ordered so that each leaf refers to a contiguous range:
+		std::vector<uint32_t>	_primitives;
+		// Leaf node that holds each primitive:
+		std::vector<uint32_t>	_leaf_of_primitive;
+		bool					_needs_refit	{ false };
+	};
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline void
+	BoundingVolumeHierarchy<Scalar, Space>::Box::extend (Box const& other)
+	{
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			min[i] = std::min (min[i], other.min[i]);
+			max[i] = std::max (max[i], other.max[i]);
+		}
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline void
+	BoundingVolumeHierarchy<Scalar, Space>::build (std::vector<Box> boxes)
+	{
+		_boxes = std::move (boxes);
+		_nodes.clear();
+		_primitives.resize (_boxes.size());
+		std::iota (_primitives.begin(), _primitives.end(), 0u);
+		_leaf_of_primitive.resize (_boxes.size());
+		_needs_refit = false;
+
+		if (!_boxes.empty())
+		{
+			// A binary tree with at least one primitive per leaf never has more than 2n - 1 nodes:
+			_nodes.reserve (2 * _boxes.size() - 1);
+			build_node (0, static_cast<uint32_t> (_primitives.size()), kNoParent);
+		}
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline void
+	BoundingVolumeHierarchy<Scalar, Space>::update (std::size_t const primitive, Box const& box)
+	{
+		if (_boxes[primitive] != box)
+		{
+			_boxes[primitive] = box;
+			_nodes[_leaf_of_primitive[primitive]].dirty = true;
+			_needs_refit = true;
+		}
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline void
+	BoundingVolumeHierarchy<Scalar, Space>::refit()
+	{
+		if (!_needs_refit)
+			return;
+
+		// Children always have greater indices than their parents, so a reverse pass
+		// visits each node after all of its children:
+		for (auto n = _nodes.size(); n-- > 0; )
+		{
+			auto& node = _nodes[n];
+
+			if (node.dirty)
+			{
+				recompute_box (node);
+				node.dirty = false;
+
+				if (node.parent != kNoParent)
+					_nodes[node.parent].dirty = true;
+			}
+		}
+
+		_needs_refit = false;
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	template<class Intersect>
+		inline auto
+		BoundingVolumeHierarchy<Scalar, Space>::intersect (SpaceVector<Scalar, Space> const& ray_origin,
+														   SpaceVector<double, Space> const& ray_direction,
+														   Intersect&& intersect_primitive) const
+			-> std::optional<Hit>
+		{
+			auto result = std::optional<Hit>();
+
+			if (_nodes.empty())
+				return result;
+
+			auto const origin = std::array { ray_origin[0] / Scalar (1), ray_origin[1] / Scalar (1), ray_origin[2] / Scalar (1) };
+			// Division by zero gives infinities which the slab test handles correctly:
+			auto const inv_direction = std::array { 1.0 / ray_direction[0], 1.0 / ray_direction[1], 1.0 / ray_direction[2] };
+			auto nearest = std::numeric_limits<double>::infinity();
+			// Stack of nodes to visit along with their entry distances:
+			std::vector<std::pair<uint32_t, double>> stack;
+
+			if (auto const entry = ray_box_entry (origin, inv_direction, _nodes[0].box))
+				stack.emplace_back (0u, *entry);
+
+			while (!stack.empty())
+			{
+				auto const [index, entry] = stack.back();
+				stack.pop_back();
+
+				if (entry >= nearest)
+					continue;
+
+				auto const& node = _nodes[index];
+
+				if (node.count > 0)
+				{
+					for (auto p = node.first; p < node.first + node.count; ++p)
+					{
+						auto const primitive = _primitives[p];
+
+						if (std::optional<Scalar> const distance = intersect_primitive (static_cast<std::size_t> (primitive)))
+						{
+							if (auto const value = *distance / Scalar (1); value < nearest)
+							{
+								nearest = value;
+								result = Hit { primitive, *distance };
+							}
+						}
+					}
+				}
+				else
+				{
+					auto const left = index + 1;
+					auto const right = node.first;
+					auto const left_entry = ray_box_entry (origin, inv_direction, _nodes[left].box);
+					auto const right_entry = ray_box_entry (origin, inv_direction, _nodes[right].box);
+
+					// Push the farther child first, so that the nearer one is visited first and
+					// has a chance to prune the other one:
+					if (left_entry && right_entry)
+					{
+						if (*left_entry < *right_entry)
+						{
+							stack.emplace_back (right, *right_entry);
+							stack.emplace_back (left, *left_entry);
+						}
+						else
+						{
+							stack.emplace_back (left, *left_entry);
+							stack.emplace_back (right, *right_entry);
+						}
+					}
+					else if (left_entry)
+						stack.emplace_back (left, *left_entry);
+					else if (right_entry)
+						stack.emplace_back (right, *right_entry);
+				}
+			}
+
+			return result;
+		}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline uint32_t
+	BoundingVolumeHierarchy<Scalar, Space>::build_node (uint32_t const begin, uint32_t const end, uint32_t const parent)
+	{
+		auto const index = static_cast<uint32_t> (_nodes.size());
+		_nodes.push_back ({ .box = _boxes[_primitives[begin]], .first = begin, .count = end - begin, .parent = parent });
+
+		auto centroids = _nodes[index].box;
+		centroids.min = centroids.max = 0.5 * (centroids.min + centroids.max);
+
+		for (auto p = begin; p < end; ++p)
+		{
+			auto const& box = _boxes[_primitives[p]];
+			auto const centroid = 0.5 * (box.min + box.max);
+			_nodes[index].box.extend (box);
+			centroids.extend ({ centroid, centroid });
+		}
+
+		if (end - begin <= kMaxLeafSize)
+		{
+			for (auto p = begin; p < end; ++p)
+				_leaf_of_primitive[_primitives[p]] = index;
+
+			return index;
+		}
+
+		// Split at the median along the longest axis of centroids:
+		auto const extent = centroids.max - centroids.min;
+		auto axis = std::size_t (0);
+
+		if (extent[1] > extent[axis])
+			axis = 1;
+
+		if (extent[2] > extent[axis])
+			axis = 2;
+
+		auto const middle = begin + (end - begin) / 2;
+
+		std::nth_element (_primitives.begin() + begin, _primitives.begin() + middle, _primitives.begin() + end, [&] (uint32_t const a, uint32_t const b) {
+			return _boxes[a].min[axis] + _boxes[a].max[axis] < _boxes[b].min[axis] + _boxes[b].max[axis];
+		});
+
+		build_node (begin, middle, index);
+		auto const right = build_node (middle, end, index);
+		// Reference obtained before recursion could be invalidated, so refer by index:
+		_nodes[index].first = right;
+		_nodes[index].count = 0;
+
+		return index;
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline void
+	BoundingVolumeHierarchy<Scalar, Space>::recompute_box (Node& node)
+	{
+		if (node.count > 0)
+		{
+			node.box = _boxes[_primitives[node.first]];
+
+			for (auto p = node.first + 1; p < node.first + node.count; ++p)
+				node.box.extend (_boxes[_primitives[p]]);
+		}
+		else
+		{
+			auto const index = static_cast<uint32_t> (&node - _nodes.data());
+			node.box = _nodes[index + 1].box;
+			node.box.extend (_nodes[node.first].box);
+		}
+	}
+
+
+template<math::Scalar Scalar, math::CoordinateSystem Space>
+	inline std::optional<double>
+	BoundingVolumeHierarchy<Scalar, Space>::ray_box_entry (std::array<double, 3> const& origin, std::array<double, 3> const& inv_direction, Box const& box)
+	{
+		auto t_min = 0.0;
+		auto t_max = std::numeric_limits<double>::infinity();
+
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			auto t1 = (box.min[i] / Scalar (1) - origin[i]) * inv_direction[i];
+			auto t2 = (box.max[i] / Scalar (1) - origin[i]) * inv_direction[i];
+
+			if (t1 > t2)
+				std::swap (t1, t2);
+
+			t_min = std::max (t_min, t1);
+			t_max = std::min (t_max, t2);
+
+			if (t_min > t_max)
+				return std::nullopt;
+		}
+
+		return t_min;
+	}
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,154 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/bounding_volume_hierarchy.h>
+#include <xefis/support/math/geometry.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+using BVH = BoundingVolumeHierarchy<si::Length, void>;
+
+
+struct Sphere
+{
+	SpaceLength<>	center;
+	si::Length		radius;
+};
+
+
+BVH::Box
+box_for (Sphere const& sphere)
+{
+	auto const r = sphere.radius;
+	auto const half_diagonal = SpaceLength<> (r, r, r);
+	return { sphere.center - half_diagonal, sphere.center + half_diagonal };
+}
+
+
+std::vector<Sphere>
+random_spheres (std::mt19937& prng, std::size_t const count)
+{
+	auto coordinate = std::uniform_real_distribution<double> (-100.0, +100.0);
+	auto radius = std::uniform_real_distribution<double> (0.5, 5.0);
+	auto spheres = std::vector<Sphere>();
+
+	for (std::size_t i = 0; i < count; ++i)
+		spheres.push_back ({ SpaceLength<> (1_m * coordinate (prng), 1_m * coordinate (prng), 1_m * coordinate (prng)), 1_m * radius (prng) });
+
+	return spheres;
+}
+
+
+/**
+ * Compare BVH results with brute-force intersection of all spheres for a number of random rays.
+ */
+void
+verify_against_brute_force (std::string const& label, BVH const& bvh, std::vector<Sphere> const& spheres, std::mt19937& prng)
+{
+	auto coordinate = std::uniform_real_distribution<double> (-150.0, +150.0);
+
+	for (std::size_t r = 0; r < 500; ++r)
+	{
+		auto const origin = SpaceLength<> (1_m * coordinate (prng), 1_m * coordinate (prng), 1_m * coordinate (prng));
+		auto const target = SpaceLength<> (1_m * coordinate (prng), 1_m * coordinate (prng), 1_m * coordinate (prng)) / 3.0;
+		auto const direction = ((target - origin) / 1_m).normalized();
+		auto const intersect = [&] (std::size_t const index) {
+			return ray_sphere_intersection (origin, direction, spheres[index].center, spheres[index].radius);
+		};
+
+		auto expected = std::optional<si::Length>();
+
+		for (std::size_t i = 0; i < spheres.size(); ++i)
+			if (auto const distance = intersect (i); distance && (!expected || *distance < *expected))
+				expected = distance;
+
+		auto const hit = bvh.intersect (origin, direction, intersect);
+
+		test_asserts::verify (label + ": hit iff brute-force hit", hit.has_value() == expected.has_value());
+
+		if (hit && expected)
+			test_asserts::verify_equal_with_epsilon (label + ": same nearest distance", hit->distance, *expected, 1e-9_m);
+	}
+}
+
+
+nu::AutoTest t1 ("Math: BoundingVolumeHierarchy finds nearest hit", []{
+	auto prng = std::mt19937 (1);
+	auto const spheres = random_spheres (prng, 1000);
+	auto boxes = std::vector<BVH::Box>();
+
+	for (auto const& sphere: spheres)
+		boxes.push_back (box_for (sphere));
+
+	auto bvh = BVH();
+	bvh.build (std::move (boxes));
+
+	test_asserts::verify ("all primitives are in the tree", bvh.size() == spheres.size());
+	verify_against_brute_force ("built", bvh, spheres, prng);
+});
+
+
+nu::AutoTest t2 ("Math: BoundingVolumeHierarchy refit after moving primitives", []{
+	auto prng = std::mt19937 (2);
+	auto spheres = random_spheres (prng, 300);
+	auto boxes = std::vector<BVH::Box>();
+
+	for (auto const& sphere: spheres)
+		boxes.push_back (box_for (sphere));
+
+	auto bvh = BVH();
+	bvh.build (std::move (boxes));
+
+	// Move every other sphere somewhere else:
+	auto const moved = random_spheres (prng, spheres.size());
+
+	for (std::size_t i = 0; i < spheres.size(); i += 2)
+	{
+		spheres[i] = moved[i];
+		bvh.update (i, box_for (spheres[i]));
+	}
+
+	bvh.refit();
+	verify_against_brute_force ("refitted", bvh, spheres, prng);
+});
+
+
+nu::AutoTest t3 ("Math: BoundingVolumeHierarchy with no primitives", []{
+	auto bvh = BVH();
+	bvh.build ({});
+
+	auto const hit = bvh.intersect (SpaceLength<> (0_m, 0_m, 0_m), SpaceVector<double> (1.0, 0.0, 0.0), [] (std::size_t) {
+		return std::optional<si::Length> (1_m);
+	});
+
+	test_asserts::verify ("no hit", !hit);
+});
+
+} // namespace
+} // namespace xf::test
@@ -27,6 +27,7 @@
 #include <cstddef>
 #include <format>
 #include <string>
+#include <string_view>
 
 
 namespace xf::nmea {
@@ -47,21 +48,27 @@ BadDateTime::BadDateTime (xf::nmea::GPSDate const& date, xf::nmea::GPSTimeOfDay
 { }
 
 
-UnsupportedSentenceType::UnsupportedSentenceType (std::string const& sentence):
-	Exception ("unsupported sentence: '" + sentence + "'")
+UnsupportedSentenceType::UnsupportedSentenceType (std::string_view const sentence):
+	Exception (std::format ("unsupported sentence: '{}'", sentence))
 { }
 
 
-GPSTimeOfDay::GPSTimeOfDay (std::string const& gps_time)
+GPSTimeOfDay::GPSTimeOfDay (std::string_view const gps_time)
 {
 	if (gps_time.size() < 6)
-		throw nu::InvalidFormat ("invalid format of GPS time-of-day: '" + gps_time + "'");
+		throw nu::InvalidFormat (std::format ("invalid format of GPS time-of-day: '{}'", gps_time));
 
 	try {
 		hours = mknum (gps_time[0], gps_time[1]);
 		minutes = mknum (gps_time[2], gps_time[3]);
 		seconds = mknum (gps_time[4], gps_time[5]);
-		seconds_fraction = nu::parse<double> (gps_time.substr (6));
+
+		if (auto const fraction = gps_time.substr (6); fraction.empty())
+			seconds_fraction = 0.0;
+		else if (auto const parsed_fraction = parse_field<double> (fraction))
+			seconds_fraction = *parsed_fraction;
+		else
+			throw nu::InvalidFormat (std::format ("invalid seconds fraction: '{}'", fraction));
 	}
 	catch (nu::InvalidFormat& e)
 	{
@@ -70,10 +77,10 @@ GPSTimeOfDay::GPSTimeOfDay (std::string const& gps_time)
 }
 
 
-GPSDate::GPSDate (std::string const& gps_date)
+GPSDate::GPSDate (std::string_view const gps_date)
 {
 	if (gps_date.size() != 6)
-		throw nu::InvalidFormat ("invalid format of GPS date: '" + gps_date + "'");
+		throw nu::InvalidFormat (std::format ("invalid format of GPS date: '{}'", gps_date));
 
 	try {
 		day = mknum (gps_date[0], gps_date[1]);
@@ -87,11 +94,20 @@ GPSDate::GPSDate (std::string const& gps_date)
 }
 
 
-GPGGA::GPGGA (std::string const& sentence):
-	Sentence (sentence)
+GPGGA::GPGGA (std::string_view const sentence)
+{
+	parse (sentence);
+}
+
+
+void
+GPGGA::parse (std::string_view const sentence)
 {
+	*this = GPGGA();
+	restart (sentence);
+
 	if (!read_next() || val() != "GPGGA")
-		throw InvalidType ("GPGGA", val());
+		throw InvalidType ("GPGGA", std::string (val()));
 
 	// Fix time (UTC):
 	if (!read_next())
@@ -127,31 +143,20 @@ GPGGA::GPGGA (std::string const& sentence):
 	if (!read_next())
 		return;
 
-	try {
-		this->tracked_satellites = nu::parse<unsigned int> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->tracked_satellites = parse_field<unsigned int> (val());
 
 	// Horizontal dilution of position:
 	if (!read_next())
 		return;
 
-	try {
-		this->hdop = nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->hdop = parse_field<float> (val());
 
 	// Altitude above mean sea level (in meters):
 	if (!read_next())
 		return;
 
-	try {
-		this->altitude_amsl = 1_m * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->altitude_amsl = 1_m * *value;
 
 	// Ensure that unit is 'M' (meters):
 	if (!read_next())
@@ -167,11 +172,8 @@ GPGGA::GPGGA (std::string const& sentence):
 	if (!read_next())
 		return;
 
-	try {
-		this->geoid_height = 1_m * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->geoid_height = 1_m * *value;
 
 	// Ensure that unit is 'M' (meters):
 	if (!read_next())
@@ -187,21 +189,14 @@ GPGGA::GPGGA (std::string const& sentence):
 	if (!read_next())
 		return;
 
-	try {
-		this->dgps_last_update_time = 1_s * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->dgps_last_update_time = 1_s * *value;
 
 	// DGPS station identifier:
 	if (!read_next())
 		return;
 
-	try {
-		this->dgps_station_id = nu::parse<std::decay_t<decltype (*this->dgps_station_id)>> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->dgps_station_id = parse_field<std::decay_t<decltype (*this->dgps_station_id)>> (val());
 }
 
 
@@ -228,11 +223,20 @@ GPGGA::reliable_fix_quality() const noexcept
 }
 
 
-GPGSA::GPGSA (std::string const& sentence):
-	Sentence (sentence)
+GPGSA::GPGSA (std::string_view const sentence)
+{
+	parse (sentence);
+}
+
+
+void
+GPGSA::parse (std::string_view const sentence)
 {
+	*this = GPGSA();
+	restart (sentence);
+
 	if (!read_next() || val() != "GPGSA")
-		throw InvalidType ("GPGSA", val());
+		throw InvalidType ("GPGSA", std::string (val()));
 
 	// Fix selection (auto/manual):
 	if (!read_next())
@@ -260,51 +264,43 @@ GPGSA::GPGSA (std::string const& sentence):
 		if (!read_next())
 			return;
 
-		try {
-			if (!val().empty())
-				this->satellites[i] = nu::parse<unsigned int> (val());
-		}
-		catch (nu::ParseException&)
-		{ }
+		this->satellites[i] = parse_field<unsigned int> (val());
 	}
 
 	// PDOP:
 	if (!read_next())
 		return;
 
-	try {
-		this->pdop = nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->pdop = parse_field<float> (val());
 
 	// HDOP:
 	if (!read_next())
 		return;
 
-	try {
-		this->hdop = nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->hdop = parse_field<float> (val());
 
 	// VDOP:
 	if (!read_next())
 		return;
 
-	try {
-		this->vdop = nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	this->vdop = parse_field<float> (val());
 }
 
 
-GPRMC::GPRMC (std::string const& sentence):
-	Sentence (sentence)
+GPRMC::GPRMC (std::string_view const sentence)
 {
+	parse (sentence);
+}
+
+
+void
+GPRMC::parse (std::string_view const sentence)
+{
+	*this = GPRMC();
+	restart (sentence);
+
 	if (!read_next() || val() != "GPRMC")
-		throw InvalidType ("GPRMC", val());
+		throw InvalidType ("GPRMC", std::string (val()));
 
 	// Fix time (UTC):
 	if (!read_next())
@@ -334,21 +330,15 @@ GPRMC::GPRMC (std::string const& sentence):
 	if (!read_next())
 		return;
 
-	try {
-		this->ground_speed = 1_kt * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->ground_speed = 1_kt * *value;
 
 	// Track angle in degrees True:
 	if (!read_next())
 		return;
 
-	try {
-		this->track_true = 1_deg * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->track_true = 1_deg * *value;
 
 	// Fix date:
 	if (!read_next())
@@ -361,11 +351,8 @@ GPRMC::GPRMC (std::string const& sentence):
 	if (!read_next())
 		return;
 
-	try {
-		this->magnetic_variation = 1_deg * nu::parse<double> (val());
-	}
-	catch (nu::ParseException&)
-	{ }
+	if (auto const value = parse_field<double> (val()))
+		this->magnetic_variation = 1_deg * *value;
 
 	// East/West:
 	if (!read_next())
@@ -375,7 +362,10 @@ GPRMC::GPRMC (std::string const& sentence):
 	}
 
 	if (val() == "W")
-		this->magnetic_variation = -1 * *this->magnetic_variation;
+	{
+		if (this->magnetic_variation)
+			this->magnetic_variation = -1 * *this->magnetic_variation;
+	}
 	else if (val() != "E")
 		this->magnetic_variation.reset();
 }
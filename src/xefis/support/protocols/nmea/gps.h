@@ -98,7 +98,7 @@ class GPSTimeOfDay
 	 *			formatted: HHMMSS.
 	 */
 	explicit
-	GPSTimeOfDay (std::string const& gps_time);
+	GPSTimeOfDay (std::string_view gps_time);
 
   public:
 	uint8_t		hours;
@@ -121,7 +121,7 @@ class GPSDate
 	 *			formatted: DDMMYY.
 	 */
 	explicit
-	GPSDate (std::string const& gps_date);
+	GPSDate (std::string_view gps_date);
 
   public:
 	uint8_t		day;
@@ -142,7 +142,19 @@ class GPGGA: public Sentence
 	 * \throws	InvalidType if message header isn't 'GPGGA'.
 	 */
 	explicit
-	GPGGA (std::string const&);
+	GPGGA (std::string_view);
+
+	// Ctor
+	GPGGA() = default;
+
+	/**
+	 * Reset all fields and parse new NMEA sentence between '$' and '*' in place.
+	 * Doesn't allocate memory, so preallocated objects can be reused for each
+	 * received sentence.
+	 * \throws	InvalidType if message header isn't 'GPGGA'.
+	 */
+	void
+	parse (std::string_view);
 
   public:
 	// UTC time when fix was obtained:
@@ -205,7 +217,19 @@ class GPGSA: public Sentence
 	 * \throws	InvalidType if message header isn't 'GPGSA'.
 	 */
 	explicit
-	GPGSA (std::string const&);
+	GPGSA (std::string_view);
+
+	// Ctor
+	GPGSA() = default;
+
+	/**
+	 * Reset all fields and parse new NMEA sentence between '$' and '*' in place.
+	 * Doesn't allocate memory, so preallocated objects can be reused for each
+	 * received sentence.
+	 * \throws	InvalidType if message header isn't 'GPGSA'.
+	 */
+	void
+	parse (std::string_view);
 
   public:
 	// Fix mode:
@@ -240,7 +264,19 @@ class GPRMC: public Sentence
 	 * \throws	InvalidType if message header isn't 'GPRMC'.
 	 */
 	explicit
-	GPRMC (std::string const&);
+	GPRMC (std::string_view);
+
+	// Ctor
+	GPRMC() = default;
+
+	/**
+	 * Reset all fields and parse new NMEA sentence between '$' and '*' in place.
+	 * Doesn't allocate memory, so preallocated objects can be reused for each
+	 * received sentence.
+	 * \throws	InvalidType if message header isn't 'GPRMC'.
+	 */
+	void
+	parse (std::string_view);
 
   public:
 	// UTC time when fix was obtained:
@@ -21,16 +21,29 @@
 
 // Standard:
 #include <cstddef>
+#include <format>
+#include <functional>
+#include <map>
 #include <string>
+#include <string_view>
 
 
 namespace xf::nmea {
 
-PMTKACK::PMTKACK (std::string const& sentence):
-	Sentence (sentence)
+PMTKACK::PMTKACK (std::string_view const sentence)
 {
+	parse (sentence);
+}
+
+
+void
+PMTKACK::parse (std::string_view const sentence)
+{
+	*this = PMTKACK();
+	restart (sentence);
+
 	if (!read_next() || val() != "PMTK001")
-		throw InvalidType ("PMTK001", val());
+		throw InvalidType ("PMTK001", std::string (val()));
 
 	// Command info:
 	if (!read_next())
@@ -54,9 +67,9 @@ PMTKACK::PMTKACK (std::string const& sentence):
 
 
 std::string
-describe_mtk_command_by_id (std::string command)
+describe_mtk_command_by_id (std::string_view const command)
 {
-	static std::map<std::string, std::string> const hints {
+	static std::map<std::string, std::string, std::less<>> const hints {
 		{ "101", "hot start" },
 		{ "102", "warm start" },
 		{ "103", "cold start" },
@@ -80,9 +93,9 @@ describe_mtk_command_by_id (std::string command)
 
 
 std::string
-make_mtk_sentence (std::string const& data)
+make_mtk_sentence (std::string_view const data)
 {
-	return "$" + data + "*" + make_checksum (data) + "\r\n";
+	return std::format ("${}*{}\r\n", data, make_checksum (data));
 }
 
 } // namespace xf::nmea
@@ -20,6 +20,11 @@
 // Xefis:
 #include <xefis/config/all.h>
 
+// Standard:
+#include <cstddef>
+#include <string>
+#include <string_view>
+
 
 namespace xf::nmea {
 
@@ -44,14 +49,25 @@ class PMTKACK: public Sentence
 	 * \throws	InvalidType if message header isn't 'PMTK001'.
 	 */
 	explicit
-	PMTKACK (std::string const&);
+	PMTKACK (std::string_view);
+
+	// Ctor
+	PMTKACK() = default;
+
+	/**
+	 * Reset all fields and parse new PMTK ACK message in place.
+	 * \throws	InvalidType if message header isn't 'PMTK001'.
+	 */
+	void
+	parse (std::string_view);
 
   public:
-	// Command to which this ACK responds to:
-	std::optional<std::string>	command;
+	// Command to which this ACK responds to. Refers to the parsed string,
+	// just like contents():
+	std::optional<std::string_view>	command;
 
 	// Result:
-	std::optional<MTKResult>	result;
+	std::optional<MTKResult>		result;
 };
 
 
@@ -60,7 +76,7 @@ class PMTKACK: public Sentence
  * Command must be of form "PMTKnnn".
  */
 extern std::string
-describe_mtk_command_by_id (std::string command);
+describe_mtk_command_by_id (std::string_view command);
 
 
 /**
@@ -68,7 +84,7 @@ describe_mtk_command_by_id (std::string command);
  * where nnn is message ID.
  */
 extern std::string
-make_mtk_sentence (std::string const& data);
+make_mtk_sentence (std::string_view data);
 
 } // namespace xf::nmea
 
@@ -23,43 +23,48 @@
 #include <neutrino/stdexcept.h>
 
 // Standard:
+#include <cctype>
 #include <cstddef>
 #include <format>
 #include <string>
+#include <string_view>
 
 
 namespace xf::nmea {
 
-Sentence::Sentence (std::string const& sentence)
+Sentence::Sentence (std::string_view const sentence):
+	_sentence (sentence)
+{ }
+
+
+void
+Sentence::restart (std::string_view const sentence) noexcept
 {
-	// Copy sentence last, when passed all tests:
 	_sentence = sentence;
+	_val = {};
+	_pos = 0;
 }
 
 
 bool
-Sentence::read_next()
+Sentence::read_next() noexcept
 {
-	if (_pos == std::string::npos)
+	if (_pos == std::string_view::npos)
 	{
-		_val.clear();
+		_val = {};
 		return false;
 	}
 
-	auto start_pos = _pos;
-
-	std::string::size_type comma = _sentence.find (',', start_pos);
+	auto const comma = _sentence.find (',', _pos);
 
-	if (comma == std::string::npos)
+	if (comma == std::string_view::npos)
 	{
-		_val.resize (_sentence.size() - start_pos);
-		std::copy (_sentence.begin() + nu::to_signed (start_pos), _sentence.end(), _val.begin());
-		_pos = std::string::npos;
+		_val = _sentence.substr (_pos);
+		_pos = std::string_view::npos;
 	}
 	else
 	{
-		_val.resize (comma - start_pos);
-		std::copy (_sentence.begin() + nu::to_signed (start_pos), _sentence.begin() + nu::to_signed (comma), _val.begin());
+		_val = _sentence.substr (_pos, comma - _pos);
 		_pos = comma + 1;
 	}
 
@@ -73,15 +78,13 @@ Sentence::read_latitude (std::optional<si::Angle>& latitude)
 	if (!read_next())
 		return false;
 
-	if (val().size() >= 3)
+	if (val().size() >= 3 && std::isdigit (val()[0]) && std::isdigit (val()[1]))
 	{
 		auto lat = 1_deg * (nu::digit_from_ascii (val()[0]) * 10 +
 							nu::digit_from_ascii (val()[1]));
-		try {
-			latitude = lat + 1_deg * nu::parse<double> (val().substr (2)) / 60.0;
-		}
-		catch (nu::ParseException&)
-		{ }
+
+		if (auto const minutes = parse_field<double> (val().substr (2)))
+			latitude = lat + 1_deg * *minutes / 60.0;
 	}
 
 	// North/South:
@@ -92,7 +95,10 @@ Sentence::read_latitude (std::optional<si::Angle>& latitude)
 	}
 
 	if (val() == "S")
-		latitude = -1 * *latitude;
+	{
+		if (latitude)
+			latitude = -1 * *latitude;
+	}
 	else if (val() != "N")
 		latitude.reset();
 
@@ -106,16 +112,14 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 	if (!read_next())
 		return false;
 
-	if (val().size() >= 4)
+	if (val().size() >= 4 && std::isdigit (val()[0]) && std::isdigit (val()[1]) && std::isdigit (val()[2]))
 	{
 		auto lon = 1_deg * (nu::digit_from_ascii (val()[0]) * 100 +
 							nu::digit_from_ascii (val()[1]) * 10 +
 							nu::digit_from_ascii (val()[2]));
-		try {
-			longitude = lon + 1_deg * nu::parse<double> (val().substr (3)) / 60.0;
-		}
-		catch (nu::ParseException&)
-		{ }
+
+		if (auto const minutes = parse_field<double> (val().substr (3)))
+			longitude = lon + 1_deg * *minutes / 60.0;
 	}
 
 	// East/West:
@@ -126,7 +130,10 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 	}
 
 	if (val() == "W")
-		longitude = -1 * *longitude;
+	{
+		if (longitude)
+			longitude = -1 * *longitude;
+	}
 	else if (val() != "E")
 		longitude.reset();
 
@@ -135,7 +142,7 @@ Sentence::read_longitude (std::optional<si::Angle>& longitude)
 
 
 std::string
-make_checksum (std::string const& data)
+make_checksum (std::string_view const data)
 {
 	uint8_t sum = 0;
 	for (auto c: data)
@@ -144,17 +151,30 @@ make_checksum (std::string const& data)
 }
 
 
-SentenceType
-get_sentence_type (std::string const& sentence)
+std::optional<SentenceType>
+find_sentence_type (std::string_view sentence) noexcept
 {
-	if (sentence.compare (0, 7, "$GPGGA,") == 0)
+	if (sentence.starts_with ('$'))
+		sentence.remove_prefix (1);
+
+	if (sentence.starts_with ("GPGGA,"))
 		return SentenceType::GPGGA;
-	else if (sentence.compare (0, 7, "$GPGSA,") == 0)
+	else if (sentence.starts_with ("GPGSA,"))
 		return SentenceType::GPGSA;
-	else if (sentence.compare (0, 7, "$GPRMC,") == 0)
+	else if (sentence.starts_with ("GPRMC,"))
 		return SentenceType::GPRMC;
-	else if (sentence.compare (0, 9, "$PMTK001,") == 0)
+	else if (sentence.starts_with ("PMTK001,"))
 		return SentenceType::PMTKACK;
+	else
+		return std::nullopt;
+}
+
+
+SentenceType
+get_sentence_type (std::string_view const sentence)
+{
+	if (auto const type = find_sentence_type (sentence))
+		return *type;
 	else
 		throw UnsupportedSentenceType (sentence);
 }
@@ -18,8 +18,11 @@
 #include <xefis/config/all.h>
 
 // Standard:
+#include <charconv>
 #include <cstddef>
+#include <optional>
 #include <string>
+#include <string_view>
 
 
 namespace xf::nmea {
@@ -31,7 +34,7 @@ class UnsupportedSentenceType: public nu::Exception
 {
   public:
 	explicit
-	UnsupportedSentenceType (std::string const& sentence);
+	UnsupportedSentenceType (std::string_view const sentence);
 };
 
 
@@ -53,22 +56,33 @@ enum class SentenceType
 class Sentence
 {
   protected:
+	// Ctor
+	Sentence() = default;
+
 	/**
 	 * Ctor
 	 * \param	sentence
 	 *			String between the '$' and '*'.
 	 */
 	explicit
-	Sentence (std::string const&);
+	Sentence (std::string_view sentence);
 
   public:
 	/**
 	 * Return sentence contents (without prolog and checksum).
+	 * The view refers to the string the sentence was parsed from, so
+	 * it's valid only as long as that string.
 	 */
-	std::string const&
+	std::string_view
 	contents() const noexcept;
 
   protected:
+	/**
+	 * Start reading fields from the beginning of the new sentence.
+	 */
+	void
+	restart (std::string_view sentence) noexcept;
+
 	/**
 	 * Get next substring up to next comma or end of string.
 	 * The string is avaiable through val() method.
@@ -77,12 +91,12 @@ class Sentence
 	 *			previous call to this method.
 	 */
 	bool
-	read_next();
+	read_next() noexcept;
 
 	/**
 	 * \return	substring extraced with read_to_comma().
 	 */
-	std::string const&
+	std::string_view
 	val() const noexcept;
 
 	/**
@@ -104,26 +118,45 @@ class Sentence
 	read_longitude (std::optional<si::Angle>& out_longitude);
 
   private:
-	std::string				_sentence;
-	std::string				_val;
-	std::string::size_type	_pos	= 0;
+	std::string_view			_sentence;
+	std::string_view			_val;
+	std::string_view::size_type	_pos	= 0;
 };
 
 
-inline std::string const&
+inline std::string_view
 Sentence::contents() const noexcept
 {
 	return _sentence;
 }
 
 
-inline std::string const&
+inline std::string_view
 Sentence::val() const noexcept
 {
 	return _val;
 }
 
 
+/**
+ * Parse a numeric NMEA field. Return std::nullopt if the field is empty
+ * or isn't a valid number.
+ */
+template<class Value>
+	inline std::optional<Value>
+	parse_field (std::string_view const field) noexcept
+	{
+		Value value {};
+		auto const* const end = field.data() + field.size();
+		auto const result = std::from_chars (field.data(), end, value);
+
+		if (result.ec == std::errc() && result.ptr == end && !field.empty())
+			return value;
+		else
+			return std::nullopt;
+	}
+
+
 /**
  * Make NMEA checksum from the input string.
  * \param	data
@@ -131,15 +164,25 @@ Sentence::val() const noexcept
  * \return	two-character checksum (do not include '*').
  */
 extern std::string
-make_checksum (std::string const& data);
+make_checksum (std::string_view const data);
+
+
+/**
+ * Parse header of the sentence and return sentence type
+ * or std::nullopt if the type is not supported.
+ * String may include the first '$' character of NMEA sentence.
+ */
+extern std::optional<SentenceType>
+find_sentence_type (std::string_view sentence) noexcept;
 
 
 /**
  * Parse header of the sentence and return sentence type.
  * String may include the first '$' character of NMEA sentence.
+ * \throws	UnsupportedSentenceType if the type is not supported.
  */
 extern SentenceType
-get_sentence_type (std::string const& sentence);
+get_sentence_type (std::string_view const sentence);
 
 } // namespace xf::nmea
 
@@ -19,11 +19,10 @@
 #include <xefis/config/all.h>
 #include <xefis/utility/hextable.h>
 
-// Neutrino:
-#include <neutrino/scope_exit.h>
-
 // Standard:
+#include <cctype>
 #include <cstddef>
+#include <string_view>
 
 
 namespace xf::nmea {
@@ -35,112 +34,137 @@ static HexTable	hextable;
 } // namespace global
 
 
-void
-Parser::feed (Blob const& data)
+Parser::Result
+Parser::process_next (BlobView& input)
 {
-	_input_buffer.append_range (data);
-}
+	while (!input.empty())
+	{
+		auto const c = static_cast<char> (input.front());
+		input.remove_prefix (1);
 
+		// '$' always starts a new sentence:
+		if (c == '$')
+		{
+			auto const was_interrupted = _state != State::WaitForStart;
 
-std::variant<std::monostate, GPGGA, GPGSA, GPRMC, PMTKACK>
-Parser::process_next()
-{
-	// Skip cut-in-half messages, wait for '$' if not yet synchronized:
-	if (!_synchronized)
-	{
-		auto pos = _input_buffer.find ("$");
+			_state = State::Contents;
+			_sentence_size = 0;
+			_computed_checksum = 0;
+			_received_checksum = 0;
+			_checksum_digits = 0;
 
-		if (pos == std::string::npos)
-			return std::monostate();
-		else
+			if (was_interrupted)
+				throw nmea::InvalidSentence ("NMEA sentence interrupted by another '$'");
+
+			continue;
+		}
+
+		switch (_state)
 		{
-			_input_buffer.erase (0, pos);
-			_synchronized = true;
+			case State::WaitForStart:
+				// Skip cut-in-half messages, wait for '$':
+				break;
+
+			case State::Contents:
+				if (c == '*')
+					_state = State::Checksum;
+				else if (c == '\r')
+					_state = State::LF;
+				else if (c == '\n')
+				{
+					if (auto result = finish_sentence(); !std::holds_alternative<std::monostate> (result))
+						return result;
+				}
+				else if (_sentence_size < _sentence.size())
+				{
+					_sentence[_sentence_size++] = c;
+					_computed_checksum ^= static_cast<uint8_t> (c);
+				}
+				else
+				{
+					reset();
+					throw nmea::InvalidSentence ("NMEA sentence too long");
+				}
+				break;
+
+			case State::Checksum:
+				if (!std::isxdigit (static_cast<unsigned char> (c)))
+				{
+					reset();
+					throw nmea::InvalidSentence ("checksum characters are not valid hex digits");
+				}
+
+				_received_checksum = _received_checksum * 16 + global::hextable[c];
+
+				if (++_checksum_digits == 2)
+					_state = State::CR;
+				break;
+
+			case State::CR:
+			case State::LF:
+				if (c == '\r' && _state == State::CR)
+					_state = State::LF;
+				else if (c == '\n')
+				{
+					if (auto result = finish_sentence(); !std::holds_alternative<std::monostate> (result))
+						return result;
+				}
+				else
+				{
+					reset();
+					throw nmea::InvalidSentence ("NMEA sentence not terminated with CR LF");
+				}
+				break;
 		}
 	}
 
-	// Process all sentences terminated with "\r\n".
-	constexpr std::string::size_type start = 0;
-	std::string::size_type crlf = 0;
-	std::string::size_type parsed = 0;
+	return std::monostate();
+}
 
-	// Make sure to remove parsed data from the input buffer:
-	nu::ScopeExit remove_parsed_sockets ([&]{
-		_input_buffer.erase (0, parsed);
-	});
 
-	crlf = _input_buffer.find ("\r\n", start);
+void
+Parser::reset() noexcept
+{
+	_state = State::WaitForStart;
+	_sentence_size = 0;
+}
 
-	if (crlf == std::string::npos)
-		return std::monostate();
 
-	parsed = crlf + 2;
+Parser::Result
+Parser::finish_sentence()
+{
+	auto const had_checksum = _checksum_digits > 0;
+	auto const contents = std::string_view (_sentence.data(), _sentence_size);
 
-	std::string sentence_str = _input_buffer.substr (start, crlf - start);
-	verify_sentence (sentence_str);
+	reset();
 
-	// Extract sentence contents (strip '$' and checksum).
-	std::string sentence_meat;
-	// Check if we have checksum (this assumes that normal messages never contain
-	// an asterisk and it's a reserved character):
-	if (sentence_str[sentence_str.size() - 3] == '*')
-		sentence_meat = sentence_str.substr (1, sentence_str.size() - 4);
-	else
-		sentence_meat = sentence_str.substr (1);
+	if (had_checksum && _received_checksum != _computed_checksum)
+		throw nmea::InvalidChecksum (_computed_checksum, _received_checksum);
 
-	try {
-		switch (get_sentence_type (sentence_str))
+	if (auto const type = find_sentence_type (contents))
+	{
+		switch (*type)
 		{
 			case SentenceType::GPGGA:
-				return GPGGA (sentence_meat);
+				_gpgga.parse (contents);
+				return &_gpgga;
 
 			case SentenceType::GPGSA:
-				return GPGSA (sentence_meat);
+				_gpgsa.parse (contents);
+				return &_gpgsa;
 
 			case SentenceType::GPRMC:
-				return GPRMC (sentence_meat);
+				_gprmc.parse (contents);
+				return &_gprmc;
 
 			case SentenceType::PMTKACK:
-				return PMTKACK (sentence_meat);
+				_pmtkack.parse (contents);
+				return &_pmtkack;
 		}
 	}
-	catch (UnsupportedSentenceType const&)
-	{
-		// Ignore unsupported sentences.
-	}
 
+	// Ignore unsupported sentences.
 	return std::monostate();
 }
 
-
-void
-Parser::verify_sentence (std::string const& sentence)
-{
-	// Verify checksum:
-	if (sentence.size() < 5)
-		throw nmea::InvalidSentence ("NMEA sentence too short");
-
-	// Prologue:
-	if (sentence[0] != '$')
-		throw nmea::InvalidSentence ("NMEA sentence should start with '$'");
-
-	// Parse checksum if present:
-	if (sentence[sentence.size() - 3] == '*')
-	{
-		char c1 = sentence[sentence.size() - 2];
-		char c2 = sentence[sentence.size() - 1];
-		if (!std::isxdigit (c1) || !std::isxdigit (c2))
-			throw nmea::InvalidSentence ("checksum characters are not valid hex digits");
-		uint8_t parsed_checksum = global::hextable[c1] * 16 + global::hextable[c2];
-
-		// Verify checksum:
-		uint8_t expected_checksum = 0;
-		for (auto c = sentence.begin() + 1; c != sentence.end() - 3; ++c)
-			expected_checksum ^= static_cast<uint8_t> (*c);
-
-		if (expected_checksum != parsed_checksum)
-			throw nmea::InvalidChecksum (expected_checksum, parsed_checksum);
-	}
-}
-
 } // namespace xf::nmea
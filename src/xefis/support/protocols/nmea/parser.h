@@ -26,7 +26,9 @@
 #include <neutrino/noncopyable.h>
 
 // Standard:
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <variant>
 
 
@@ -34,37 +36,73 @@ namespace xf::nmea {
 
 /**
  * Parser for NMEA protocol for GPS devices.
+ *
+ * Streaming state machine: bytes are consumed as they arrive, checksum is
+ * computed on the fly and complete sentences are decoded into preallocated
+ * sentence objects, so that no memory is allocated during normal operation.
  */
 class Parser: private nu::Noncopyable
 {
+  public:
+	// Maximum number of characters between '$' and '*'. Standard sentences are
+	// limited to 82 characters including "$" and "\r\n":
+	static constexpr std::size_t kMaxSentenceSize = 128;
+
+	using Result = std::variant<std::monostate, GPGGA const*, GPGSA const*, GPRMC const*, PMTKACK const*>;
+
   public:
 	/**
-	 * Feed the parser with data received from GPS module.
-	 * Don't parse it and don't call any listeners. For that,
-	 * use the process_one() method.
+	 * Consume bytes from the front of the input until a complete supported
+	 * sentence is decoded or the input is exhausted. Consumed bytes are removed
+	 * from the input view. Partial sentences are kept by the parser until more
+	 * data is available.
+	 *
+	 * Returned pointers refer to sentence objects owned by the parser and are valid
+	 * until the next call.
+	 *
+	 * \throws	InvalidSentence, InvalidChecksum or any exception thrown by
+	 *			sentence parsers. Offending sentence is dropped and the call can
+	 *			be repeated to process the rest of the input.
+	 * \return	std::monostate if input has been exhausted.
 	 */
-	void
-	feed (Blob const& gps_data);
+	Result
+	process_next (BlobView& input);
 
 	/**
-	 * Parse single sentence from the input buffer.
-	 * \throws	Any exception thrown by sentence constructor.
-	 * \return	True if there was any sentence processed.
+	 * Drop any partially received sentence and wait for the next '$'.
 	 */
-	std::variant<std::monostate, GPGGA, GPGSA, GPRMC, PMTKACK>
-	process_next();
+	void
+	reset() noexcept;
 
-  public:
+  private:
+	enum class State
+	{
+		WaitForStart,	// Waiting for '$'
+		Contents,		// Between '$' and '*'
+		Checksum,		// Hex digits after '*'
+		CR,				// Expecting "\r\n" after the checksum
+		LF,				// Expecting "\n"
+	};
+
+  private:
 	/**
-	 * Verify that NMEA sentence is valid and has proper checksum.
-	 * \throws	NMEA exceptions: InvalidType, InvalidChecksum, InvalidMessage.
+	 * Verify checksum and decode the sentence collected in _sentence.
+	 * Return std::monostate for unsupported sentence types.
 	 */
-	void
-	verify_sentence (std::string const& sentence);
+	Result
+	finish_sentence();
 
   private:
-	std::string		_input_buffer;
-	bool			_synchronized	= false;
+	State								_state				{ State::WaitForStart };
+	std::array<char, kMaxSentenceSize>	_sentence;
+	std::size_t							_sentence_size		{ 0 };
+	uint8_t								_computed_checksum	{ 0 };
+	uint8_t								_received_checksum	{ 0 };
+	uint8_t								_checksum_digits	{ 0 };
+	GPGGA								_gpgga;
+	GPGSA								_gpgsa;
+	GPRMC								_gprmc;
+	PMTKACK								_pmtkack;
 };
 
 } // namespace xf::nmea
@@ -0,0 +1,145 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/protocols/nmea/exceptions.h>
+#include <xefis/support/protocols/nmea/parser.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <variant>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+constexpr std::string_view kGPGGA = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+constexpr std::string_view kGPGSA = "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n";
+constexpr std::string_view kGPRMC = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+constexpr std::string_view kGPGSV = "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n";
+constexpr std::string_view kPMTKACK = "$PMTK001,220,3*30\r\n";
+
+
+BlobView
+as_blob (std::string_view const string)
+{
+	return BlobView (reinterpret_cast<uint8_t const*> (string.data()), string.size());
+}
+
+
+nu::AutoTest t_1 ("NMEA parser: sentences fed byte by byte", []{
+	auto const stream = std::string ("garbage") + std::string (kGPGGA) + std::string (kGPGSV) + std::string (kGPGSA) + std::string (kGPRMC) + std::string (kPMTKACK);
+	auto const data = as_blob (stream);
+	nmea::Parser parser;
+	std::size_t gga = 0, gsa = 0, rmc = 0, ack = 0;
+
+	for (std::size_t i = 0; i < data.size(); ++i)
+	{
+		auto input = data.substr (i, 1);
+
+		while (true)
+		{
+			auto const result = parser.process_next (input);
+
+			if (auto const* gga_ptr = std::get_if<nmea::GPGGA const*> (&result))
+			{
+				auto const& sentence = **gga_ptr;
+				++gga;
+				test_asserts::verify ("GGA: fix time", sentence.fix_time && sentence.fix_time->hours == 12 && sentence.fix_time->minutes == 35 && sentence.fix_time->seconds == 19);
+				test_asserts::verify_equal_with_epsilon ("GGA: latitude", sentence.latitude.value_or (0_deg), 48_deg + 7.038_deg / 60.0, 1e-9_deg);
+				test_asserts::verify_equal_with_epsilon ("GGA: longitude", sentence.longitude.value_or (0_deg), 11_deg + 31_deg / 60.0, 1e-9_deg);
+				test_asserts::verify ("GGA: fix quality", sentence.fix_quality == nmea::GPSFixQuality::GPS);
+				test_asserts::verify ("GGA: tracked satellites", sentence.tracked_satellites == 8u);
+				test_asserts::verify_equal_with_epsilon ("GGA: altitude", sentence.altitude_amsl.value_or (0_m), 545.4_m, 1e-9_m);
+				test_asserts::verify ("GGA: no DGPS station", !sentence.dgps_station_id);
+			}
+			else if (auto const* gsa_ptr = std::get_if<nmea::GPGSA const*> (&result))
+			{
+				auto const& sentence = **gsa_ptr;
+				++gsa;
+				test_asserts::verify ("GSA: 3D fix", sentence.fix_mode == nmea::GPSFixMode::Fix3D);
+				test_asserts::verify ("GSA: satellites", sentence.satellites[0] == 4u && !sentence.satellites[2] && sentence.satellites[7] == 24u);
+				test_asserts::verify ("GSA: VDOP", sentence.vdop && std::abs (*sentence.vdop - 2.1f) < 1e-6f);
+			}
+			else if (auto const* rmc_ptr = std::get_if<nmea::GPRMC const*> (&result))
+			{
+				auto const& sentence = **rmc_ptr;
+				++rmc;
+				test_asserts::verify ("RMC: date", sentence.fix_date && sentence.fix_date->year == 2094 && sentence.fix_date->month == 3 && sentence.fix_date->day == 23);
+				test_asserts::verify_equal_with_epsilon ("RMC: ground speed", sentence.ground_speed.value_or (0_kt), 22.4_kt, 1e-9_kt);
+				test_asserts::verify_equal_with_epsilon ("RMC: magnetic variation", sentence.magnetic_variation.value_or (0_deg), -3.1_deg, 1e-9_deg);
+			}
+			else if (auto const* ack_ptr = std::get_if<nmea::PMTKACK const*> (&result))
+			{
+				auto const& sentence = **ack_ptr;
+				++ack;
+				test_asserts::verify ("ACK: command", sentence.command == "220");
+				test_asserts::verify ("ACK: result", sentence.result == nmea::MTKResult::Success);
+			}
+			else
+				break;
+		}
+	}
+
+	test_asserts::verify_equal ("GGA decoded once", gga, std::size_t (1));
+	test_asserts::verify_equal ("GSA decoded once", gsa, std::size_t (1));
+	test_asserts::verify_equal ("RMC decoded once", rmc, std::size_t (1));
+	test_asserts::verify_equal ("ACK decoded once", ack, std::size_t (1));
+});
+
+
+nu::AutoTest t_2 ("NMEA parser: recovers after broken sentences", []{
+	auto broken_checksum = std::string (kGPGGA);
+	broken_checksum[broken_checksum.size() - 3] = '0';
+	auto const truncated = kGPGSA.substr (0, 20);
+
+	auto const stream = broken_checksum + std::string (truncated) + std::string (kGPRMC) + std::string (kGPGSA);
+	auto input = as_blob (stream);
+	nmea::Parser parser;
+
+	test_asserts::verify_throws<nmea::InvalidChecksum> ("invalid checksum is detected", [&]{
+		parser.process_next (input);
+	});
+
+	test_asserts::verify_throws<nmea::InvalidSentence> ("truncated sentence is detected", [&]{
+		parser.process_next (input);
+	});
+
+	test_asserts::verify ("next sentence is decoded", std::holds_alternative<nmea::GPRMC const*> (parser.process_next (input)));
+	test_asserts::verify ("sentence after it is decoded", std::holds_alternative<nmea::GPGSA const*> (parser.process_next (input)));
+	test_asserts::verify ("input is consumed", input.empty() && std::holds_alternative<std::monostate> (parser.process_next (input)));
+});
+
+
+nu::AutoTest t_3 ("NMEA parser: too long sentence", []{
+	auto const stream = "$" + std::string (nmea::Parser::kMaxSentenceSize + 1, 'A') + "\r\n" + std::string (kPMTKACK);
+	auto input = as_blob (stream);
+	nmea::Parser parser;
+
+	test_asserts::verify_throws<nmea::InvalidSentence> ("too long sentence is rejected", [&]{
+		parser.process_next (input);
+	});
+
+	test_asserts::verify ("parser resynchronizes", std::holds_alternative<nmea::PMTKACK const*> (parser.process_next (input)));
+});
+
+} // namespace
+} // namespace xf::test
@@ -0,0 +1,58 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "shape_bvh.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/geometry.h>
+
+// Standard:
+#include <cstddef>
+
+
+namespace xf {
+
+ShapeBVH::ShapeBVH (Shape const& shape)
+{
+	using Box = decltype (_bvh)::Box;
+
+	std::vector<Box> boxes;
+
+	shape.for_each_triangle ([&] (ShapeVertex const& a, ShapeVertex const& b, ShapeVertex const& c) {
+		auto& triangle = _triangles.emplace_back (std::array { a.position(), b.position(), c.position() });
+		auto& box = boxes.emplace_back (triangle[0], triangle[0]);
+		box.extend ({ triangle[1], triangle[1] });
+		box.extend ({ triangle[2], triangle[2] });
+	});
+
+	_bvh.build (std::move (boxes));
+}
+
+
+std::optional<si::Length>
+ShapeBVH::ray_intersection (SpaceLength<BodyOrigin> const& ray_origin, SpaceVector<double, BodyOrigin> const& ray_direction) const
+{
+	auto const hit = _bvh.intersect (ray_origin, ray_direction, [&] (std::size_t const index) {
+		auto const& triangle = _triangles[index];
+		return ray_triangle_intersection (ray_origin, ray_direction, triangle[0], triangle[1], triangle[2]);
+	});
+
+	if (hit)
+		return hit->distance;
+	else
+		return std::nullopt;
+}
+
+} // namespace xf
@@ -0,0 +1,67 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__SHAPES__SHAPE_BVH_H__INCLUDED
+#define XEFIS__SUPPORT__SHAPES__SHAPE_BVH_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/math/bounding_volume_hierarchy.h>
+#include <xefis/support/shapes/shape.h>
+
+// Standard:
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+namespace xf {
+
+/**
+ * Bounding-volume hierarchy over triangles of a Shape, in body-origin space.
+ * Makes ray/shape intersections logarithmic in the number of triangles.
+ * It copies triangle positions, so it stays valid even if the Shape is destroyed,
+ * but obviously it doesn't follow later changes of the Shape.
+ */
+class ShapeBVH
+{
+  public:
+	// Ctor
+	explicit
+	ShapeBVH (Shape const&);
+
+	/**
+	 * Return number of triangles.
+	 */
+	[[nodiscard]]
+	std::size_t
+	size() const noexcept
+		{ return _triangles.size(); }
+
+	/**
+	 * Intersect the ray with shape triangles and return nearest positive hit distance.
+	 * Gives the same result as ray_shape_intersection().
+	 */
+	[[nodiscard]]
+	std::optional<si::Length>
+	ray_intersection (SpaceLength<BodyOrigin> const& ray_origin, SpaceVector<double, BodyOrigin> const& ray_direction) const;
+
+  private:
+	std::vector<std::array<SpaceLength<BodyOrigin>, 3>>	_triangles;
+	BoundingVolumeHierarchy<si::Length, BodyOrigin>		_bvh;
+};
+
+} // namespace xf
+
+#endif
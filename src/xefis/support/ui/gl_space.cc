@@ -17,15 +17,120 @@
 // Xefis:
 #include <xefis/config/all.h>
 
+// Qt:
+#include <QOpenGLContext>
+
 // System:
 #include <GL/glext.h>
 
 // Standard:
+#include <algorithm>
 #include <cstddef>
 #include <optional>
+#include <utility>
 
 
 namespace xf {
+namespace {
+
+[[nodiscard]]
+bool
+same_color (GLColor const& a, GLColor const& b)
+{
+	for (std::size_t i = 0; i < 4; ++i)
+		if (a[i] != b[i])
+			return false;
+
+	return true;
+}
+
+
+/**
+ * Return true if both materials result in the same glMaterial() calls,
+ * not counting the emission color (which is passed in a vertex attribute).
+ */
+[[nodiscard]]
+bool
+same_lighting (ShapeMaterial const& a, ShapeMaterial const& b, bool const textured)
+{
+	if (textured)
+		return same_color (a.gl_texture_color, b.gl_texture_color);
+	else
+	{
+		return same_color (a.gl_ambient_color, b.gl_ambient_color)
+			&& same_color (a.gl_diffuse_color, b.gl_diffuse_color)
+			&& same_color (a.gl_specular_color, b.gl_specular_color)
+			&& a.gl_shininess == b.gl_shininess;
+	}
+}
+
+
+void
+delete_buffer (GLuint& buffer)
+{
+	// Deleting requires current context. Without it the buffer is released along with the context:
+	if (buffer != 0 && QOpenGLContext::currentContext())
+		glDeleteBuffers (1, &buffer);
+
+	buffer = 0;
+}
+
+} // namespace
+
+
+GLSpace::RetainedShape::RetainedShape (RetainedShape&& other) noexcept:
+	_shape (std::exchange (other._shape, nullptr)),
+	_buffer (std::exchange (other._buffer, 0)),
+	_arrays (std::move (other._arrays))
+{ }
+
+
+GLSpace::RetainedShape::~RetainedShape()
+{
+	delete_buffer (_buffer);
+}
+
+
+GLSpace::RetainedShape&
+GLSpace::RetainedShape::operator= (RetainedShape&& other) noexcept
+{
+	if (this != &other)
+	{
+		delete_buffer (_buffer);
+		_shape = std::exchange (other._shape, nullptr);
+		_buffer = std::exchange (other._buffer, 0);
+		_arrays = std::move (other._arrays);
+	}
+
+	return *this;
+}
+
+
+GLSpace::RetainedPoints::RetainedPoints (RetainedPoints&& other) noexcept:
+	_buffer (std::exchange (other._buffer, 0)),
+	_count (std::exchange (other._count, 0))
+{ }
+
+
+GLSpace::RetainedPoints::~RetainedPoints()
+{
+	delete_buffer (_buffer);
+}
+
+
+GLSpace::RetainedPoints&
+GLSpace::RetainedPoints::operator= (RetainedPoints&& other) noexcept
+{
+	if (this != &other)
+	{
+		delete_buffer (_buffer);
+		_buffer = std::exchange (other._buffer, 0);
+		_count = std::exchange (other._count, 0);
+	}
+
+	return *this;
+}
+
 
 GLSpace::GLSpace (decltype (1 / 1_m) position_scale):
 	_position_scale (position_scale)
@@ -34,6 +139,12 @@ GLSpace::GLSpace (decltype (1 / 1_m) position_scale):
 }
 
 
+GLSpace::~GLSpace()
+{
+	delete_buffer (_streaming_buffer);
+}
+
+
 void
 GLSpace::set_hfov_perspective (QSize const size, si::Angle hfov, float near_plane, float far_plane)
 {
@@ -144,6 +255,72 @@ GLSpace::set_texture (ShapeMaterial const& material)
 
 void
 GLSpace::draw (Shape const& shape)
+{
+	if (needs_immediate_mode())
+		return draw_immediately (shape);
+
+	make_vertex_arrays (shape, _streaming_arrays);
+
+	if (_streaming_buffer == 0)
+		glGenBuffers (1, &_streaming_buffer);
+
+	// Respecifying the whole buffer lets the driver allocate new storage instead of waiting
+	// until previous draws from this buffer finish:
+	glBindBuffer (GL_ARRAY_BUFFER, _streaming_buffer);
+	glBufferData (GL_ARRAY_BUFFER, _streaming_arrays.vertices.size() * sizeof (Vertex), _streaming_arrays.vertices.data(), GL_STREAM_DRAW);
+	draw_vertex_arrays (_streaming_arrays, _streaming_buffer);
+}
+
+
+void
+GLSpace::draw (Shape const& shape, RetainedShape& retained)
+{
+	// Retained vertices can't have camera position subtracted in double precision, so
+	// use them only if there's no camera translation:
+	bool const camera_translated = _camera && abs (_camera->position()) > 0_m;
+
+	if (camera_translated)
+		return draw (shape);
+
+	if (needs_immediate_mode())
+		return draw_immediately (shape);
+
+	if (retained._shape != &shape)
+	{
+		make_vertex_arrays (shape, retained._arrays);
+
+		if (retained._buffer == 0)
+			glGenBuffers (1, &retained._buffer);
+
+		glBindBuffer (GL_ARRAY_BUFFER, retained._buffer);
+		glBufferData (GL_ARRAY_BUFFER, retained._arrays.vertices.size() * sizeof (Vertex), retained._arrays.vertices.data(), GL_STATIC_DRAW);
+		// Vertex data is on the GPU now:
+		retained._arrays.vertices.clear();
+		retained._arrays.vertices.shrink_to_fit();
+		retained._shape = &shape;
+	}
+
+	draw_vertex_arrays (retained._arrays, retained._buffer);
+}
+
+
+void
+GLSpace::draw_points (RetainedPoints const& points)
+{
+	if (points.empty())
+		return;
+
+	glBindBuffer (GL_ARRAY_BUFFER, points._buffer);
+	glVertexPointer (3, GL_FLOAT, 0, nullptr);
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glDrawArrays (GL_POINTS, 0, points._count);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+
+void
+GLSpace::draw_immediately (Shape const& shape)
 {
 	for (auto const& triangle: shape.triangles())
 		begin (GL_TRIANGLES, triangle);
@@ -189,6 +366,189 @@ GLSpace::pop_context()
 }
 
 
+bool
+GLSpace::needs_immediate_mode() const
+{
+	// Alpha factor would have to be applied to the emission color stored in vertex attributes:
+	return !_additional_parameters_stack.empty() && _additional_parameters_stack.top().alpha_factor != 1.0f;
+}
+
+
+void
+GLSpace::upload_points (RetainedPoints& points, std::vector<GLfloat> const& coordinates)
+{
+	if (points._buffer == 0)
+		glGenBuffers (1, &points._buffer);
+
+	glBindBuffer (GL_ARRAY_BUFFER, points._buffer);
+	glBufferData (GL_ARRAY_BUFFER, coordinates.size() * sizeof (GLfloat), coordinates.data(), GL_STATIC_DRAW);
+	glBindBuffer (GL_ARRAY_BUFFER, 0);
+	points._count = static_cast<GLsizei> (coordinates.size() / 3);
+}
+
+
+void
+GLSpace::make_vertex_arrays (Shape const& shape, VertexArrays& arrays) const
+{
+	arrays.vertices.clear();
+	arrays.batches.clear();
+	arrays.immediate_geometries.clear();
+
+	auto const camera_offset = _camera
+		? SpaceVector<double, WorldSpace> (_camera->position() * _position_scale)
+		: SpaceVector<double, WorldSpace> (math::zero);
+
+	auto const add_geometries = [&] (GLenum const mode, std::vector<Shape::Geometry> const& geometries) {
+		for (auto const& geometry: geometries)
+		{
+			if (geometry.vertices.empty())
+				continue;
+
+			bool const textured = !!geometry.texture;
+			auto const& first_vertex = geometry.vertices.front();
+			bool const has_normals = first_vertex.normal().has_value();
+			bool const uniform = std::all_of (geometry.vertices.begin(), geometry.vertices.end(), [&] (ShapeVertex const& vertex) {
+				return vertex.normal().has_value() == has_normals
+					&& same_lighting (vertex.material(), first_vertex.material(), textured);
+			});
+
+			if (!uniform)
+			{
+				arrays.batches.push_back ({
+					.mode = mode,
+					.immediate_geometry = arrays.immediate_geometries.size(),
+				});
+				arrays.immediate_geometries.push_back (geometry);
+				continue;
+			}
+
+			// Start new batch unless the previous one is compatible:
+			if (arrays.batches.empty() ||
+				arrays.batches.back().immediate_geometry ||
+				arrays.batches.back().mode != mode ||
+				arrays.batches.back().texture != geometry.texture ||
+				arrays.batches.back().has_normals != has_normals ||
+				!same_lighting (arrays.batches.back().material, first_vertex.material(), textured))
+			{
+				arrays.batches.push_back ({
+					.mode = mode,
+					.texture = geometry.texture,
+					.material = first_vertex.material(),
+					.has_normals = has_normals,
+				});
+			}
+
+			auto& batch = arrays.batches.back();
+			batch.firsts.push_back (static_cast<GLint> (arrays.vertices.size()));
+			batch.counts.push_back (static_cast<GLsizei> (geometry.vertices.size()));
+
+			for (auto const& vertex: geometry.vertices)
+			{
+				auto const& material = vertex.material();
+				auto const position = math::coordinate_system_cast<WorldSpace, void, BodyOrigin, void> (vertex.position()) * _position_scale - camera_offset;
+				auto const normal = vertex.normal().value_or (SpaceVector<double, BodyOrigin> (math::zero));
+				auto const& color = textured ? material.gl_texture_color : material.gl_emission_color;
+
+				arrays.vertices.push_back ({
+					.position = { static_cast<GLfloat> (position[0]), static_cast<GLfloat> (position[1]), static_cast<GLfloat> (position[2]) },
+					.normal = { static_cast<GLfloat> (normal[0]), static_cast<GLfloat> (normal[1]), static_cast<GLfloat> (normal[2]) },
+					.color = { color[0], color[1], color[2], color[3] },
+					.texture_position = { material.texture_position.x(), material.texture_position.y() },
+					.fog_distance = material.gl_fog_distance,
+				});
+			}
+		}
+	};
+
+	add_geometries (GL_TRIANGLES, shape.triangles());
+	add_geometries (GL_TRIANGLE_STRIP, shape.triangle_strips());
+	add_geometries (GL_TRIANGLE_FAN, shape.triangle_fans());
+	add_geometries (GL_QUADS, shape.quads());
+}
+
+
+void
+GLSpace::draw_vertex_arrays (VertexArrays const& arrays, GLuint const buffer)
+{
+	auto const& params = additional_parameters();
+	auto const offset = [] (std::size_t const bytes) {
+		return reinterpret_cast<GLvoid const*> (bytes);
+	};
+
+	glBindBuffer (GL_ARRAY_BUFFER, buffer);
+	glVertexPointer (3, GL_FLOAT, sizeof (Vertex), offset (offsetof (Vertex, position)));
+	glNormalPointer (GL_FLOAT, sizeof (Vertex), offset (offsetof (Vertex, normal)));
+	glColorPointer (4, GL_FLOAT, sizeof (Vertex), offset (offsetof (Vertex, color)));
+	glTexCoordPointer (2, GL_FLOAT, sizeof (Vertex), offset (offsetof (Vertex, texture_position)));
+	glFogCoordPointer (GL_FLOAT, sizeof (Vertex), offset (offsetof (Vertex, fog_distance)));
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glEnableClientState (GL_COLOR_ARRAY);
+	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState (GL_FOG_COORD_ARRAY);
+	// In immediate mode glColor() is set to the emission color, and so is GL_EMISSION material.
+	// Make GL_EMISSION track the color attribute to get the same result:
+	glColorMaterial (GL_FRONT, GL_EMISSION);
+
+	for (auto const& batch: arrays.batches)
+	{
+		if (batch.immediate_geometry)
+		{
+			// Immediate mode sets materials itself and doesn't use vertex buffers:
+			glDisable (GL_COLOR_MATERIAL);
+			glBindBuffer (GL_ARRAY_BUFFER, 0);
+			begin (batch.mode, arrays.immediate_geometries[*batch.immediate_geometry]);
+			glBindBuffer (GL_ARRAY_BUFFER, buffer);
+			continue;
+		}
+
+		if (batch.has_normals)
+			glEnableClientState (GL_NORMAL_ARRAY);
+		else
+			glDisableClientState (GL_NORMAL_ARRAY);
+
+		if (batch.texture)
+		{
+			// The same as set_texture():
+			glDisable (GL_COLOR_MATERIAL);
+			glMaterialfv (GL_FRONT, GL_DIFFUSE, batch.material.gl_texture_color);
+			batch.texture->bind();
+		}
+		else
+		{
+			// The same as set_material(), apart from the emission color:
+			glEnable (GL_COLOR_MATERIAL);
+			glMaterialf (GL_FRONT, GL_SHININESS, 128.0 * batch.material.gl_shininess);
+
+			if (params.color_override)
+			{
+				glMaterialfv (GL_FRONT, GL_AMBIENT, *params.color_override);
+				glMaterialfv (GL_FRONT, GL_DIFFUSE, *params.color_override);
+				glMaterialfv (GL_FRONT, GL_SPECULAR, *params.color_override);
+			}
+			else
+			{
+				glMaterialfv (GL_FRONT, GL_AMBIENT, batch.material.gl_ambient_color);
+				glMaterialfv (GL_FRONT, GL_DIFFUSE, batch.material.gl_diffuse_color);
+				glMaterialfv (GL_FRONT, GL_SPECULAR, batch.material.gl_specular_color);
+			}
+		}
+
+		glMultiDrawArrays (batch.mode, batch.firsts.data(), batch.counts.data(), static_cast<GLsizei> (batch.counts.size()));
+
+		if (batch.texture)
+			batch.texture->release();
+	}
+
+	glDisable (GL_COLOR_MATERIAL);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	glDisableClientState (GL_NORMAL_ARRAY);
+	glDisableClientState (GL_COLOR_ARRAY);
+	glDisableClientState (GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState (GL_FOG_COORD_ARRAY);
+	glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+
 GLSpace::AdditionalParameters&
 GLSpace::additional_parameters()
 {
@@ -25,6 +25,7 @@
 #include <xefis/support/shapes/shape_vertex.h>
 
 // Qt:
+#include <QOpenGLTexture>
 #include <QSize>
 
 // System:
@@ -36,6 +37,7 @@
 #include <memory>
 #include <optional>
 #include <stack>
+#include <vector>
 
 
 namespace xf {
@@ -92,10 +94,145 @@ class GLSpace
 		float					alpha_factor	{ 1.0f };
 	};
 
+  private:
+	/**
+	 * Interleaved vertex attributes as stored in vertex buffers.
+	 */
+	struct Vertex
+	{
+		GLfloat	position[3];
+		GLfloat	normal[3];
+		// Emission color for untextured vertices and texture color for textured ones,
+		// the same that set_material() and set_texture() pass to glColor():
+		GLfloat	color[4];
+		GLfloat	texture_position[2];
+		GLfloat	fog_distance;
+	};
+
+	/**
+	 * Consecutive geometries with the same primitive type, texture and lighting material,
+	 * drawn with a single glMultiDrawArrays() call.
+	 */
+	struct Batch
+	{
+		GLenum							mode;
+		std::shared_ptr<QOpenGLTexture>	texture;
+		// Only lighting parameters are used, emission color is a vertex attribute:
+		ShapeMaterial					material;
+		bool							has_normals;
+		std::vector<GLint>				firsts;
+		std::vector<GLsizei>			counts;
+		// If set, the batch is a geometry from VertexArrays::immediate_geometries that can't be
+		// drawn from vertex arrays (because its lighting material changes from vertex to vertex):
+		std::optional<std::size_t>		immediate_geometry;
+	};
+
+	/**
+	 * Shape converted to vertex arrays.
+	 */
+	struct VertexArrays
+	{
+		std::vector<Vertex>				vertices;
+		std::vector<Batch>				batches;
+		std::vector<Shape::Geometry>	immediate_geometries;
+	};
+
+  public:
+	/**
+	 * Vertex data of a constant Shape retained in an OpenGL buffer object between frames.
+	 * Pass it to draw() together with the shape; the data gets uploaded on first use and
+	 * again only after invalidate() or if a different Shape object is drawn.
+	 * Must be destroyed while the OpenGL context is current, otherwise the buffer is leaked
+	 * until the context is destroyed.
+	 */
+	class RetainedShape
+	{
+		friend class GLSpace;
+
+	  public:
+		// Ctor
+		RetainedShape() = default;
+
+		// Copy ctor
+		RetainedShape (RetainedShape const&) = delete;
+
+		// Move ctor
+		RetainedShape (RetainedShape&&) noexcept;
+
+		// Dtor
+		~RetainedShape();
+
+		// Copy operator
+		RetainedShape&
+		operator= (RetainedShape const&) = delete;
+
+		// Move operator
+		RetainedShape&
+		operator= (RetainedShape&&) noexcept;
+
+		/**
+		 * Mark the data as outdated, eg. when the shape has been recomputed in place.
+		 */
+		void
+		invalidate() noexcept
+			{ _shape = nullptr; }
+
+	  private:
+		Shape const*	_shape	{ nullptr };
+		GLuint			_buffer	{ 0 };
+		VertexArrays	_arrays;
+	};
+
+	/**
+	 * Positions of points retained in an OpenGL buffer object between frames, drawn with draw_points().
+	 * Must be destroyed while the OpenGL context is current, otherwise the buffer is leaked
+	 * until the context is destroyed.
+	 */
+	class RetainedPoints
+	{
+		friend class GLSpace;
+
+	  public:
+		// Ctor
+		RetainedPoints() = default;
+
+		// Copy ctor
+		RetainedPoints (RetainedPoints const&) = delete;
+
+		// Move ctor
+		RetainedPoints (RetainedPoints&&) noexcept;
+
+		// Dtor
+		~RetainedPoints();
+
+		// Copy operator
+		RetainedPoints&
+		operator= (RetainedPoints const&) = delete;
+
+		// Move operator
+		RetainedPoints&
+		operator= (RetainedPoints&&) noexcept;
+
+		/**
+		 * Return true if no points have been set.
+		 */
+		[[nodiscard]]
+		bool
+		empty() const noexcept
+			{ return _count == 0; }
+
+	  private:
+		GLuint	_buffer	{ 0 };
+		GLsizei	_count	{ 0 };
+	};
+
   public:
 	// Ctor
 	GLSpace (decltype (1 / 1_m) position_scale = 1.0 / 1_m);
 
+	// Dtor
+	~GLSpace();
+
 	/**
 	 * Add given offset to all vertex positions that are drawn.
 	 */
@@ -303,11 +440,40 @@ class GLSpace
 	additional_parameters();
 
 	/**
-	 * Draw given shape in OpenGL.
+	 * Draw given shape in OpenGL. Vertices are streamed to OpenGL through a vertex buffer
+	 * that's refilled on each call, so use it for shapes that change from frame to frame.
 	 */
 	void
 	draw (Shape const& shape);
 
+	/**
+	 * Draw given constant shape using vertex buffer retained between frames.
+	 * Falls back to streaming when camera is translated, since retained vertices are in
+	 * single-precision and can't have camera position subtracted before conversion.
+	 */
+	void
+	draw (Shape const& shape, RetainedShape&);
+
+	/**
+	 * Upload point positions to the retained buffer, replacing previous ones.
+	 */
+	template<math::CoordinateSystem Space>
+		void
+		set_points (RetainedPoints&, std::vector<SpaceLength<Space>> const& positions);
+
+	/**
+	 * Draw retained points as GL_POINTS. Only positions are passed to OpenGL; color, point size
+	 * and point sprite state are up to the caller.
+	 */
+	void
+	draw_points (RetainedPoints const&);
+
+	/**
+	 * Draw given shape with one OpenGL call per vertex (slowest path).
+	 */
+	void
+	draw_immediately (Shape const& shape);
+
 	void
 	clear_z_buffer (float value = 1.0f);
 
@@ -333,11 +499,39 @@ class GLSpace
 	void
 	pop_context();
 
+	/**
+	 * Return true if the shape can't be drawn from vertex arrays with current parameters.
+	 */
+	[[nodiscard]]
+	bool
+	needs_immediate_mode() const;
+
+	/**
+	 * Upload point coordinates (three per point) to the retained buffer.
+	 */
+	void
+	upload_points (RetainedPoints&, std::vector<GLfloat> const& coordinates);
+
+	/**
+	 * Convert shape to vertex arrays. Camera position (if set) is subtracted from vertex positions.
+	 */
+	void
+	make_vertex_arrays (Shape const&, VertexArrays&) const;
+
+	/**
+	 * Draw batches from vertex arrays previously uploaded to the buffer.
+	 */
+	void
+	draw_vertex_arrays (VertexArrays const&, GLuint buffer);
+
   private:
 	std::optional<Placement<WorldSpace, WorldSpace>>
 										_camera;
 	decltype (1 / 1_m)					_position_scale					{ 1 };
 	std::stack<AdditionalParameters>	_additional_parameters_stack;
+	// Used by draw() for shapes that aren't retained:
+	GLuint								_streaming_buffer				{ 0 };
+	VertexArrays						_streaming_arrays;
 };
 
 
@@ -481,6 +675,21 @@ template<math::CoordinateSystem Space>
 	}
 
 
+template<math::CoordinateSystem Space>
+	inline void
+	GLSpace::set_points (RetainedPoints& points, std::vector<SpaceLength<Space>> const& positions)
+	{
+		std::vector<GLfloat> coordinates;
+		coordinates.reserve (3 * positions.size());
+
+		for (auto const& position: positions)
+			for (std::size_t i = 0; i < 3; ++i)
+				coordinates.push_back (to_opengl (position[i]));
+
+		upload_points (points, coordinates);
+	}
+
+
 inline GLMatrix
 GLSpace::extract_modelview_matrix()
 {
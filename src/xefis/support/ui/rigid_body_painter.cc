@@ -47,11 +47,14 @@
 #include <GL/glu.h>
 
 // Standard:
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <future>
 #include <limits>
-#include <random>
+#include <vector>
 
 
 namespace xf {
@@ -70,6 +73,32 @@ constexpr auto kGLSkyLight2				= GL_LIGHT5;
 constexpr auto kGLSkyLight3				= GL_LIGHT6;
 constexpr auto kGLSkyLight4				= GL_LIGHT7;
 
+namespace {
+
+/**
+ * Return pseudo-random value in range [0, 1) that depends only on the grid cell and the salt.
+ * It's a SplitMix64 finalizer applied to the cell coordinates, much cheaper than reseeding a PRNG.
+ */
+[[nodiscard]]
+double
+cell_hash (std::array<int64_t, 3> const& cell, uint64_t const salt)
+{
+	auto h = salt * 0x9e3779b97f4a7c15u;
+	h ^= static_cast<uint64_t> (cell[0]) * 0xbf58476d1ce4e5b9u;
+	h ^= static_cast<uint64_t> (cell[1]) * 0x94d049bb133111ebu;
+	h ^= static_cast<uint64_t> (cell[2]) * 0xd6e8feb86659fd93u;
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9u;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebu;
+	h ^= h >> 31;
+	// Use the top 53 bits to fill the mantissa of a double:
+	return static_cast<double> (h >> 11) * 0x1.0p-53;
+}
+
+} // namespace
+
+
 nu::Synchronized<std::shared_future<RigidBodyPainter::PlanetTextureImages>>		RigidBodyPainter::_planet_texture_images;
 nu::Synchronized<std::shared_future<RigidBodyPainter::UniverseTextureImages>>	RigidBodyPainter::_universe_texture_images;
 
@@ -154,9 +183,6 @@ RigidBodyPainter::set_time (si::Time const new_time)
 
 	if (abs (_time - _prev_saved_time) > kCachedComputationTimeDelta)
 	{
-		if (_planet)
-			_planet->sky_dome_shape.reset();
-
 		if (_universe)
 			check_sky_box();
 
@@ -252,8 +278,9 @@ RigidBodyPainter::set_sun_enabled (bool enabled)
 	else
 		_sun.reset();
 
+	// Don't show colors from the previous sky-view LUT:
 	if (_planet)
-		_planet->sky_dome_shape.reset();
+		_planet->sky_dome = SkyDome();
 }
 
 
@@ -303,49 +330,40 @@ RigidBodyPainter::body_under_cursor (rigid_body::System const& system, QPoint co
 	}.normalized();
 	auto const ray_direction_world = (_camera_placement.base_rotation() * ray_direction_camera).normalized();
 	auto const ray_origin_world = _camera_placement.position();
-	auto nearest_distance = std::numeric_limits<double>::infinity() * 1_m;
-	rigid_body::Body* nearest_body = nullptr;
 
-	for (auto const& body_ptr: system.bodies())
-	{
-		auto& body = *body_ptr;
+	update_picking_bvh (system);
+
+	// Broad-phase: the BVH only visits bodies whose bounding boxes are hit nearer than the nearest hit so far.
+	auto const hit = _picking_bvh.intersect (ray_origin_world, ray_direction_world, [&] (std::size_t const index) -> std::optional<si::Length> {
+		auto const& candidate = _picking_candidates[index];
+		auto const& body = *candidate.body;
 
-		if (get_rendering_config (body).body_visible)
+		// The box around the bounding sphere is looser than the sphere itself, so test the sphere
+		// before transforming rays and running exact mesh picking:
+		if (!ray_sphere_intersection (ray_origin_world, ray_direction_world, body.placement().position(), candidate.bounding_sphere_radius))
+			return std::nullopt;
+
+		auto const ray_origin_body_com = body.placement().rotate_translate_to_body (ray_origin_world);
+		auto const ray_origin_body_origin = body.origin_placement<BodyCOM>().rotate_translate_to_body (ray_origin_body_com);
+		auto const ray_direction_body_origin = body.origin_placement<BodyCOM>().rotate_to_body (body.placement().rotate_to_body (ray_direction_world)).normalized();
+		auto const& body_shape = shape_for (body);
+		auto& config = get_rendering_config (body);
+
+		// Narrow-phase: exact intersection with the body shape in body-origin space.
+		// Triangle BVH is built on first use for constant shapes; other shapes can change
+		// every frame, so they're tested triangle by triangle:
+		if (config.picking_shape == &body_shape)
 		{
-			auto const& body_shape = shape_for (body);
+			if (!config.shape_bvh)
+				config.shape_bvh.emplace (body_shape);
 
-			if (auto const radius = body.bounding_sphere_radius (body_shape);
-				radius > 0_m)
-			{
-				// radius must be > 0_m, otherwise sphere intersection is degenerate
-				// (point sphere / empty geometry), so there is nothing meaningful to pick.
-				// This quick sphere hit test rejects bodies definitely not under the cursor,
-				// avoiding costly per-shape intersection for most bodies.
-				if (auto const bounding_sphere_distance = ray_sphere_intersection (ray_origin_world, ray_direction_world, body.placement().position(), radius);
-					bounding_sphere_distance && *bounding_sphere_distance < nearest_distance)
-				{
-					// bounding_sphere_distance gives the first hit distance along the ray.
-					// Keeping only distances nearer than current best lets us prune farther
-					// candidates before transforming rays and running exact mesh picking.
-					auto const ray_origin_body_com = body.placement().rotate_translate_to_body (ray_origin_world);
-					auto const ray_origin_body_origin = body.origin_placement<BodyCOM>().rotate_translate_to_body (ray_origin_body_com);
-					auto const ray_direction_body_origin = body.origin_placement<BodyCOM>().rotate_to_body (body.placement().rotate_to_body (ray_direction_world)).normalized();
-
-					// Narrow-phase: exact intersection with the body shape in body-origin space.
-					if (auto const shape_distance = ray_shape_intersection (body_shape, ray_origin_body_origin, ray_direction_body_origin))
-					{
-						if (*shape_distance < nearest_distance)
-						{
-							nearest_distance = *shape_distance;
-							nearest_body = &body;
-						}
-					}
-				}
-			}
+			return config.shape_bvh->ray_intersection (ray_origin_body_origin, ray_direction_body_origin);
 		}
-	}
+		else
+			return ray_shape_intersection (body_shape, ray_origin_body_origin, ray_direction_body_origin);
+	});
 
-	return nearest_body;
+	return hit ? _picking_candidates[hit->primitive].body : nullptr;
 }
 
 
@@ -405,7 +423,12 @@ RigidBodyPainter::precompute()
 		_sun->position = compute_sun_position (_camera_polar_position, _time);
 		_sun->corrected_position_horizontal_coordinates = corrected_sun_position_near_horizon (_sun->position.horizontal_coordinates);
 		_sun->corrected_position_cartesian_horizontal_coordinates = compute_cartesian_horizontal_coordinates (_sun->corrected_position_horizontal_coordinates);
-		_sun->color_on_body = to_gl_color (compute_sun_light_color (_camera_polar_position, _sun->corrected_position_cartesian_horizontal_coordinates, _sun->atmospheric_scattering));
+
+		// Sky dome colors are sampled from the LUT, so recompute them when the LUT changes:
+		if (_sun->sky_view_lut.update (_camera_polar_position.radius(), _sun->corrected_position_cartesian_horizontal_coordinates, &*_work_performer) && _planet)
+			_planet->sky_dome.invalidate_colors();
+
+		_sun->color_on_body = to_gl_color (compute_sun_light_color (_sun->sky_view_lut));
 
 		if (_planet)
 		{
@@ -600,11 +623,7 @@ RigidBodyPainter::setup_sky_light()
 
 				auto const number = sky_light.gl_number;
 				auto const light_direction = to_cartesian<void> (sky_light.position); // Azimuth (lon()) should possible be negated, but the sky dome is symmetric, so this is okay.
-				auto const color = _sun->atmospheric_scattering.compute_incident_light (
-					{ 0_m, 0_m, _followed_polar_position.radius() },
-					light_direction,
-					_sun->position.cartesian_horizontal_coordinates
-				);
+				auto const color = _sun->sky_view_lut.incident_light (light_direction, _sun->position.cartesian_horizontal_coordinates);
 				auto const corrected_color = sky_correction (color, _sun->position);
 				auto const gl_color = to_gl_color (corrected_color);
 				auto const sky_height = kAtmosphereRadius - kEarthMeanRadius;
@@ -828,7 +847,7 @@ RigidBodyPainter::paint_universe_and_sun()
 			glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 			_gl.set_camera_rotation_only (_camera_placement);
 			_gl.rotate (~(kScreenToNullIslandRotation * _universe->ecef_to_celestial_rotation));
-			_gl.draw (*_universe->sky_box_shape);
+			_gl.draw (*_universe->sky_box_shape, _universe->sky_box_retained);
 			_gl.clear_z_buffer();
 			glDisable (GL_TEXTURE_2D);
 			glDisable (GL_BLEND);
@@ -867,7 +886,7 @@ RigidBodyPainter::paint_universe_and_sun()
 			_gl.save_context ([&]{
 				auto const scale = _sun->magnification;
 				glScalef (scale, scale, scale);
-				_gl.draw (_sun->face_shape);
+				_gl.draw (_sun->face_shape, _sun->face_retained);
 			});
 			auto const time_dependent_angle = 360_deg * _time.in<si::Hour>() / 24.0;
 			// Rotate sun shines when camera angle and simulation time changes:
@@ -908,6 +927,7 @@ RigidBodyPainter::paint_moon()
 
 	if (!_moon_shape)
 	{
+		_moon_retained.invalidate();
 		_moon_shape = make_centered_sphere_shape ({
 			.radius = kMoonRadius,
 			.n_slices = 50,
@@ -955,7 +975,7 @@ RigidBodyPainter::paint_moon()
 		// Keep the same lunar hemisphere facing Earth.
 		_gl.rotate_z (moon_rotation[0]);
 		_gl.rotate_y (moon_rotation[1]);
-		_gl.draw (*_moon_shape);
+		_gl.draw (*_moon_shape, _moon_retained);
 
 		glDisable (GL_TEXTURE_2D);
 	});
@@ -973,7 +993,7 @@ RigidBodyPainter::paint_planet()
 
 		// Ground:
 		// TODO it would be best if there was a shader that adds the dome sphere color to the drawn feature
-		if (_planet->ground_shape)
+		if (_planet->ground)
 		{
 			_gl.save_context ([&]{
 				glFrontFace (GL_CCW);
@@ -983,18 +1003,18 @@ RigidBodyPainter::paint_planet()
 				glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 				_gl.translate (planet_position());
 				enable_only_lights (kCosmicSunLight);
-				_gl.draw (*_planet->ground_shape);
+				_gl.draw (_planet->ground->shape);
 				glDisable (GL_TEXTURE_2D);
 			});
 		}
 
-		if (_planet->sky_dome_shape)
+		if (_sun && _planet->sky_dome.ready())
 		{
 			// Sky and ground dome around the observer:
 			_gl.save_context ([&]{
 				_gl.set_camera_rotation_only (_camera_placement);
-				// Rotate so that down is -Z.
-				make_z_sky_top_x_south();
+				// Rotate so that down is -Z and the sun is at longitude 0° of the dome shape:
+				make_z_sky_top_x_sun_azimuth (_sun->position);
 				// Normally the outside of the sphere shape is rendered, inside is culled.
 				// But here we're inside the sphere, so tell OpenGL that the front faces are the
 				// inside faces:
@@ -1005,7 +1025,7 @@ RigidBodyPainter::paint_planet()
 				// Blend with the universe: final_color = (1 - transmittance) * atmosphere_color + universe_color
 				glBlendFunc (GL_SRC_ALPHA, GL_ONE);
 				glEnable (GL_BLEND);
-				_gl.draw (*_planet->sky_dome_shape);
+				_gl.draw (_planet->sky_dome.shape(), _planet->sky_dome_retained);
 				glDisable (GL_BLEND);
 				glEnable (GL_LIGHTING);
 				glEnable (GL_DEPTH_TEST);
@@ -1024,7 +1044,6 @@ RigidBodyPainter::paint_air_particles()
 		// Trick with rotating camera and then subtracting camera position from the object is to avoid problems with low precision OpenGL floats:
 		// _followed_position - _camera_placement.position() uses doubles; but _gl.translate() internally reduces them to floats:
 		_gl.translate (_followed_position - _camera_placement.position());
-		auto const camera_billboard_rotation = ~_camera_placement.body_rotation();
 
 		glDisable (GL_LIGHTING);
 		glEnable (GL_DEPTH_TEST);
@@ -1033,45 +1052,82 @@ RigidBodyPainter::paint_air_particles()
 		glDisable (GL_CULL_FACE);
 
 		auto const grid_size = std::max (_followed_object_diameter, kMinDustGridSize);
-		auto const range = 3 * grid_size;
-
-		// Figure out nearest 3D grid points.
-		// Then wiggle each one pseudo-randomly.
 		auto const body_pos = _followed_position;
-		auto const inv_grid_size = 1 / grid_size;
-		auto const rounded_to_grid = body_pos.transformed ([inv_grid_size, grid_size] (auto const value) {
-			return std::round (value * inv_grid_size) * grid_size;
-		});
-		auto const prng_factor = grid_size / _air_particles_prng.max();
-		auto const half_grid_size = 0.5 * grid_size;
+		auto const center_cell = std::array {
+			static_cast<int64_t> (std::round (body_pos.x() / grid_size)),
+			static_cast<int64_t> (std::round (body_pos.y() / grid_size)),
+			static_cast<int64_t> (std::round (body_pos.z() / grid_size)),
+		};
+
+		if (!_air_particles)
+			_air_particles.emplace();
+
+		auto& particles = *_air_particles;
 
-		// Paint a grid of little dust particles around the camera position:
-		for (auto x = rounded_to_grid.x() - range; x <= rounded_to_grid.x() + range; x += grid_size)
+		// Particle positions depend only on the grid, so recompute and upload them only when the followed object
+		// moves to another cell. Each grid point gets wiggled pseudo-randomly:
+		if (particles.positions.empty() || particles.center_cell != center_cell || particles.grid_size != grid_size)
 		{
-			for (auto y = rounded_to_grid.y() - range; y <= rounded_to_grid.y() + range; y += grid_size)
+			particles.center_cell = center_cell;
+			particles.grid_size = grid_size;
+
+			std::vector<SpaceLength<WorldSpace>> offsets;
+			offsets.reserve ((2 * kDustGridRange + 1) * (2 * kDustGridRange + 1) * (2 * kDustGridRange + 1));
+
+			for (auto dx = -kDustGridRange; dx <= kDustGridRange; ++dx)
 			{
-				for (auto z = rounded_to_grid.z() - range; z <= rounded_to_grid.z() + range; z += grid_size)
+				for (auto dy = -kDustGridRange; dy <= kDustGridRange; ++dy)
 				{
-					auto seed = std::seed_seq {
-						static_cast<int64_t> (x.in<si::Meter>()),
-						static_cast<int64_t> (y.in<si::Meter>()),
-						static_cast<int64_t> (z.in<si::Meter>()),
-					};
-					_air_particles_prng.seed (seed);
-					_gl.save_context ([&]{
-						// OpenGL's center of the view [0, 0, 0] is at body_pos, hence subtracting body_pos from
-						// absolute values (in WorldOrigin space) x, y, z here:
-						auto const wiggled_x = x - body_pos.x() + prng_factor * _air_particles_prng() - half_grid_size;
-						auto const wiggled_y = y - body_pos.y() + prng_factor * _air_particles_prng() - half_grid_size;
-						auto const wiggled_z = z - body_pos.z() + prng_factor * _air_particles_prng() - half_grid_size;
-						_gl.translate (wiggled_x, wiggled_y, wiggled_z);
-						_gl.rotate (camera_billboard_rotation);
-						_gl.draw (_dust_particle);
-					});
+					for (auto dz = -kDustGridRange; dz <= kDustGridRange; ++dz)
+					{
+						auto const cell = std::array { center_cell[0] + dx, center_cell[1] + dy, center_cell[2] + dz };
+
+						offsets.emplace_back (
+							(dx + cell_hash (cell, 0) - 0.5) * grid_size,
+							(dy + cell_hash (cell, 1) - 0.5) * grid_size,
+							(dz + cell_hash (cell, 2) - 0.5) * grid_size
+						);
+					}
 				}
 			}
+
+			_gl.set_points (particles.positions, offsets);
 		}
 
+		if (!particles.texture)
+			particles.texture = make_dust_texture();
+
+		// Point sprites always face the camera, so nothing needs to be rotated or uploaded per frame.
+		// With attenuation {0, 0, 1} the point size is divided by the squared eye distance and then clamped
+		// to GL_POINT_SIZE_MAX, so particles very close to the camera may appear smaller than they should.
+		std::array<GLfloat, 16> projection;
+		std::array<GLint, 4> viewport;
+		glGetFloatv (GL_PROJECTION_MATRIX, projection.data());
+		glGetIntegerv (GL_VIEWPORT, viewport.data());
+		auto const pixels_per_unit = 0.5f * projection[5] * viewport[3];
+		auto const attenuation = std::array<GLfloat, 3> { 0.0f, 0.0f, 1.0f };
+		glPointSize (2.0f * _gl.to_opengl (_dust_particle_radius) * pixels_per_unit);
+		glPointParameterfv (GL_POINT_DISTANCE_ATTENUATION, attenuation.data());
+		glEnable (GL_POINT_SPRITE);
+		glTexEnvi (GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
+		glEnable (GL_TEXTURE_2D);
+		glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		glColor4f (1.0f, 1.0f, 1.0f, 1.0f);
+		particles.texture->bind();
+
+		// OpenGL's center of the view [0, 0, 0] is at body_pos, so only the small offset between the center cell
+		// and body_pos needs to be applied each frame:
+		auto const center_cell_position = SpaceLength<WorldSpace> (center_cell[0] * grid_size, center_cell[1] * grid_size, center_cell[2] * grid_size);
+		_gl.translate (center_cell_position - body_pos);
+		_gl.draw_points (particles.positions);
+
+		particles.texture->release();
+		auto const no_attenuation = std::array<GLfloat, 3> { 1.0f, 0.0f, 0.0f };
+		glDisable (GL_TEXTURE_2D);
+		glTexEnvi (GL_POINT_SPRITE, GL_COORD_REPLACE, GL_FALSE);
+		glDisable (GL_POINT_SPRITE);
+		glPointParameterfv (GL_POINT_DISTANCE_ATTENUATION, no_attenuation.data());
+		glPointSize (1.0f);
 		glEnable (GL_CULL_FACE);
 		glDisable (GL_BLEND);
 		glEnable (GL_LIGHTING);
@@ -1090,7 +1146,7 @@ RigidBodyPainter::recalculate_followed_object_diameter()
 		_followed_object_diameter = 0_m;
 
 	auto const dust_size = std::max<si::Length> (2_cm, 1.0 / 250 * _followed_object_diameter);
-	_dust_particle = make_blurred_circle (dust_size);
+	_dust_particle_radius = dust_size;
 }
 
 
@@ -1174,7 +1230,7 @@ RigidBodyPainter::paint_helpers (rigid_body::System const& system)
 
 
 void
-RigidBodyPainter::paint (rigid_body::Body const& body, BodyRenderingConfig const& rendering)
+RigidBodyPainter::paint (rigid_body::Body const& body, BodyRenderingConfig& rendering)
 {
 	_gl.save_context ([&]{
 		transform_gl_to_center_of_mass (body);
@@ -1194,7 +1250,11 @@ RigidBodyPainter::paint (rigid_body::Body const& body, BodyRenderingConfig const
 					_gl.additional_parameters().color_override = GLColor::from_rgb (0x00, 0xaa, 0x7f).lighter (0.5);
 
 				glFrontFace (GL_CCW);
-				_gl.draw (shape_for (body));
+
+				if (body.shape_is_constant() || !body.shape())
+					_gl.draw (shape_for (body), rendering.retained_shape);
+				else
+					_gl.draw (shape_for (body));
 			});
 		}
 	});
@@ -1654,9 +1714,6 @@ RigidBodyPainter::check_planet_textures()
 			// Reset the shape so it's recalculated with texture next time
 			// instead of basic non-textured ball:
 			_moon_shape.reset();
-
-			// Reload SkyDome to include the Earth texture:
-			_planet->sky_dome_shape.reset();
 		}
 	}
 }
@@ -1691,38 +1748,45 @@ RigidBodyPainter::check_sky_dome_and_ground_shape()
 {
 	if (_planet)
 	{
-		if (!_planet->sky_dome_shape)
-			_planet->sky_dome_shape = compute_sky_dome_shape();
+		if (_sun)
+		{
+			// With alpha 1.0 and being in space, the sky is a bit too bright.
+			// Tone it down a bit.
+			auto const sky_alpha = 1.0f - 0.1f * _planet->camera_clamped_normalized_amsl_height;
+
+			auto const changed = _planet->sky_dome.update ({
+				.sky_view_lut = _sun->sky_view_lut,
+				.observer_position = _camera_polar_position,
+				.earth_radius = kEarthMeanRadius,
+				.sky_alpha = sky_alpha,
+			});
+			// TODO apply sky_correction to vertices' materials
 
-		if (!_planet->ground_shape && _planet_textures)
-			_planet->ground_shape = compute_ground_shape (_camera_polar_position, kEarthMeanRadius, _planet_textures->earth);
-	}
-}
+			if (changed)
+				_planet->sky_dome_retained.invalidate();
+		}
 
+		if (_planet_textures)
+		{
+			auto& next_ground = _planet->next_ground;
 
-Shape
-RigidBodyPainter::compute_sky_dome_shape()
-{
-	_camera_position_for_sky_dome = _camera_placement.position();
+			// Take the ground shape computed in background, if it's ready:
+			if (next_ground.valid() && next_ground.wait_for (std::chrono::seconds (0)) == std::future_status::ready)
+				_planet->ground = next_ground.get();
 
-	if (_planet && _sun)
-	{
-		// With alpha 1.0 and being in space, the sky is a bit too bright.
-		// Tone it down a bit.
-		auto const sky_alpha = 1.0f - 0.1f * _planet->camera_clamped_normalized_amsl_height;
-
-		return xf::compute_sky_dome_shape ({
-			.atmospheric_scattering = _sun->atmospheric_scattering,
-			.observer_position = _camera_polar_position,
-			.sun_position = _sun->corrected_position_horizontal_coordinates,
-			.earth_radius = kEarthMeanRadius,
-			.earth_texture = _planet_textures ? _planet_textures->earth : nullptr,
-			.sky_alpha = sky_alpha,
-		}, &*_work_performer);
-		// TODO apply sky_correction to vertices' materials
+			if (!_planet->ground)
+			{
+				// Nothing to show in the meantime, so compute synchronously:
+				_planet->ground = compute_ground_shape (_camera_polar_position, kEarthMeanRadius, _planet_textures->earth);
+			}
+			else if (!next_ground.valid() && !is_ground_shape_up_to_date (*_planet->ground, _camera_polar_position, kEarthMeanRadius))
+			{
+				next_ground = _work_performer->submit ([observer_position = _camera_polar_position, earth_texture = _planet_textures->earth] {
+					return compute_ground_shape (observer_position, kEarthMeanRadius, earth_texture);
+				});
+			}
+		}
 	}
-	else
-		return {};
 }
 
 
@@ -1825,15 +1889,6 @@ RigidBodyPainter::compute_camera_transform()
 
 	fix_camera_position();
 
-	if (_planet)
-	{
-		if (abs (_camera_position_for_sky_dome - _camera_placement.position()) > 10_m)
-		{
-			_planet->sky_dome_shape.reset();
-			_planet->ground_shape.reset();
-		}
-	}
-
 	if (_camera_position_callback)
 		_camera_position_callback (_camera_placement.position());
 }
@@ -1907,6 +1962,32 @@ RigidBodyPainter::make_texture (QImage const& image)
 }
 
 
+std::shared_ptr<QOpenGLTexture>
+RigidBodyPainter::make_dust_texture()
+{
+	auto constexpr kSize = 64;
+	auto image = QImage (kSize, kSize, QImage::Format_ARGB32);
+
+	// Opaque core up to 0.45 of the radius, then fading linearly to fully transparent at the edge:
+	for (int y = 0; y < kSize; ++y)
+	{
+		for (int x = 0; x < kSize; ++x)
+		{
+			auto const r = std::hypot (x + 0.5 - 0.5 * kSize, y + 0.5 - 0.5 * kSize) / (0.5 * kSize);
+			auto const alpha = 0.9 * std::clamp ((1.0 - r) / (1.0 - 0.45), 0.0, 1.0);
+			image.setPixelColor (x, y, QColor::fromRgbF (1.0, 1.0, 1.0, alpha));
+		}
+	}
+
+	auto texture = std::make_shared<QOpenGLTexture> (QOpenGLTexture::Target2D);
+	texture->setData (image);
+	texture->setWrapMode (QOpenGLTexture::ClampToEdge);
+	texture->setMinificationFilter (QOpenGLTexture::LinearMipMapLinear);
+	texture->setMagnificationFilter (QOpenGLTexture::Linear);
+	return texture;
+}
+
+
 Shape
 RigidBodyPainter::make_sun_shines_shape()
 {
@@ -1978,4 +2059,83 @@ RigidBodyPainter::shape_for (rigid_body::Body const& body)
 	}
 }
 
+
+si::Length
+RigidBodyPainter::picking_bounding_sphere_radius (rigid_body::Body const& body)
+{
+	auto const& body_shape = shape_for (body);
+	auto& config = get_rendering_config (body);
+
+	// Default shapes are created once per body, so they're constant too:
+	if (!body.shape_is_constant() && body.shape())
+	{
+		config.picking_shape = nullptr;
+		return body.bounding_sphere_radius (body_shape);
+	}
+
+	if (config.picking_shape != &body_shape)
+	{
+		config.picking_shape = &body_shape;
+		config.bounding_sphere_radius.reset();
+		config.shape_bvh.reset();
+	}
+
+	if (!config.bounding_sphere_radius)
+		config.bounding_sphere_radius = body.bounding_sphere_radius (body_shape);
+
+	return *config.bounding_sphere_radius;
+}
+
+
+void
+RigidBodyPainter::update_picking_bvh (rigid_body::System const& system)
+{
+	using Box = decltype (_picking_bvh)::Box;
+
+	auto candidates = std::vector<PickingCandidate>();
+	candidates.reserve (_picking_candidates.size());
+
+	for (auto const& body_ptr: system.bodies())
+	{
+		auto& body = *body_ptr;
+
+		if (!get_rendering_config (body).body_visible)
+			continue;
+
+		// radius must be > 0_m, otherwise sphere intersection is degenerate
+		// (point sphere / empty geometry), so there is nothing meaningful to pick.
+		if (auto const radius = picking_bounding_sphere_radius (body); radius > 0_m)
+			candidates.push_back ({ &body, radius });
+	}
+
+	auto const box_for = [] (PickingCandidate const& candidate) {
+		auto const position = candidate.body->placement().position();
+		auto const r = candidate.bounding_sphere_radius;
+		auto const half_diagonal = SpaceLength<WorldSpace> (r, r, r);
+		return Box { position - half_diagonal, position + half_diagonal };
+	};
+
+	auto const same_bodies = std::ranges::equal (candidates, _picking_candidates, {}, &PickingCandidate::body, &PickingCandidate::body);
+	_picking_candidates = std::move (candidates);
+
+	if (same_bodies)
+	{
+		// Bodies only moved, so refitting the tree is enough:
+		for (std::size_t i = 0; i < _picking_candidates.size(); ++i)
+			_picking_bvh.update (i, box_for (_picking_candidates[i]));
+
+		_picking_bvh.refit();
+	}
+	else
+	{
+		auto boxes = std::vector<Box>();
+		boxes.reserve (_picking_candidates.size());
+
+		for (auto const& candidate: _picking_candidates)
+			boxes.push_back (box_for (candidate));
+
+		_picking_bvh.build (std::move (boxes));
+	}
+}
+
 } // namespace xf
@@ -17,9 +17,12 @@
 // Xefis:
 #include <xefis/config/all.h>
 #include <xefis/support/atmosphere/atmospheric_scattering.h>
+#include <xefis/support/atmosphere/sky_view_lut.h>
 #include <xefis/support/color/blackbody.h>
 #include <xefis/support/color/spaces.h>
+#include <xefis/support/math/bounding_volume_hierarchy.h>
 #include <xefis/support/math/rotations.h>
+#include <xefis/support/shapes/shape_bvh.h>
 #include <xefis/support/shapes/various_materials.h>
 #include <xefis/support/shapes/various_shapes.h>
 #include <xefis/support/simulation/rigid_body/system.h>
@@ -42,9 +45,12 @@
 #include <QSize>
 
 // Standard:
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <future>
 #include <map>
-#include <random>
+#include <vector>
 #include <utility>
 #include <variant>
 
@@ -61,6 +67,7 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	static constexpr si::Length	kDefaultConstraintDiameter	= 1.5_cm;
 	static constexpr si::Length	kDefaultHingeDiameter		= 3_cm;
 	static constexpr si::Length	kMinDustGridSize			= 2.5_m;
+	static constexpr int64_t	kDustGridRange				= 3; // In grid cells from the followed object.
 
 	static constexpr auto		kAtmosphereRadius			= kEarthMeanRadius + 50_km;
 	static constexpr auto		kSunRadius					= 696'340_km;
@@ -155,8 +162,13 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	struct Planet
 	{
 		rigid_body::Body const*	body				{ nullptr };
-		std::optional<Shape>	sky_dome_shape;
-		std::optional<Shape>	ground_shape;
+		SkyDome					sky_dome;
+		GLSpace::RetainedShape	sky_dome_retained;
+		std::optional<GroundShape>
+								ground;
+		// Ground shape computed in the background; the current one is used until it's ready:
+		std::future<GroundShape>
+								next_ground;
 		// Angle of horizon (always below 0°) as viewed from the camera position:
 		si::Angle				horizon_angle		{ 0_deg };
 		float					camera_normalized_amsl_height			{ 0.0f };
@@ -181,7 +193,10 @@ class RigidBodyPainter: protected QOpenGLFunctions
 			.atmosphere_radius = kAtmosphereRadius,
 			.enable_tonemapping = true,
 		}};
+		// Must be declared after atmospheric_scattering:
+		SkyViewLUT					sky_view_lut			{ atmospheric_scattering, {} };
 		Shape						face_shape				{ make_solid_circle (kSunRadius, { 0_deg, 360_deg }, 19, kWhiteMatte) };
+		GLSpace::RetainedShape		face_retained;
 		Shape						shines_shape			{ make_sun_shines_shape() };
 		float						brightness_factor		{ 1.0f };
 	};
@@ -193,9 +208,21 @@ class RigidBodyPainter: protected QOpenGLFunctions
 		std::optional<float>		brightness_factor;
 	};
 
+	struct AirParticles
+	{
+		// Grid cell around which the particles were generated, in grid-size units:
+		std::array<int64_t, 3>				center_cell;
+		si::Length							grid_size;
+		// Particle positions relative to the center cell, drawn as point sprites:
+		GLSpace::RetainedPoints				positions;
+		// Blurred circle drawn for each particle:
+		std::shared_ptr<QOpenGLTexture>		texture;
+	};
+
 	struct Universe
 	{
 		std::optional<Shape>			sky_box_shape;
+		GLSpace::RetainedShape			sky_box_retained;
 		RotationQuaternion<WorldSpace>	ecef_to_celestial_rotation;
 	};
 
@@ -227,6 +254,18 @@ class RigidBodyPainter: protected QOpenGLFunctions
 
 		// Created and used for bodies that don't have any shape:
 		std::optional<Shape>	default_body_shape;
+		// Vertex buffer for body shape if it's constant:
+		GLSpace::RetainedShape	retained_shape;
+		// Picking data cached for constant shapes, valid as long as shape_for() returns picking_shape:
+		Shape const*	picking_shape { nullptr };
+		std::optional<si::Length>	bounding_sphere_radius;
+		std::optional<ShapeBVH>	shape_bvh;
+	};
+
+	struct PickingCandidate
+	{
+		rigid_body::Body*	body;
+		si::Length			bounding_sphere_radius;
 	};
 
   public:
@@ -648,7 +687,7 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	paint_helpers (rigid_body::System const&);
 
 	void
-	paint (rigid_body::Body const&, BodyRenderingConfig const&);
+	paint (rigid_body::Body const&, BodyRenderingConfig&);
 
 	void
 	paint (rigid_body::Constraint const&);
@@ -769,19 +808,12 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	check_universe_textures();
 
 	/**
-	 * Check if computation of new SkyDome was requested.
-	 * Also if it has been finished, start using it.
+	 * Update the sky dome incrementally and check if the ground shape needs to be recomputed.
+	 * Also if the ground computation has been finished, start using it.
 	 */
 	void
 	check_sky_dome_and_ground_shape();
 
-	/**
-	 * \threadsafe	As long as atmospheric_scattering is unmodified.
-	 */
-	[[nodiscard]]
-	Shape
-	compute_sky_dome_shape();
-
 	/**
 	 * Check whether sky box can be computed, and if so, compute it.
 	 */
@@ -841,6 +873,13 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	static std::shared_ptr<QOpenGLTexture>
 	make_texture (QImage const& image);
 
+	/**
+	 * Make texture of a blurred white circle for air particle point sprites.
+	 */
+	[[nodiscard]]
+	static std::shared_ptr<QOpenGLTexture>
+	make_dust_texture();
+
 	[[nodiscard]]
 	static Shape
 	make_sun_shines_shape();
@@ -861,6 +900,20 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	Shape const&
 	shape_for (rigid_body::Body const&);
 
+	/**
+	 * Return bounding sphere radius of the body, cached if body shape is constant.
+	 */
+	[[nodiscard]]
+	si::Length
+	picking_bounding_sphere_radius (rigid_body::Body const&);
+
+	/**
+	 * Update list of pickable bodies and the BVH over their bounding spheres.
+	 * The tree is only refitted if the set of bodies hasn't changed.
+	 */
+	void
+	update_picking_bvh (rigid_body::System const&);
+
   private:
 	si::PixelDensity				_pixel_density;
 	si::Angle						_fov						{ 40_deg };
@@ -883,7 +936,6 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	// Final computed camera rotation:
 	Placement<WorldSpace, WorldSpace>
 									_camera_placement;
-	SpaceLength<WorldSpace>			_camera_position_for_sky_dome;
 	// Position of the followed body:
 	SpaceLength<WorldSpace>			_followed_position;
 	si::LonLatRadius<>				_followed_polar_position;
@@ -900,7 +952,9 @@ class RigidBodyPainter: protected QOpenGLFunctions
 									_group_rendering_config;
 	std::map<rigid_body::Body const*, BodyRenderingConfig>
 									_body_rendering_config;
-	std::minstd_rand0				_air_particles_prng;
+	std::vector<PickingCandidate>	_picking_candidates;
+	BoundingVolumeHierarchy<si::Length, WorldSpace>
+									_picking_bvh;
 	std::map<rigid_body::Group const*, SpaceLength<WorldSpace>>
 									_group_centers_of_mass_cache;
 
@@ -916,11 +970,13 @@ class RigidBodyPainter: protected QOpenGLFunctions
 	std::optional<PlanetTextures>	_planet_textures;
 	std::optional<UniverseTextures>	_universe_textures;
 	std::optional<Shape>			_moon_shape;
+	GLSpace::RetainedShape			_moon_retained;
 
 	// Some cached computations:
 	std::optional<si::Angle>		_sun_altitude_above_horizon;
 	float							_sky_box_visibility			{ 1.0f };
-	Shape							_dust_particle;
+	si::Length						_dust_particle_radius		{ 2_cm };
+	std::optional<AirParticles>		_air_particles;
 	si::Length						_followed_object_diameter	{ 0_m };
 	Shape							_ecef_basis					{ make_basis (8_cm) };
 	Shape							_body_basis					{ make_basis (1_cm) };
@@ -24,9 +24,13 @@
 
 // Standard:
 #include <cstddef>
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <ranges>
 
 
 namespace xf {
@@ -72,6 +76,18 @@ compute_angle_from_center_viewpoint (si::Angle const view_angle, si::Length cons
 }
 
 
+/**
+ * Return distance to the horizon for an observer at given distance from the center of the sphere.
+ * Return 0 if the observer is below the surface.
+ */
+[[nodiscard]]
+si::Length
+compute_horizon_distance (si::Length const sphere_radius, si::Length const distance_from_center)
+{
+	return sphere_radius * std::sqrt (std::max (0.0, nu::square (distance_from_center / sphere_radius) - 1.0));
+}
+
+
 [[nodiscard]]
 LonLatRanges
 compute_visible_lon_lat_ranges (si::Angle const horizon_angle, si::Length const earth_radius, si::LonLatRadius<> const observer_position)
@@ -247,9 +263,9 @@ compute_sun_position (si::LonLat const observer_position, si::Time const time) /
 
 
 SpaceVector<float, RGBSpace>
-compute_sun_light_color (si::LonLatRadius<> const observer_position, SpaceVector<double> const sun_position, AtmosphericScattering const& atmospheric_scattering)
+compute_sun_light_color (SkyViewLUT const& sky_view_lut)
 {
-	return atmospheric_scattering.compute_incident_light ({ 0_m, 0_m, observer_position.radius() }, sun_position, sun_position);
+	return sky_view_lut.sun_light();
 }
 
 
@@ -267,20 +283,28 @@ compute_moon_position (si::Time const time) // TODO double days_since_J2000
 }
 
 
-Shape
+GroundShape
 compute_ground_shape (si::LonLatRadius<> const observer_position,
 					  si::Length const earth_radius,
 					  std::shared_ptr<QOpenGLTexture> earth_texture)
 {
+	auto const horizon_distance = compute_horizon_distance (earth_radius, observer_position.radius());
+	auto result = GroundShape {
+		.observer_position = observer_position,
+		.horizon_distance = horizon_distance,
+		.margin = std::max<si::Length> (0.05 * horizon_distance, 10_m),
+	};
+
 	if (auto const horizon_angle = compute_horizon_angle (earth_radius, observer_position.radius());
 		isfinite (horizon_angle))
 	{
-		auto const ss = compute_ground_slices_and_stacks (horizon_angle, earth_radius, observer_position);
+		// Extend the visible ranges by the margin:
+		auto const ss = compute_ground_slices_and_stacks (horizon_angle - 1_rad * (result.margin / earth_radius), earth_radius, observer_position);
 
 		if (ss.slice_angles.empty())
-			return {};
+			return result;
 
-		return make_centered_irregular_sphere_shape ({
+		result.shape = make_centered_irregular_sphere_shape ({
 			.radius = earth_radius,
 			.slice_angles = ss.slice_angles,
 			.stack_angles = ss.stack_angles,
@@ -295,13 +319,25 @@ compute_ground_shape (si::LonLatRadius<> const observer_position,
 			},
 		});
 	}
-	else
-		return {};
+
+	return result;
 }
 
 
-Shape
-compute_sky_dome_shape (SkyDomeParameters const& p, nu::WorkPerformer* const work_performer)
+bool
+is_ground_shape_up_to_date (GroundShape const& ground, si::LonLatRadius<> const observer_position, si::Length const earth_radius)
+{
+	// Moving horizontally shifts the horizon by the same distance; moving vertically changes the horizon distance.
+	// Also recompute the shape when the horizon gets closer, so that the mesh doesn't get too coarse:
+	auto const shift = abs (to_cartesian (observer_position) - to_cartesian (ground.observer_position));
+	auto const horizon_distance_change = abs (compute_horizon_distance (earth_radius, observer_position.radius()) - ground.horizon_distance);
+
+	return shift + horizon_distance_change <= ground.margin;
+}
+
+
+bool
+SkyDome::update (SkyDomeParameters const& p)
 {
 	auto horizon_angle = compute_horizon_angle (p.earth_radius, p.observer_position.radius());
 
@@ -309,72 +345,82 @@ compute_sky_dome_shape (SkyDomeParameters const& p, nu::WorkPerformer* const wor
 	if (!isfinite (horizon_angle))
 		horizon_angle = 0_deg;
 
-	auto const ss = compute_dome_slices_and_stacks (horizon_angle);
-	auto const cartesian_sun_position = compute_cartesian_horizontal_coordinates (p.sun_position);
-	auto shape = make_centered_irregular_sphere_shape ({
-		.radius = p.earth_radius, // TODO 10 mm around the camera
-		.slice_angles = ss.slice_angles,
-		.stack_angles = ss.stack_angles,
-		.material = kBlackMatte,
-		.symmetric_0_180 = true,
-		.optimize_poles = 0.01_deg,
-		.setup_material = [&] (ShapeMaterial& material, si::LonLat const sphere_position, nu::WaitGroup::WorkToken&& work_token) {
-			// The shape originally assumes that the sun is always at 0° (more dense net is around 0°).
-			// This needs a correction when used with AtmosphericScattering so that the sun is also always at 0° to match the mesh:
-			auto const sky_position = si::LonLat (sphere_position.lon() + 180_deg - p.sun_position.azimuth, sphere_position.lat());
-			auto compute = [=, &material, &p, work_token = std::move (work_token)] {
-				if (sky_position.lat() >= horizon_angle)
-				{
-					// Sky:
-					auto const polar_ray_direction = si::LonLat (sky_position.lon(), sky_position.lat());
-					auto const ray_direction = to_cartesian<void> (polar_ray_direction);
-					auto const color = p.atmospheric_scattering.compute_incident_light(
-						{ 0_m, 0_m, p.observer_position.radius() },
-						ray_direction,
-						cartesian_sun_position
-					);
-					material.gl_emission_color = to_gl_color (color);
-					material.gl_emission_color[3] = p.sky_alpha;
-				}
-				else
-				{
-					// Ground haze:
-					auto const cartesian_observer_position = SpaceLength (0_m, 0_m, p.observer_position.radius());
-					auto const polar_ray_direction = si::LonLat (sky_position.lon(), sky_position.lat());
-					auto const ray_direction = to_cartesian<void> (polar_ray_direction);
-					si::Length max_distance = std::numeric_limits<si::Length>::infinity();
-
-					if (auto const intersections = p.atmospheric_scattering.ray_sphere_intersections (cartesian_observer_position, ray_direction, p.earth_radius))
-					{
-						// If the ray intersects the Earth's sphere (planetary body) and the intersection is ahead of the camera:
-						if (intersections->second > 0_m)
-							// Limit the ray's effective length to the first intersection point.
-							max_distance = std::max (0_m, intersections->first);
-					}
-
-					auto const color = p.atmospheric_scattering.compute_incident_light(
-						cartesian_observer_position,
-						ray_direction,
-						cartesian_sun_position,
-						0_m,
-						max_distance
-					);
-					material.gl_emission_color = to_gl_color (color);
-					material.gl_emission_color[3] = p.ground_haze_alpha;
-				}
-			};
-
-			if (work_performer)
-				work_performer->submit (std::move (compute));
-			else
-				compute();
-		},
-	});
-
-	// Since the shape assumed sun always at 0° in its spherical coordinates, we need to actually rotate it now to match the real position of the sun:
-	shape.rotate (z_rotation<BodyOrigin> (180_deg - p.sun_position.azimuth));
-
-	return shape;
+	auto const horizon_angle_bucket = static_cast<int64_t> (std::llround (horizon_angle / kHorizonAngleBucket));
+	auto changed = false;
+
+	if (horizon_angle_bucket != _horizon_angle_bucket)
+	{
+		auto const new_horizon_angle = kHorizonAngleBucket * horizon_angle_bucket;
+		auto const ss = compute_dome_slices_and_stacks (new_horizon_angle);
+		auto shape = make_centered_irregular_sphere_shape ({
+			.radius = p.earth_radius, // TODO 10 mm around the camera
+			.slice_angles = ss.slice_angles,
+			.stack_angles = ss.stack_angles,
+			.material = kBlackMatte,
+			.symmetric_0_180 = true,
+		});
+
+		auto const same_topology = std::ranges::equal (shape.triangle_strips(), _shape.triangle_strips(), {},
+													   [] (auto const& strip) { return strip.vertices.size(); },
+													   [] (auto const& strip) { return strip.vertices.size(); });
+
+		if (same_topology)
+		{
+			// Vertices moved only slightly, so use previous colors until they're recomputed:
+			for (auto const [new_strip, old_strip]: std::views::zip (shape.triangle_strips(), _shape.triangle_strips()))
+				for (auto const [new_vertex, old_vertex]: std::views::zip (new_strip.vertices, old_strip.vertices))
+					new_vertex.material() = old_vertex.material();
+		}
+
+		_shape = std::move (shape);
+		_horizon_angle = new_horizon_angle;
+		_horizon_angle_bucket = horizon_angle_bucket;
+		_next_strip_to_color = 0;
+		changed = true;
+
+		// There's nothing to show in the meantime:
+		if (!same_topology)
+			color_strips (p, std::numeric_limits<std::size_t>::max());
+	}
+
+	if (_next_strip_to_color < _shape.triangle_strips().size())
+	{
+		color_strips (p, kVerticesPerUpdate);
+		changed = true;
+	}
+
+	return changed;
+}
+
+
+void
+SkyDome::color_strips (SkyDomeParameters const& p, std::size_t const max_vertices)
+{
+	// The LUT only uses the sun azimuth, and in the shape the sun is always at longitude 0°:
+	auto const sun_direction = SpaceVector<double> { 1.0, 0.0, 0.0 };
+	auto const sin_horizon_angle = sin (_horizon_angle);
+	auto& strips = _shape.triangle_strips();
+	auto n_vertices = std::size_t (0);
+
+	for (; _next_strip_to_color < strips.size() && n_vertices < max_vertices; ++_next_strip_to_color)
+	{
+		auto& vertices = strips[_next_strip_to_color].vertices;
+
+		for (auto& vertex: vertices)
+		{
+			// Normals of a centered sphere point away from the center, that is along the view rays:
+			auto const ray_direction = math::coordinate_system_cast<void, void, BodyOrigin, void> (*vertex.normal());
+			// Rays below the horizon (ground haze) are already limited by the ground in the LUT:
+			auto const color = p.sky_view_lut.incident_light (ray_direction, sun_direction);
+			auto& material = vertex.material();
+			material.gl_emission_color = to_gl_color (color);
+			material.gl_emission_color[3] = ray_direction.z() >= sin_horizon_angle
+				? p.sky_alpha
+				: p.ground_haze_alpha;
+		}
+
+		n_vertices += vertices.size();
+	}
 }
 
 } // namespace xf
@@ -16,19 +16,18 @@
 
 // Xefis:
 #include <xefis/config/all.h>
-#include <xefis/support/atmosphere/atmospheric_scattering.h>
+#include <xefis/support/atmosphere/sky_view_lut.h>
 #include <xefis/support/color/spaces.h>
 #include <xefis/support/shapes/shape.h>
 #include <xefis/support/universe/moon_position.h>
 #include <xefis/support/universe/sun_position.h>
 
-// Neutrino:
-#include <neutrino/work_performer.h>
-
 // Standard:
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <future>
+#include <optional>
 
 
 namespace xf {
@@ -52,13 +51,12 @@ struct MoonPosition
 
 struct SkyDomeParameters
 {
-	AtmosphericScattering const&	atmospheric_scattering;
-	si::LonLatRadius<>				observer_position;
-	HorizontalCoordinates			sun_position;
-	si::Length						earth_radius;
-	std::shared_ptr<QOpenGLTexture>	earth_texture;
-	float							sky_alpha			{ 1.0f };
-	float							ground_haze_alpha	{ 0.7f };
+	// Must be updated for the observer_position and the current sun position:
+	SkyViewLUT const&	sky_view_lut;
+	si::LonLatRadius<>	observer_position;
+	si::Length			earth_radius;
+	float				sky_alpha			{ 1.0f };
+	float				ground_haze_alpha	{ 0.7f };
 };
 
 
@@ -72,21 +70,112 @@ MoonPosition
 compute_moon_position (si::Time const time);
 
 
+/**
+ * Return color of the sunlight for the observer and the sun position the LUT was updated for.
+ */
 [[nodiscard]]
 SpaceVector<float, RGBSpace>
-compute_sun_light_color (si::LonLatRadius<> const observer_position, SpaceVector<double> const sun_position, AtmosphericScattering const&);
+compute_sun_light_color (SkyViewLUT const&);
+
+
+/**
+ * Ground shape together with the observer position it was computed for.
+ */
+struct GroundShape
+{
+	Shape				shape;
+	si::LonLatRadius<>	observer_position;
+	si::Length			horizon_distance;
+	// Margin added around the ground visible from observer_position:
+	si::Length			margin;
+};
 
 
+/**
+ * Compute shape of the ground visible from the observer position, with some margin
+ * so that the observer can move a bit before the shape has to be recomputed.
+ */
 [[nodiscard]]
-Shape
+GroundShape
 compute_ground_shape (si::LonLatRadius<> const observer_position,
 					  si::Length const earth_radius,
 					  std::shared_ptr<QOpenGLTexture> earth_texture);
 
 
+/**
+ * Return true if the ground shape can still be used for the observer position: it covers all ground
+ * visible from there and hasn't become too large for it.
+ */
 [[nodiscard]]
-Shape
-compute_sky_dome_shape (SkyDomeParameters const& params, nu::WorkPerformer* work_performer = nullptr);
+bool
+is_ground_shape_up_to_date (GroundShape const&, si::LonLatRadius<> const observer_position, si::Length const earth_radius);
+
+
+/**
+ * Sky dome shape that is updated incrementally instead of being recomputed as a whole.
+ *
+ * The mesh is built with the sun at longitude 0° and must be rotated by 180° - sun azimuth when painted,
+ * so changes of sun azimuth don't require any update. Vertex positions depend only on the horizon angle
+ * and are recomputed when it moves to another bucket; as long as the number of stacks doesn't change,
+ * previous vertex colors are kept until they're recomputed. Colors are sampled from the sky-view LUT
+ * and are recomputed after invalidate_colors(), a few triangle strips per update() call.
+ */
+class SkyDome
+{
+  public:
+	// Size of horizon angle bucket; vertex positions are recomputed when the horizon angle moves to another bucket:
+	static constexpr si::Angle		kHorizonAngleBucket	= 0.05_deg;
+	// Approximate number of vertices to recolor in one update() call:
+	static constexpr std::size_t	kVerticesPerUpdate	= 2000;
+
+  public:
+	/**
+	 * Update vertex positions and colors if needed.
+	 * Only the first call (or one that changes the number of stacks) computes all colors at once.
+	 *
+	 * \return	true if the shape has changed.
+	 */
+	bool
+	update (SkyDomeParameters const&);
+
+	/**
+	 * Make update() recompute all vertex colors, eg. after the sky-view LUT has been rebuilt.
+	 */
+	void
+	invalidate_colors() noexcept
+		{ _next_strip_to_color = 0; }
+
+	/**
+	 * Return true if the shape has been computed.
+	 */
+	[[nodiscard]]
+	bool
+	ready() const noexcept
+		{ return _horizon_angle_bucket.has_value(); }
+
+	/**
+	 * Return the dome shape. The sun is at longitude 0° of the shape.
+	 */
+	[[nodiscard]]
+	Shape const&
+	shape() const noexcept
+		{ return _shape; }
+
+  private:
+	/**
+	 * Recompute colors of triangle strips starting from _next_strip_to_color,
+	 * until at least max_vertices vertices are done.
+	 */
+	void
+	color_strips (SkyDomeParameters const&, std::size_t max_vertices);
+
+  private:
+	Shape					_shape;
+	std::optional<int64_t>	_horizon_angle_bucket;
+	// Horizon angle for which vertex positions were computed:
+	si::Angle				_horizon_angle			{ 0_deg };
+	std::size_t				_next_strip_to_color	{ 0 };
+};
 
 
 // TODO to universe/coordinate_systems.h (.to_ecef()?)
@@ -0,0 +1,194 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "magnetic_variation_grid.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/numeric.h>
+
+// Standard:
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+
+namespace xf {
+
+void
+MagneticVariationGrid::set_date (int const year, int const month, int const day)
+{
+	auto const julian_date = _implementation.yymmdd_to_julian_days (year, month, day);
+
+	if (julian_date == (_pending_tiles ? _pending_julian_date : _julian_date))
+		return;
+
+	// Note that replacing a pending future waits for its task to finish; that happens only
+	// if the date changes again before tiles for the previous change are ready.
+	if (_tiles.empty())
+	{
+		_pending_tiles.reset();
+		_julian_date = julian_date;
+	}
+	else
+	{
+		auto keys = std::vector<TileKey>();
+
+		for (auto const& [key, tile]: _tiles)
+			keys.push_back (key);
+
+		_pending_julian_date = julian_date;
+		_pending_tiles = std::async (std::launch::async, [keys = std::move (keys), julian_date] {
+			// MagneticVariationImpl keeps intermediate results in its members, so use a separate one:
+			auto implementation = MagneticVariationImpl();
+			auto tiles = Tiles();
+
+			for (auto const& key: keys)
+				tiles[key] = compute_tile (implementation, key, julian_date);
+
+			return tiles;
+		});
+	}
+}
+
+
+MagneticVariationGrid::Result
+MagneticVariationGrid::compute (si::LonLat const& position, si::Length const altitude_amsl)
+{
+	collect_pending_tiles();
+
+	// Tiles never reach the poles, where calc_magvar() isn't defined:
+	if (abs (position.lat()) >= kMaxGridLatitude)
+		return to_result (compute_field (_implementation, position, altitude_amsl, _julian_date));
+
+	auto const lon = nu::floored_mod (position.lon() + 180_deg, 360_deg) - 180_deg;
+	auto const lat_in_tiles = position.lat() / kTileSize;
+	auto const lon_in_tiles = lon / kTileSize;
+	auto const altitude_in_tiles = altitude_amsl / kAltitudeSpacing;
+	auto const key = TileKey {
+		static_cast<int> (std::floor (lat_in_tiles)),
+		static_cast<int> (std::floor (lon_in_tiles)),
+		static_cast<int> (std::floor (altitude_in_tiles)),
+	};
+	auto const& nodes = tile (key).nodes;
+
+	// Position within the tile in units of node spacing:
+	auto const lat_in_nodes = (lat_in_tiles - key[0]) * (kTileNodes - 1);
+	auto const lon_in_nodes = (lon_in_tiles - key[1]) * (kTileNodes - 1);
+	auto const i = std::min (static_cast<std::size_t> (lat_in_nodes), kTileNodes - 2);
+	auto const j = std::min (static_cast<std::size_t> (lon_in_nodes), kTileNodes - 2);
+	double const weights[3][2] = {
+		{ 1.0 - (altitude_in_tiles - key[2]), altitude_in_tiles - key[2] },
+		{ 1.0 - (lat_in_nodes - i), lat_in_nodes - i },
+		{ 1.0 - (lon_in_nodes - j), lon_in_nodes - j },
+	};
+
+	auto field = Field { 0.0, 0.0, 0.0 };
+
+	for (std::size_t a = 0; a < 2; ++a)
+	{
+		for (std::size_t b = 0; b < 2; ++b)
+		{
+			for (std::size_t c = 0; c < 2; ++c)
+			{
+				auto const weight = weights[0][a] * weights[1][b] * weights[2][c];
+				auto const& node = nodes[a][i + b][j + c];
+
+				for (std::size_t k = 0; k < 3; ++k)
+					field[k] += weight * node[k];
+			}
+		}
+	}
+
+	return to_result (field);
+}
+
+
+void
+MagneticVariationGrid::collect_pending_tiles()
+{
+	using namespace std::chrono_literals;
+
+	if (_pending_tiles && _pending_tiles->wait_for (0s) == std::future_status::ready)
+	{
+		// Tiles computed in the meantime for the previous date are dropped and will be computed again when needed:
+		_tiles = _pending_tiles->get();
+		_julian_date = _pending_julian_date;
+		_pending_tiles.reset();
+	}
+}
+
+
+MagneticVariationGrid::Tile const&
+MagneticVariationGrid::tile (TileKey const& key)
+{
+	auto& tile = _tiles[key];
+
+	if (!tile)
+		tile = compute_tile (_implementation, key, _julian_date);
+
+	return *tile;
+}
+
+
+std::shared_ptr<MagneticVariationGrid::Tile const>
+MagneticVariationGrid::compute_tile (MagneticVariationImpl& implementation, TileKey const& key, uint64_t const julian_date)
+{
+	auto tile = std::make_shared<Tile>();
+
+	for (std::size_t a = 0; a < 2; ++a)
+	{
+		auto const altitude = kAltitudeSpacing * (key[2] + static_cast<int> (a));
+
+		for (std::size_t i = 0; i < kTileNodes; ++i)
+		{
+			auto const lat = kTileSize * key[0] + kNodeSpacing * i;
+
+			for (std::size_t j = 0; j < kTileNodes; ++j)
+			{
+				auto const lon = kTileSize * key[1] + kNodeSpacing * j;
+				tile->nodes[a][i][j] = compute_field (implementation, si::LonLat (lon, lat), altitude, julian_date);
+			}
+		}
+	}
+
+	return tile;
+}
+
+
+MagneticVariationGrid::Field
+MagneticVariationGrid::compute_field (MagneticVariationImpl& implementation, si::LonLat const& position, si::Length const altitude_amsl, uint64_t const julian_date)
+{
+	double field[6];
+	implementation.calc_magvar (position.lat().in<si::Radian>(), position.lon().in<si::Radian>(), altitude_amsl.in<si::Kilometer>(), julian_date, field);
+	return { field[3], field[4], field[5] };
+}
+
+
+MagneticVariationGrid::Result
+MagneticVariationGrid::to_result (Field const& field)
+{
+	auto const [north, east, down] = field;
+
+	// Same as MagneticVariationImpl::calc_magvar(), zero declination at magnetic poles:
+	return {
+		.magnetic_declination = 1_rad * (north != 0.0 || east != 0.0 ? std::atan2 (east, north) : 0.0),
+		.magnetic_inclination = 1_rad * std::atan (down / std::hypot (north, east)),
+	};
+}
+
+} // namespace xf
@@ -0,0 +1,142 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__UNIVERSE__EARTH__MAGNETIC_VARIATION_GRID_H__INCLUDED
+#define XEFIS__SUPPORT__UNIVERSE__EARTH__MAGNETIC_VARIATION_GRID_H__INCLUDED
+
+// Local:
+#include "magnetic_variation.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Standard:
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+namespace xf {
+
+/**
+ * Magnetic field model evaluated on a lat/lon/altitude grid and interpolated trilinearly.
+ * Grid nodes hold north/east/down field components (interpolating angles would break where they wrap).
+ *
+ * The grid is split into tiles which are computed when first needed. When the date changes,
+ * tiles already in use are recomputed on a background thread and previous ones are used until
+ * new ones are ready.
+ *
+ * Within kMaxGridLatitude declination and inclination differ from MagneticVariation by less than
+ * kAccuracy. Closer to the poles, where field direction changes too quickly for the grid,
+ * results are computed directly.
+ *
+ * Not thread-safe.
+ */
+class MagneticVariationGrid
+{
+  public:
+	static constexpr si::Angle	kNodeSpacing		= 0.5_deg;
+	static constexpr si::Length	kAltitudeSpacing	= 10_km;
+	static constexpr si::Angle	kTileSize			= 10_deg;
+	static constexpr si::Angle	kMaxGridLatitude	= 80_deg;
+	static constexpr si::Angle	kAccuracy			= 0.05_deg;
+
+	struct Result
+	{
+		si::Angle	magnetic_declination;
+		si::Angle	magnetic_inclination;
+	};
+
+  private:
+	static constexpr std::size_t kTileNodes = static_cast<std::size_t> (kTileSize / kNodeSpacing) + 1;
+
+	// North, east and down components of the field:
+	using Field = std::array<double, 3>;
+
+	// Latitude, longitude and altitude indices of a tile:
+	using TileKey = std::array<int, 3>;
+
+	struct Tile
+	{
+		// Indexed by [altitude][latitude][longitude]:
+		std::array<std::array<std::array<Field, kTileNodes>, kTileNodes>, 2>	nodes;
+	};
+
+	using Tiles = std::map<TileKey, std::shared_ptr<Tile const>>;
+
+  public:
+	/**
+	 * Set date. Supported years: 1950…2049.
+	 * If tiles have already been computed for another date, they're recomputed in the background.
+	 */
+	void
+	set_date (int year, int month, int day);
+
+	/**
+	 * Return magnetic declination and inclination at given position.
+	 * May compute a new tile if position is outside of tiles computed so far.
+	 * set_date() must be called first.
+	 */
+	[[nodiscard]]
+	Result
+	compute (si::LonLat const& position, si::Length altitude_amsl);
+
+	/**
+	 * Return true if tiles are being recomputed for a new date.
+	 */
+	[[nodiscard]]
+	bool
+	updating() const noexcept
+		{ return _pending_tiles.has_value(); }
+
+  private:
+	/**
+	 * Use tiles computed in the background, if they're ready.
+	 */
+	void
+	collect_pending_tiles();
+
+	/**
+	 * Return tile with given key, computing it if necessary.
+	 */
+	Tile const&
+	tile (TileKey const&);
+
+	[[nodiscard]]
+	static std::shared_ptr<Tile const>
+	compute_tile (MagneticVariationImpl&, TileKey const&, uint64_t julian_date);
+
+	[[nodiscard]]
+	static Field
+	compute_field (MagneticVariationImpl&, si::LonLat const&, si::Length altitude_amsl, uint64_t julian_date);
+
+	[[nodiscard]]
+	static Result
+	to_result (Field const&);
+
+  private:
+	uint64_t							_julian_date			{ 0 };
+	uint64_t							_pending_julian_date	{ 0 };
+	Tiles								_tiles;
+	std::optional<std::future<Tiles>>	_pending_tiles;
+	MagneticVariationImpl				_implementation;
+};
+
+} // namespace xf
+
+#endif
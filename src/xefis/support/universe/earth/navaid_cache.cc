@@ -0,0 +1,438 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "navaid_cache.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/qt/qstring.h>
+
+// Qt:
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+
+
+namespace xf {
+namespace {
+
+constexpr std::array<char, 8>	kMagic			{ 'X', 'F', 'N', 'A', 'V', 'D', 'B', '\0' };
+constexpr uint32_t				kFormatVersion	= 2;
+// Detects cache files written on a machine with different endianness:
+constexpr uint32_t				kByteOrderMark	= 0x01020304;
+
+
+struct Header
+{
+	std::array<char, 8>	magic;
+	uint32_t			format_version;
+	uint32_t			byte_order_mark;
+	uint64_t			sources_count;
+	uint64_t			navaids_count;
+	uint64_t			runways_count;
+	uint64_t			strings_count;
+	uint64_t			characters_count;
+};
+
+
+/**
+ * Navaid, with strings stored as indices into the string table.
+ */
+struct NavaidRecord
+{
+	double		lon_deg;
+	double		lat_deg;
+	double		range_m;
+	double		frequency_hz;
+	double		slaved_variation_deg;
+	double		elevation_m;
+	double		true_bearing_deg;
+	uint32_t	identifier;
+	uint32_t	name;
+	uint32_t	icao;
+	uint32_t	runway_id;
+	uint32_t	runways_begin;
+	uint32_t	runways_count;
+	uint8_t		type;
+	uint8_t		vor_type;
+	uint8_t		padding[6];
+};
+
+
+struct RunwayRecord
+{
+	double		lon_1_deg;
+	double		lat_1_deg;
+	double		lon_2_deg;
+	double		lat_2_deg;
+	double		width_m;
+	uint32_t	identifier_1;
+	uint32_t	identifier_2;
+};
+
+
+// Sections are placed one after another, so each must keep the next one aligned:
+static_assert (sizeof (Header) % 8 == 0);
+static_assert (sizeof (NavaidCache::SourceDigest) % 8 == 0);
+static_assert (sizeof (NavaidRecord) % 8 == 0);
+static_assert (sizeof (RunwayRecord) % 8 == 0);
+static_assert (std::is_trivially_copyable_v<NavaidRecord> && std::is_trivially_copyable_v<RunwayRecord>);
+
+
+/**
+ * Reads consecutive sections of the mapped file, checking that they don't exceed its size.
+ */
+class SectionReader
+{
+  public:
+	// Ctor
+	explicit
+	SectionReader (uchar const* data, std::size_t size):
+		_data (data),
+		_size (size)
+	{ }
+
+	template<class Element>
+		std::span<Element const>
+		read (std::size_t count);
+
+  private:
+	uchar const*	_data;
+	std::size_t		_size;
+	std::size_t		_offset		{ 0 };
+};
+
+
+template<class Element>
+	inline std::span<Element const>
+	SectionReader::read (std::size_t const count)
+	{
+		if (count > (_size - _offset) / sizeof (Element))
+			throw NavaidCacheException ("navaid cache file is truncated");
+
+		auto const* const begin = reinterpret_cast<Element const*> (_data + _offset);
+		_offset += count * sizeof (Element);
+		return { begin, count };
+	}
+
+
+/**
+ * Builds the string table, storing each distinct string only once.
+ */
+class StringTableBuilder
+{
+  public:
+	// Ctor
+	StringTableBuilder()
+		{ intern (QString()); }
+
+	/**
+	 * Return index of the string in the table.
+	 */
+	uint32_t
+	intern (QString const&);
+
+	std::vector<uint32_t> const&
+	offsets() const noexcept
+		{ return _offsets; }
+
+	std::vector<char16_t> const&
+	characters() const noexcept
+		{ return _characters; }
+
+  private:
+	std::unordered_map<QString, uint32_t>	_indices;
+	std::vector<uint32_t>					_offsets	{ 0 };
+	std::vector<char16_t>					_characters;
+};
+
+
+uint32_t
+StringTableBuilder::intern (QString const& string)
+{
+	auto const [it, inserted] = _indices.try_emplace (string, static_cast<uint32_t> (_offsets.size() - 1));
+
+	if (inserted)
+	{
+		auto const* const utf16 = reinterpret_cast<char16_t const*> (string.utf16());
+		_characters.insert (_characters.end(), utf16, utf16 + string.size());
+		_offsets.push_back (static_cast<uint32_t> (_characters.size()));
+	}
+
+	return it->second;
+}
+
+
+template<class Element>
+	void
+	write_section (QSaveFile& file, std::span<Element const> const elements)
+	{
+		auto const bytes = static_cast<qint64> (elements.size_bytes());
+
+		if (file.write (reinterpret_cast<char const*> (elements.data()), bytes) != bytes)
+			throw NavaidCacheException ("could not write navaid cache: " + file.errorString().toStdString());
+	}
+
+
+template<class Element>
+	void
+	write_record (QSaveFile& file, Element const& element)
+	{
+		write_section (file, std::span<Element const> (&element, 1));
+	}
+
+} // namespace
+
+
+NavaidCache::NavaidCache (std::string_view const path, std::vector<std::string> source_files):
+	_path (path),
+	_source_files (std::move (source_files))
+{ }
+
+
+std::optional<std::vector<Navaid>>
+NavaidCache::load()
+{
+	QFile file (nu::to_qstring (_path));
+
+	if (!file.open (QFile::ReadOnly))
+		return std::nullopt;
+
+	auto const size = static_cast<std::size_t> (file.size());
+
+	if (size < sizeof (Header))
+		return std::nullopt;
+
+	auto const* const data = file.map (0, file.size());
+
+	if (!data)
+		throw NavaidCacheException ("could not map navaid cache file: " + _path);
+
+	auto reader = SectionReader (data, size);
+	auto const& header = reader.read<Header> (1)[0];
+
+	if (header.magic != kMagic || header.format_version != kFormatVersion || header.byte_order_mark != kByteOrderMark)
+		return std::nullopt;
+
+	// Check counts against the file size before using them, so that a corrupted header
+	// can't cause an overflow or a huge allocation:
+	auto const fits = [size] (uint64_t const count, std::size_t const element_size) {
+		return count <= size / element_size;
+	};
+
+	if (!fits (header.sources_count, sizeof (SourceDigest)) ||
+		!fits (header.navaids_count, sizeof (NavaidRecord)) ||
+		!fits (header.runways_count, sizeof (RunwayRecord)) ||
+		!fits (header.strings_count, sizeof (uint32_t)) ||
+		!fits (header.characters_count, sizeof (char16_t)))
+	{
+		throw NavaidCacheException ("navaid cache file is truncated");
+	}
+
+	auto const digests = reader.read<SourceDigest> (header.sources_count);
+
+	if (!std::ranges::equal (digests, source_digests()))
+		return std::nullopt;
+
+	// There's always at least the empty string:
+	if (header.strings_count == 0)
+		throw NavaidCacheException ("invalid string table in navaid cache");
+
+	auto const navaid_records = reader.read<NavaidRecord> (header.navaids_count);
+	auto const runway_records = reader.read<RunwayRecord> (header.runways_count);
+	auto const offsets = reader.read<uint32_t> (header.strings_count + 1);
+	auto const characters = reader.read<char16_t> (header.characters_count);
+
+	// Create each QString once; navaids referring to the same string will share its data:
+	auto strings = std::vector<QString>();
+	strings.reserve (header.strings_count);
+
+	for (std::size_t i = 0; i < header.strings_count; ++i)
+	{
+		if (offsets[i] > offsets[i + 1] || offsets[i + 1] > characters.size())
+			throw NavaidCacheException ("invalid string table in navaid cache");
+
+		strings.emplace_back (reinterpret_cast<QChar const*> (characters.data() + offsets[i]), offsets[i + 1] - offsets[i]);
+	}
+
+	auto const string = [&strings] (uint32_t const index) -> QString const& {
+		if (index >= strings.size())
+			throw NavaidCacheException ("invalid string index in navaid cache");
+
+		return strings[index];
+	};
+
+	auto navaids = std::vector<Navaid>();
+	navaids.reserve (navaid_records.size());
+
+	for (auto const& record: navaid_records)
+	{
+		if (record.type > Navaid::ARPT || record.vor_type > Navaid::VORTAC)
+			throw NavaidCacheException ("invalid navaid type in navaid cache");
+
+		if (record.runways_begin > runway_records.size() || record.runways_count > runway_records.size() - record.runways_begin)
+			throw NavaidCacheException ("invalid runway range in navaid cache");
+
+		auto& navaid = navaids.emplace_back (static_cast<Navaid::Type> (record.type),
+											 si::LonLat (1_deg * record.lon_deg, 1_deg * record.lat_deg),
+											 string (record.identifier),
+											 string (record.name),
+											 1_m * record.range_m);
+		navaid.set_frequency (1_Hz * record.frequency_hz);
+		navaid.set_slaved_variation (1_deg * record.slaved_variation_deg);
+		navaid.set_elevation (1_m * record.elevation_m);
+		navaid.set_true_bearing (1_deg * record.true_bearing_deg);
+		navaid.set_icao (string (record.icao));
+		navaid.set_runway_id (string (record.runway_id));
+		navaid.set_vor_type (static_cast<Navaid::VorType> (record.vor_type));
+
+		if (record.runways_count > 0)
+		{
+			auto runways = Navaid::Runways();
+			runways.reserve (record.runways_count);
+
+			for (auto const& r: runway_records.subspan (record.runways_begin, record.runways_count))
+			{
+				auto& runway = runways.emplace_back (string (r.identifier_1), si::LonLat (1_deg * r.lon_1_deg, 1_deg * r.lat_1_deg),
+													 string (r.identifier_2), si::LonLat (1_deg * r.lon_2_deg, 1_deg * r.lat_2_deg));
+				runway.set_width (1_m * r.width_m);
+			}
+
+			navaid.set_runways (runways);
+		}
+	}
+
+	return navaids;
+}
+
+
+void
+NavaidCache::store (std::vector<Navaid> const& navaids)
+{
+	auto strings = StringTableBuilder();
+	auto navaid_records = std::vector<NavaidRecord>();
+	auto runway_records = std::vector<RunwayRecord>();
+	navaid_records.reserve (navaids.size());
+
+	for (auto const& navaid: navaids)
+	{
+		auto& record = navaid_records.emplace_back();
+		record.lon_deg = navaid.position().lon().in<si::Degree>();
+		record.lat_deg = navaid.position().lat().in<si::Degree>();
+		record.range_m = navaid.range().in<si::Meter>();
+		record.frequency_hz = navaid.frequency().in<si::Hertz>();
+		record.slaved_variation_deg = navaid.slaved_variation().in<si::Degree>();
+		record.elevation_m = navaid.elevation().in<si::Meter>();
+		record.true_bearing_deg = navaid.true_bearing().in<si::Degree>();
+		record.identifier = strings.intern (navaid.identifier());
+		record.name = strings.intern (navaid.name());
+		record.icao = strings.intern (navaid.icao());
+		record.runway_id = strings.intern (navaid.runway_id());
+		record.runways_begin = static_cast<uint32_t> (runway_records.size());
+		record.runways_count = static_cast<uint32_t> (navaid.runways().size());
+		record.type = static_cast<uint8_t> (navaid.type());
+		record.vor_type = static_cast<uint8_t> (navaid.vor_type());
+
+		for (auto const& runway: navaid.runways())
+		{
+			runway_records.push_back ({
+				.lon_1_deg = runway.pos_1().lon().in<si::Degree>(),
+				.lat_1_deg = runway.pos_1().lat().in<si::Degree>(),
+				.lon_2_deg = runway.pos_2().lon().in<si::Degree>(),
+				.lat_2_deg = runway.pos_2().lat().in<si::Degree>(),
+				.width_m = runway.width().in<si::Meter>(),
+				.identifier_1 = strings.intern (runway.identifier_1()),
+				.identifier_2 = strings.intern (runway.identifier_2()),
+			});
+		}
+	}
+
+	auto const& digests = source_digests();
+	auto header = Header();
+	header.magic = kMagic;
+	header.format_version = kFormatVersion;
+	header.byte_order_mark = kByteOrderMark;
+	header.sources_count = digests.size();
+	header.navaids_count = navaid_records.size();
+	header.runways_count = runway_records.size();
+	header.strings_count = strings.offsets().size() - 1;
+	header.characters_count = strings.characters().size();
+
+	QSaveFile file (nu::to_qstring (_path));
+
+	if (!file.open (QFile::WriteOnly))
+		throw NavaidCacheException ("could not create navaid cache file " + _path + ": " + file.errorString().toStdString());
+
+	write_record (file, header);
+	write_section (file, std::span (digests));
+	write_section (file, std::span (std::as_const (navaid_records)));
+	write_section (file, std::span (std::as_const (runway_records)));
+	write_section (file, std::span (strings.offsets()));
+	write_section (file, std::span (strings.characters()));
+
+	if (!file.commit())
+		throw NavaidCacheException ("could not write navaid cache file " + _path + ": " + file.errorString().toStdString());
+}
+
+
+std::vector<NavaidCache::SourceDigest> const&
+NavaidCache::source_digests()
+{
+	if (!_source_digests)
+	{
+		auto digests = std::vector<SourceDigest>();
+
+		for (auto const& source_file: _source_files)
+			digests.push_back (compute_digest (source_file));
+
+		_source_digests = std::move (digests);
+	}
+
+	return *_source_digests;
+}
+
+
+NavaidCache::SourceDigest
+NavaidCache::compute_digest (std::string const& path)
+{
+	QFile file (nu::to_qstring (path));
+
+	if (!file.open (QFile::ReadOnly))
+		throw NavaidCacheException ("could not open file: " + path);
+
+	QCryptographicHash hash (QCryptographicHash::Blake2b_256);
+
+	// Mapping avoids copying the whole file through a buffer; fall back to reading if it's not possible (eg. empty file):
+	if (auto const* data = file.map (0, file.size()))
+		hash.addData (QByteArrayView (data, file.size()));
+	else if (!hash.addData (&file))
+		throw NavaidCacheException ("could not read file: " + path);
+
+	auto digest = SourceDigest();
+	auto const result = hash.result();
+	digest.size = static_cast<uint64_t> (file.size());
+	std::copy_n (reinterpret_cast<uint8_t const*> (result.constData()), std::min<std::size_t> (result.size(), digest.hash.size()), digest.hash.begin());
+	return digest;
+}
+
+} // namespace xf
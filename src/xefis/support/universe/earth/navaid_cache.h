@@ -0,0 +1,125 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__SUPPORT__UNIVERSE__EARTH__NAVAID_CACHE_H__INCLUDED
+#define XEFIS__SUPPORT__UNIVERSE__EARTH__NAVAID_CACHE_H__INCLUDED
+
+// Local:
+#include "navaid.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/exception.h>
+
+// Standard:
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace xf {
+
+class NavaidCacheException: public nu::Exception
+{
+  public:
+	// Ctor
+	explicit
+	NavaidCacheException (std::string const& message):
+		Exception (message)
+	{ }
+};
+
+
+/**
+ * Binary cache of parsed navigation data, so that the gzipped text files don't have to be parsed
+ * on every start. The file is memory-mapped when loading and contains a flat array of navaid
+ * records, an array of runway records and a table of interned strings referenced by both.
+ *
+ * The cache remembers sizes and hashes of the source files it was made from and is considered stale
+ * if any of the source files changed. Order of navaids is preserved, so the caller can store them
+ * in the order of insertion into its spatial index and have the index rebuilt without sorting.
+ */
+class NavaidCache
+{
+  public:
+	/**
+	 * Identifies contents of a source file.
+	 */
+	struct SourceDigest
+	{
+		uint64_t					size;
+		std::array<uint8_t, 32>		hash;
+
+		[[nodiscard]]
+		bool
+		operator== (SourceDigest const&) const = default;
+	};
+
+  public:
+	// Ctor
+	explicit
+	NavaidCache (std::string_view path, std::vector<std::string> source_files);
+
+	/**
+	 * Cache file path.
+	 */
+	[[nodiscard]]
+	std::string const&
+	path() const noexcept
+		{ return _path; }
+
+	/**
+	 * Load navaids from the cache file.
+	 * Return std::nullopt if there's no cache file, it has an unsupported format
+	 * or it was made from different source files.
+	 * Throw NavaidCacheException if the file is corrupted.
+	 */
+	[[nodiscard]]
+	std::optional<std::vector<Navaid>>
+	load();
+
+	/**
+	 * Write navaids to the cache file. The file is replaced atomically.
+	 * Throw NavaidCacheException on failure.
+	 */
+	void
+	store (std::vector<Navaid> const&);
+
+  private:
+	/**
+	 * Return digests of source files. They're computed only once.
+	 */
+	std::vector<SourceDigest> const&
+	source_digests();
+
+	/**
+	 * Compute size and hash of a file.
+	 */
+	static SourceDigest
+	compute_digest (std::string const& path);
+
+  private:
+	std::string									_path;
+	std::vector<std::string>					_source_files;
+	std::optional<std::vector<SourceDigest>>	_source_digests;
+};
+
+} // namespace xf
+
+#endif
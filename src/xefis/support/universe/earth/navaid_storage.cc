@@ -16,6 +16,7 @@
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/math/geometry.h>
 #include <xefis/support/universe/earth/utility.h>
 
 // Neutrino:
@@ -29,9 +30,18 @@
 #include <QTextStream>
 
 // Standard:
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <iterator>
 #include <memory>
+#include <numbers>
+#include <numeric>
 #include <thread>
+#include <utility>
 
 
 namespace xf {
@@ -71,6 +81,13 @@ class GzDataFileIterator
 	QTextStream&
 	operator*();
 
+	/**
+	 * Return current line.
+	 */
+	QString const&
+	line() const noexcept
+		{ return _line; }
+
   private:
 	QFile							_file;
 	std::unique_ptr<nu::QZDevice>	_decompressor;
@@ -118,17 +135,45 @@ GzDataFileIterator::operator++()
 	_line.clear();
 	while (_line.simplified().isEmpty() && !_decompressed_stream->atEnd())
 		_line = _decompressed_stream->readLine();
-	_line_stream = std::make_unique<QTextStream> (&_line);
+	// Line stream is created on demand, users of line() don't need it:
+	_line_stream.reset();
 }
 
 
 QTextStream&
 GzDataFileIterator::operator*()
 {
+	if (!_line_stream)
+		_line_stream = std::make_unique<QTextStream> (&_line);
+
 	return *_line_stream;
 }
 
 
+namespace {
+
+/**
+ * Return record type code, that is the first number in the line.
+ */
+int
+record_type (QString const& line)
+{
+	auto const trimmed = QStringView (line).trimmed();
+	auto const separator = trimmed.indexOf (u' ');
+	return (separator < 0 ? trimmed : trimmed.left (separator)).toInt();
+}
+
+
+template<class Element>
+	void
+	append (std::vector<Element>& target, std::vector<Element>&& source)
+	{
+		target.insert (target.end(), std::make_move_iterator (source.begin()), std::make_move_iterator (source.end()));
+	}
+
+} // namespace
+
+
 NavaidStorage::NavaidStorage (nu::Logger const& logger,
 							  std::string_view const nav_file,
 							  std::string_view const fix_file,
@@ -137,12 +182,22 @@ NavaidStorage::NavaidStorage (nu::Logger const& logger,
 	_nav_dat_file (nav_file),
 	_fix_dat_file (fix_file),
 	_apt_dat_file (apt_file),
-	_navaids_tree (access_position)
+	_cache (std::filesystem::path (nav_file).replace_filename ("navaids.cache").string(), { _nav_dat_file, _fix_dat_file, _apt_dat_file })
 {
 	_logger << "Creating NavaidStorage" << std::endl;
 }
 
 
+NavaidStorage::NavaidStorage (nu::Logger const& logger, std::vector<Navaid> navaids):
+	_logger (logger.with_context ("<navaid storage>")),
+	_cache ("", {})
+{
+	build_index (std::move (navaids), false);
+	index_by_type();
+	_loaded = true;
+}
+
+
 NavaidStorage::~NavaidStorage()
 {
 	_destroying = true;
@@ -167,24 +222,43 @@ NavaidStorage::load()
 	if (_loaded)
 		return;
 
-	parse_nav_dat();
-	parse_fix_dat();
-	parse_apt_dat();
+	if (auto navaids = load_cache())
+	{
+		// Cached navaids are already arranged for the index:
+		build_index (std::move (*navaids), true);
+	}
+	else
+	{
+		// Parse nav.dat and fix.dat on separate threads while this one parses apt.dat (which uses its own worker threads):
+		auto const parse_on_thread = [this] (void (NavaidStorage::*parse) (std::vector<Navaid>&)) {
+			return std::async (std::launch::async, [this, parse] {
+				auto result = std::vector<Navaid>();
+				(this->*parse) (result);
+				return result;
+			});
+		};
+
+		auto nav_navaids = parse_on_thread (&NavaidStorage::parse_nav_dat);
+		auto fix_navaids = parse_on_thread (&NavaidStorage::parse_fix_dat);
+		auto apt_navaids = std::vector<Navaid>();
+		parse_apt_dat (apt_navaids);
+
+		navaids.emplace (nav_navaids.get());
+		append (*navaids, fix_navaids.get());
+		append (*navaids, std::move (apt_navaids));
 
-	if (destroying())
-		return;
+		if (destroying())
+			return;
 
-	_navaids_tree.optimize();
+		build_index (std::move (*navaids), false);
+		store_cache (_navaids);
+	}
 
 	if (destroying())
 		return;
 
-	for (Navaid const& navaid: _navaids_tree)
-	{
-		auto g = _navaids_by_type.insert (std::make_pair (navaid.type(), Group())).first;
-		g->second.by_identifier[navaid.identifier()] = &navaid;
-		g->second.by_frequency.insert (std::make_pair (navaid.frequency(), &navaid));
-	}
+	index_by_type();
+	_loaded = true;
 }
 
 
@@ -205,22 +279,13 @@ NavaidStorage::get_navs (si::LonLat const& position, si::Length const radius) co
 	if (!_loaded)
 		return {};
 
-	Navaids set;
+	// Chord length on a unit sphere for given great-circle distance:
+	auto const arc = std::clamp<double> (radius / kEarthMeanRadius, 0.0, std::numbers::pi);
+	auto const max_chord = 2.0 * std::sin (0.5 * arc);
 
-	auto inserter_and_predicate = [&] (Navaid const& navaid) -> bool
-	{
-		if (xf::haversine_earth (position, navaid.position()) <= radius)
-		{
-			set.push_back (navaid);
-			return false;
-		}
-		return true;
-	};
-
-	Navaid navaid_at_position (Navaid::OTHER, position, "", "", 0_nmi);
-	_navaids_tree.find_nearest_if (navaid_at_position, std::numeric_limits<si::Length::Value>::max(), inserter_and_predicate);
-
-	return set;
+	Navaids result;
+	find_within (0, _navaids.size(), 0, to_cartesian<ECEFSpace> (position), max_chord, result);
+	return result;
 }
 
 
@@ -256,19 +321,52 @@ NavaidStorage::find_by_frequency (si::LonLat const& position, Navaid::Type type,
 		auto r1 = g->second.by_frequency.lower_bound (frequency + 5_kHz);
 
 		for (auto r = r0; r != r1; ++r)
-			result.push_back (*r->second);
+			result.push_back (r->second);
 	}
 
-	std::sort (result.begin(), result.end(), [&] (Navaid const& a, Navaid const& b) -> bool {
-		return xf::haversine (position, a.position()) < xf::haversine (position, b.position());
+	std::sort (result.begin(), result.end(), [&] (Navaid const* a, Navaid const* b) -> bool {
+		return xf::haversine (position, a->position()) < xf::haversine (position, b->position());
 	});
 
 	return result;
 }
 
 
+std::optional<std::vector<Navaid>>
+NavaidStorage::load_cache()
+{
+	try {
+		if (auto navaids = _cache.load())
+		{
+			_logger << "Loaded " << navaids->size() << " navaids from cache " << _cache.path() << std::endl;
+			return navaids;
+		}
+	}
+	catch (NavaidCacheException const& exception)
+	{
+		_logger << "Ignoring navaid cache: " << exception.message() << std::endl;
+	}
+
+	return std::nullopt;
+}
+
+
+void
+NavaidStorage::store_cache (std::vector<Navaid> const& navaids)
+{
+	try {
+		_cache.store (navaids);
+		_logger << "Stored navaids in cache " << _cache.path() << std::endl;
+	}
+	catch (NavaidCacheException const& exception)
+	{
+		_logger << "Could not store navaid cache: " << exception.message() << std::endl;
+	}
+}
+
+
 void
-NavaidStorage::parse_nav_dat()
+NavaidStorage::parse_nav_dat (std::vector<Navaid>& navaids)
 {
 	_logger << "Loading navaids" << std::endl;
 
@@ -306,7 +404,7 @@ NavaidStorage::parse_nav_dat()
 				name = line_ts.readLine();
 				Navaid navaid (Navaid::NDB, pos, identifier, name, 1_nmi * range);
 				navaid.set_frequency (khz * 10_kHz);
-				_navaids_tree.insert (navaid);
+				navaids.push_back (navaid);
 				break;
 			}
 
@@ -328,7 +426,7 @@ NavaidStorage::parse_nav_dat()
 					navaid.set_vor_type (Navaid::VORTAC);
 				else
 					navaid.set_vor_type (Navaid::VOROnly);
-				_navaids_tree.insert (navaid);
+				navaids.push_back (navaid);
 				break;
 			}
 
@@ -349,7 +447,7 @@ NavaidStorage::parse_nav_dat()
 				navaid.set_elevation (1_ft * elevation_ft);
 				navaid.set_icao (icao);
 				navaid.set_runway_id (runway_id);
-				_navaids_tree.insert (navaid);
+				navaids.push_back (navaid);
 				break;
 			}
 
@@ -378,7 +476,7 @@ NavaidStorage::parse_nav_dat()
 
 
 void
-NavaidStorage::parse_fix_dat()
+NavaidStorage::parse_fix_dat (std::vector<Navaid>& navaids)
 {
 	_logger << "Loading fixes" << std::endl;
 
@@ -398,7 +496,7 @@ NavaidStorage::parse_fix_dat()
 
 		pos = si::LonLat (1_deg * pos_lon, 1_deg * pos_lat);
 
-		_navaids_tree.insert (Navaid (Navaid::FIX, pos, identifier, identifier, 0_nmi));
+		navaids.push_back (Navaid (Navaid::FIX, pos, identifier, identifier, 0_nmi));
 
 		if (destroying())
 			return;
@@ -409,13 +507,77 @@ NavaidStorage::parse_fix_dat()
 
 
 void
-NavaidStorage::parse_apt_dat()
+NavaidStorage::parse_apt_dat (std::vector<Navaid>& navaids)
 {
 	_logger << "Loading airports" << std::endl;
 
+	GzDataFileIterator line (_apt_dat_file);
+	bool first_line = true;
+
+	append (navaids, parse_apt_lines ([&]() -> QString const* {
+		if (!std::exchange (first_line, false))
+			++line;
+
+		return line ? &line.line() : nullptr;
+	}));
+
+	_logger << "Loading airports: done" << std::endl;
+}
+
+
+std::vector<Navaid>
+NavaidStorage::parse_apt_lines (std::function<QString const*()> const& next_line, std::size_t const chunk_lines, std::size_t const max_threads)
+{
+	// Lines are grouped into chunks that start with a land airport record, so that each chunk contains
+	// complete airports and can be decoded independently. Chunks are decoded on worker threads,
+	// while this thread reads the input. Results are collected in the original order.
+	auto const max_pending_chunks = std::max<std::size_t> (1, max_threads);
+	auto navaids = std::vector<Navaid>();
+	auto pending_chunks = std::deque<std::future<std::vector<Navaid>>>();
+	auto chunk = std::vector<QString>();
+
+	auto const collect_oldest_chunk = [&] {
+		append (navaids, pending_chunks.front().get());
+		pending_chunks.pop_front();
+	};
+
+	auto const dispatch_chunk = [&] {
+		if (pending_chunks.size() >= max_pending_chunks)
+			collect_oldest_chunk();
+
+		pending_chunks.push_back (std::async (std::launch::async, &NavaidStorage::parse_apt_chunk, this, std::exchange (chunk, {})));
+		chunk.reserve (chunk_lines);
+	};
+
+	chunk.reserve (chunk_lines);
+
+	while (auto const* line = next_line())
+	{
+		if (chunk.size() >= chunk_lines && record_type (*line) == static_cast<int> (Apt::LandAirport))
+			dispatch_chunk();
+
+		chunk.push_back (*line);
+
+		if (destroying())
+			break;
+	}
+
+	if (!chunk.empty() && !destroying())
+		dispatch_chunk();
+
+	while (!pending_chunks.empty())
+		collect_oldest_chunk();
+
+	return navaids;
+}
+
+
+std::vector<Navaid>
+NavaidStorage::parse_apt_chunk (std::vector<QString> lines)
+{
+	std::vector<Navaid> navaids;
 	std::unique_ptr<Navaid> cur_land_airport;
 	Navaid::Runways runways;
-	std::size_t loaded_airports = 0;
 
 	auto push_navaid = [&]{
 		if (cur_land_airport && !runways.empty())
@@ -440,17 +602,15 @@ NavaidStorage::parse_apt_dat()
 			cur_land_airport->set_position (mean_position);
 			cur_land_airport->set_runways (runways);
 
-			_navaids_tree.insert (*cur_land_airport);
+			navaids.push_back (*cur_land_airport);
 			cur_land_airport.reset();
 			runways.clear();
-
-			++loaded_airports;
 		}
 	};
 
-	for (GzDataFileIterator line (_apt_dat_file); line; ++line)
+	for (auto& line: lines)
 	{
-		auto& line_ts = *line;
+		QTextStream line_ts (&line, QIODevice::ReadOnly);
 
 		int type;
 		line_ts >> type;
@@ -518,12 +678,99 @@ NavaidStorage::parse_apt_dat()
 		}
 
 		if (destroying())
-			return;
+			return {};
 	}
 
 	push_navaid();
+	return navaids;
+}
 
-	_logger << "Loading airports: done" << std::endl;
+
+void
+NavaidStorage::build_index (std::vector<Navaid>&& navaids, bool const arranged)
+{
+	auto positions = std::vector<UnitVector>();
+	positions.reserve (navaids.size());
+
+	for (auto const& navaid: navaids)
+		positions.push_back (to_cartesian<ECEFSpace> (navaid.position()));
+
+	if (arranged)
+	{
+		_navaids = std::move (navaids);
+		_navaid_positions = std::move (positions);
+	}
+	else
+	{
+		auto indices = std::vector<std::size_t> (navaids.size());
+		std::iota (indices.begin(), indices.end(), 0);
+		arrange_for_index (indices, positions);
+
+		_navaids.clear();
+		_navaids.reserve (navaids.size());
+		_navaid_positions.clear();
+		_navaid_positions.reserve (navaids.size());
+
+		for (auto const i: indices)
+		{
+			_navaids.push_back (std::move (navaids[i]));
+			_navaid_positions.push_back (positions[i]);
+		}
+	}
+}
+
+
+void
+NavaidStorage::index_by_type()
+{
+	for (Navaid const& navaid: _navaids)
+	{
+		auto g = _navaids_by_type.insert (std::make_pair (navaid.type(), Group())).first;
+		g->second.by_identifier[navaid.identifier()] = &navaid;
+		g->second.by_frequency.insert (std::make_pair (navaid.frequency(), &navaid));
+	}
+}
+
+
+void
+NavaidStorage::arrange_for_index (std::span<std::size_t> const indices, std::vector<UnitVector> const& positions, std::size_t const depth)
+{
+	if (indices.size() <= 1)
+		return;
+
+	auto const axis = depth % 3;
+	auto const middle = indices.size() / 2;
+
+	std::nth_element (indices.begin(), indices.begin() + middle, indices.end(), [&] (std::size_t const a, std::size_t const b) {
+		return positions[a][axis] < positions[b][axis];
+	});
+
+	arrange_for_index (indices.first (middle), positions, depth + 1);
+	arrange_for_index (indices.subspan (middle + 1), positions, depth + 1);
+}
+
+
+void
+NavaidStorage::find_within (std::size_t const begin, std::size_t const end, std::size_t const depth, UnitVector const& center, double const max_chord, Navaids& result) const
+{
+	if (begin == end)
+		return;
+
+	auto const middle = begin + (end - begin) / 2;
+	auto const& position = _navaid_positions[middle];
+	auto const difference = center - position;
+
+	if (difference[0] * difference[0] + difference[1] * difference[1] + difference[2] * difference[2] <= max_chord * max_chord)
+		result.push_back (&_navaids[middle]);
+
+	// Elements before the middle are not greater than it on the splitting axis, elements after it are not less:
+	auto const axis_difference = difference[depth % 3];
+
+	if (axis_difference <= max_chord)
+		find_within (begin, middle, depth + 1, center, max_chord, result);
+
+	if (axis_difference >= -max_chord)
+		find_within (middle + 1, end, depth + 1, center, max_chord, result);
 }
 
 
@@ -16,22 +16,27 @@
 
 // Local:
 #include "navaid.h"
+#include "navaid_cache.h"
 
 // Xefis:
 #include <xefis/config/all.h>
+#include <xefis/support/math/coordinate_systems.h>
+#include <xefis/support/math/geometry_types.h>
 
 // Neutrino:
 #include <neutrino/logger.h>
 
-// Lib:
-#include <kdtree++/kdtree.hpp>
-
 // Standard:
 #include <cstddef>
+#include <functional>
 #include <future>
+#include <optional>
 #include <set>
+#include <span>
 #include <string_view>
 #include <map>
+#include <thread>
+#include <vector>
 
 
 namespace xf {
@@ -73,13 +78,16 @@ class NavaidStorage
 	};
 
   public:
-	using Navaids = std::vector<Navaid>;
+	// Minimum number of apt.dat lines decoded by a single worker thread:
+	static constexpr std::size_t kAptChunkLines = 20'000;
 
-  private:
-	static si::Angle::Value
-	access_position (Navaid const& navaid, std::size_t const dimension);
+	/**
+	 * Pointers to navaids owned by the storage. They're valid as long as the storage exists.
+	 */
+	using Navaids = std::vector<Navaid const*>;
 
-	using NavaidsTree = KDTree::KDTree<2, Navaid, std::function<si::Angle::Value (Navaid const&, std::size_t)>>;
+  private:
+	using UnitVector = SpaceVector<double, ECEFSpace>;
 
   public:
 	// Ctor
@@ -89,11 +97,19 @@ class NavaidStorage
 				   std::string_view const fix_file,
 				   std::string_view const apt_file);
 
+	/**
+	 * Create already loaded storage with given navaids, without using any data files.
+	 */
+	explicit
+	NavaidStorage (nu::Logger const&, std::vector<Navaid> navaids);
+
 	// Dtor
 	~NavaidStorage();
 
 	/**
 	 * Load navaids and fixes.
+	 * Navaids are read from the binary cache if it's up to date. Otherwise source files are parsed
+	 * and the cache is (re)created.
 	 * Either use load() or async_loader().
 	 */
 	void
@@ -115,7 +131,17 @@ class NavaidStorage
 		{ _destroying = true; }
 
 	/**
-	 * Return set of navaids withing the given @radius
+	 * Return true if loading has finished. Until then get_navs(), find_by_id() and find_by_frequency()
+	 * return no navaids.
+	 * \threadsafe
+	 */
+	[[nodiscard]]
+	bool
+	loaded() const noexcept
+		{ return _loaded; }
+
+	/**
+	 * Return set of navaids withing the given great-circle distance @radius
 	 * from a @position.
 	 * \threadsafe
 	 */
@@ -138,39 +164,95 @@ class NavaidStorage
 	Navaids
 	find_by_frequency (si::LonLat const& position, Navaid::Type, si::Frequency frequency) const;
 
+	/**
+	 * Decode apt.dat lines returned one by one by @next_line, until it returns nullptr.
+	 * Lines are grouped into chunks of at least @chunk_lines lines, each starting with a land airport record,
+	 * and chunks are decoded on up to @max_threads worker threads. Result is in the order of the input.
+	 * Used by load(); public for tests and benchmarks.
+	 */
+	std::vector<Navaid>
+	parse_apt_lines (std::function<QString const*()> const& next_line,
+					 std::size_t chunk_lines = kAptChunkLines,
+					 std::size_t max_threads = std::thread::hardware_concurrency());
+
   private:
+	/**
+	 * Load navaids from the cache. Return std::nullopt if it's not usable.
+	 */
+	std::optional<std::vector<Navaid>>
+	load_cache();
+
+	/**
+	 * Store navaids in the cache, logging (and ignoring) errors.
+	 */
 	void
-	parse_nav_dat();
+	store_cache (std::vector<Navaid> const&);
 
 	void
-	parse_fix_dat();
+	parse_nav_dat (std::vector<Navaid>&);
 
 	void
-	parse_apt_dat();
+	parse_fix_dat (std::vector<Navaid>&);
+
+	/**
+	 * Parse apt.dat with parse_apt_lines().
+	 */
+	void
+	parse_apt_dat (std::vector<Navaid>&);
+
+	/**
+	 * Decode a chunk of apt.dat lines. Chunk must start with a land airport record.
+	 */
+	std::vector<Navaid>
+	parse_apt_chunk (std::vector<QString> lines);
+
+	/**
+	 * Set _navaids and _navaid_positions from given navaids.
+	 * If @arranged is false, navaids are first reordered to form the spatial index.
+	 */
+	void
+	build_index (std::vector<Navaid>&& navaids, bool arranged);
+
+	/**
+	 * Fill _navaids_by_type from _navaids.
+	 */
+	void
+	index_by_type();
+
+	/**
+	 * Arrange indices of navaids into an implicit 3D KD-tree over their ECEF unit vectors.
+	 * A node is the middle element of a range, its left and right subtrees are the elements before and after it.
+	 * Splitting axis is depth % 3.
+	 */
+	static void
+	arrange_for_index (std::span<std::size_t> indices, std::vector<UnitVector> const& positions, std::size_t depth = 0);
+
+	/**
+	 * Add to @result navaids from index range [@begin, @end) that are within @max_chord from @center.
+	 */
+	void
+	find_within (std::size_t begin, std::size_t end, std::size_t depth, UnitVector const& center, double max_chord, Navaids& result) const;
 
 	bool
 	destroying();
 
   private:
-	std::atomic<bool>	_async_requested	{ false };
-	std::atomic<bool>	_loaded				{ false };
-	std::atomic<bool>	_destroying			{ false };
-	std::atomic<bool>	_logged_destroying	{ false };
-	nu::Logger			_logger;
-	std::string			_nav_dat_file;
-	std::string			_fix_dat_file;
-	std::string			_apt_dat_file;
-	NavaidsTree			_navaids_tree;
-	NavaidsByType		_navaids_by_type;
+	std::atomic<bool>		_async_requested	{ false };
+	std::atomic<bool>		_loaded				{ false };
+	std::atomic<bool>		_destroying			{ false };
+	std::atomic<bool>		_logged_destroying	{ false };
+	nu::Logger				_logger;
+	std::string				_nav_dat_file;
+	std::string				_fix_dat_file;
+	std::string				_apt_dat_file;
+	NavaidCache				_cache;
+	// Navaids arranged as an implicit KD-tree, see arrange_for_index():
+	std::vector<Navaid>		_navaids;
+	// ECEF unit vectors of _navaids:
+	std::vector<UnitVector>	_navaid_positions;
+	NavaidsByType			_navaids_by_type;
 };
 
-
-inline si::Angle::Value
-NavaidStorage::access_position (Navaid const& navaid, std::size_t const dimension)
-{
-	return dimension == 0 ? navaid.position().lat().in<si::Degree>() : navaid.position().lon().in<si::Degree>();
-}
-
 } // namespace xf
 
 #endif
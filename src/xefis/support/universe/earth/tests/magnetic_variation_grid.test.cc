@@ -0,0 +1,92 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/universe/earth/magnetic_variation.h>
+#include <xefis/support/universe/earth/magnetic_variation_grid.h>
+
+// Neutrino:
+#include <neutrino/numeric.h>
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <thread>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+
+void
+verify_against_direct_computation (std::string const& label, MagneticVariationGrid& grid, si::LonLat const& position, si::Length const altitude, int const year, int const month, int const day)
+{
+	auto mv = MagneticVariation();
+	mv.set_position (position);
+	mv.set_altitude_amsl (altitude);
+	mv.set_date (year, month, day);
+	mv.update();
+
+	auto const result = grid.compute (position, altitude);
+
+	// Declination wraps around ±180°:
+	auto const declination_error = nu::floored_mod (result.magnetic_declination - mv.magnetic_declination() + 180_deg, 360_deg) - 180_deg;
+
+	test_asserts::verify (label + ": declination", abs (declination_error) <= MagneticVariationGrid::kAccuracy);
+	test_asserts::verify_equal_with_epsilon (label + ": inclination", result.magnetic_inclination, mv.magnetic_inclination(), MagneticVariationGrid::kAccuracy);
+}
+
+
+nu::AutoTest t1 ("Earth: MagneticVariationGrid accuracy", []{
+	auto prng = std::mt19937 (1);
+	auto latitude = std::uniform_real_distribution<double> (-89.0, +89.0);
+	auto longitude = std::uniform_real_distribution<double> (-180.0, +180.0);
+	auto altitude = std::uniform_real_distribution<double> (-0.5, 15.0);
+	auto grid = MagneticVariationGrid();
+	grid.set_date (2026, 10, 18);
+
+	for (std::size_t i = 0; i < 2000; ++i)
+	{
+		auto const position = si::LonLat (1_deg * longitude (prng), 1_deg * latitude (prng));
+		verify_against_direct_computation ("random position", grid, position, 1_km * altitude (prng), 2026, 10, 18);
+	}
+});
+
+
+nu::AutoTest t2 ("Earth: MagneticVariationGrid date change", []{
+	using namespace std::chrono_literals;
+
+	auto const position = si::LonLat (19.5_deg, 50.2_deg);
+	auto grid = MagneticVariationGrid();
+	grid.set_date (2020, 1, 1);
+	verify_against_direct_computation ("initial date", grid, position, 1_km, 2020, 1, 1);
+
+	grid.set_date (2040, 1, 1);
+
+	while (grid.updating())
+	{
+		std::this_thread::sleep_for (1ms);
+		(void) grid.compute (position, 1_km);
+	}
+
+	verify_against_direct_computation ("changed date", grid, position, 1_km, 2040, 1, 1);
+});
+
+} // namespace
+} // namespace xf::test
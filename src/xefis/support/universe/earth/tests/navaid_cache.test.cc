@@ -0,0 +1,154 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/universe/earth/navaid_cache.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Qt:
+#include <QTemporaryDir>
+
+// Standard:
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+
+void
+write_file (std::string const& path, std::string const& contents)
+{
+	std::ofstream (path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+
+std::vector<Navaid>
+sample_navaids()
+{
+	auto vor = Navaid (Navaid::VOR, si::LonLat (19.0_deg, 50.25_deg), "KTC", "KATOWICE VOR-DME", 130_nmi);
+	vor.set_frequency (113.75_MHz);
+	vor.set_slaved_variation (5_deg);
+	vor.set_elevation (300_m);
+	vor.set_vor_type (Navaid::VOR_DME);
+
+	auto loc = Navaid (Navaid::LOC, si::LonLat (19.08_deg, 50.47_deg), "IKTW", "KATOWICE ILS-CAT-I", 18_nmi);
+	loc.set_frequency (110.3_MHz);
+	loc.set_true_bearing (273.5_deg);
+	loc.set_icao ("EPKT");
+	loc.set_runway_id ("27");
+
+	auto airport = Navaid (Navaid::ARPT, si::LonLat (19.08_deg, 50.47_deg), "EPKT", "Katowice Pyrzowice", 0_nmi);
+	auto runway = Navaid::Runway ("09", si::LonLat (19.05_deg, 50.47_deg), "27", si::LonLat (19.11_deg, 50.47_deg));
+	runway.set_width (60_m);
+	airport.set_runways ({ runway });
+
+	// Fixes have the same identifier and name:
+	auto fix = Navaid (Navaid::FIX, si::LonLat (-179.5_deg, -10_deg), "EPKT", "EPKT", 0_nmi);
+
+	return { vor, loc, airport, fix };
+}
+
+
+nu::AutoTest t1 ("Earth: NavaidCache round trip and invalidation", []{
+	QTemporaryDir directory;
+	auto const source_path = directory.filePath ("nav.dat.gz").toStdString();
+	auto const cache_path = directory.filePath ("navaids.cache").toStdString();
+	auto const navaids = sample_navaids();
+
+	write_file (source_path, "source data");
+
+	{
+		auto cache = NavaidCache (cache_path, { source_path });
+		test_asserts::verify ("no cache before first store", !cache.load());
+		cache.store (navaids);
+	}
+
+	auto const loaded = NavaidCache (cache_path, { source_path }).load();
+	test_asserts::verify ("cache is loaded", loaded.has_value());
+	test_asserts::verify ("all navaids are loaded", loaded->size() == navaids.size());
+
+	for (std::size_t i = 0; i < navaids.size(); ++i)
+	{
+		auto const& a = navaids[i];
+		auto const& b = (*loaded)[i];
+
+		test_asserts::verify ("type is preserved", a.type() == b.type());
+		test_asserts::verify ("identifier is preserved", a.identifier() == b.identifier());
+		test_asserts::verify ("name is preserved", a.name() == b.name());
+		test_asserts::verify ("ICAO code is preserved", a.icao() == b.icao());
+		test_asserts::verify ("runway ID is preserved", a.runway_id() == b.runway_id());
+		test_asserts::verify ("VOR type is preserved", a.vor_type() == b.vor_type());
+		test_asserts::verify_equal_with_epsilon ("longitude is preserved", a.position().lon(), b.position().lon(), 1e-9_deg);
+		test_asserts::verify_equal_with_epsilon ("latitude is preserved", a.position().lat(), b.position().lat(), 1e-9_deg);
+		test_asserts::verify_equal_with_epsilon ("range is preserved", a.range(), b.range(), 1e-6_m);
+		test_asserts::verify_equal_with_epsilon ("frequency is preserved", a.frequency(), b.frequency(), 1e-6_Hz);
+		test_asserts::verify_equal_with_epsilon ("true bearing is preserved", a.true_bearing(), b.true_bearing(), 1e-9_deg);
+		test_asserts::verify ("runways are preserved", a.runways().size() == b.runways().size());
+
+		for (std::size_t r = 0; r < a.runways().size(); ++r)
+		{
+			test_asserts::verify ("runway identifiers are preserved",
+								  a.runways()[r].identifier_1() == b.runways()[r].identifier_1() &&
+								  a.runways()[r].identifier_2() == b.runways()[r].identifier_2());
+			test_asserts::verify_equal_with_epsilon ("runway width is preserved", a.runways()[r].width(), b.runways()[r].width(), 1e-6_m);
+		}
+	}
+
+	// Same size, different contents:
+	write_file (source_path, "source_data");
+	test_asserts::verify ("cache is stale after source file changes", !NavaidCache (cache_path, { source_path }).load());
+});
+
+
+nu::AutoTest t2 ("Earth: NavaidCache rejects corrupted header", []{
+	QTemporaryDir directory;
+	auto const source_path = directory.filePath ("nav.dat.gz").toStdString();
+	auto const cache_path = directory.filePath ("navaids.cache").toStdString();
+
+	write_file (source_path, "source data");
+	NavaidCache (cache_path, { source_path }).store (sample_navaids());
+
+	// Set strings_count (after magic, format version, byte order mark and three other counts) to the maximum value:
+	{
+		auto file = std::fstream (cache_path, std::ios::binary | std::ios::in | std::ios::out);
+		auto const strings_count = std::numeric_limits<uint64_t>::max();
+		file.seekp (8 + 4 + 4 + 3 * 8);
+		file.write (reinterpret_cast<char const*> (&strings_count), sizeof (strings_count));
+	}
+
+	auto thrown = false;
+
+	try {
+		(void) NavaidCache (cache_path, { source_path }).load();
+	}
+	catch (NavaidCacheException const&)
+	{
+		thrown = true;
+	}
+
+	test_asserts::verify ("corrupted header causes NavaidCacheException", thrown);
+});
+
+} // namespace
+} // namespace xf::test
@@ -0,0 +1,161 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/universe/earth/navaid_storage.h>
+#include <xefis/test/benchmark.h>
+
+// Neutrino:
+#include <neutrino/qt/qzdevice.h>
+
+// Qt:
+#include <QFile>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+std::filesystem::path const kNavFile	= "share/nav/nav.dat.gz";
+std::filesystem::path const kFixFile	= "share/nav/fix.dat.gz";
+std::filesystem::path const kAptFile	= "share/nav/apt.dat.gz";
+
+
+/**
+ * Return true if all navigation data files exist. They're not distributed with Xefis,
+ * so the benchmarks are skipped without them.
+ */
+bool
+data_files_exist()
+{
+	for (auto const& path: { kNavFile, kFixFile, kAptFile })
+	{
+		if (!std::filesystem::exists (path))
+		{
+			std::clog << "File " << path << " not found, skipping." << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Return all non-empty lines of a gzipped data file, except for the two header lines.
+ */
+std::vector<QString>
+read_lines (std::filesystem::path const& path)
+{
+	auto lines = std::vector<QString>();
+	QFile file (QString::fromStdString (path.string()));
+
+	if (!file.open (QFile::ReadOnly))
+		return lines;
+
+	nu::QZDevice decompressor (&file);
+
+	if (!decompressor.open (nu::QZDevice::ReadOnly))
+		return lines;
+
+	QTextStream stream (&decompressor);
+	std::size_t skipped_lines = 0;
+
+	while (!stream.atEnd())
+	{
+		auto line = stream.readLine();
+
+		if (line.simplified().isEmpty())
+			continue;
+
+		// Skip two first lines (file origin and copyrights):
+		if (skipped_lines < 2)
+			++skipped_lines;
+		else
+			lines.push_back (std::move (line));
+	}
+
+	return lines;
+}
+
+
+xf::Benchmark b1 ("NavaidStorage: loading", [] (xf::Benchmark& benchmark) {
+	if (!data_files_exist())
+		return;
+
+	// Cache is stored next to the nav.dat file, so use links to the data files in a temporary
+	// directory to leave the real cache alone:
+	QTemporaryDir directory;
+	auto const directory_path = std::filesystem::path (directory.path().toStdString());
+	auto const cache_path = directory_path / "navaids.cache";
+
+	for (auto const& path: { kNavFile, kFixFile, kAptFile })
+		std::filesystem::create_symlink (std::filesystem::absolute (path), directory_path / path.filename());
+
+	auto const load = [&] {
+		NavaidStorage storage (nu::Logger(),
+							   (directory_path / kNavFile.filename()).string(),
+							   (directory_path / kFixFile.filename()).string(),
+							   (directory_path / kAptFile.filename()).string());
+		storage.load();
+		xf::Benchmark::keep (storage.loaded());
+	};
+
+	benchmark.measure ("cold load (parse sources, store cache)", 3, [&] {
+		std::filesystem::remove (cache_path);
+		load();
+	});
+
+	benchmark.measure ("warm load (from cache)", 10, load);
+});
+
+
+xf::Benchmark b2 ("NavaidStorage: apt.dat decoding vs. number of threads", [] (xf::Benchmark& benchmark) {
+	if (!data_files_exist())
+		return;
+
+	// Decompression is left out, it's done by the loading thread anyway:
+	auto const lines = read_lines (kAptFile);
+	auto storage = NavaidStorage (nu::Logger(), {});
+	auto const hardware_threads = std::max (1u, std::thread::hardware_concurrency());
+
+	for (std::size_t threads = 1; ; threads = std::min<std::size_t> (2 * threads, hardware_threads))
+	{
+		benchmark.measure (std::format ("{} lines, {} threads", lines.size(), threads), 5, [&] {
+			auto next = lines.begin();
+
+			xf::Benchmark::keep (storage.parse_apt_lines ([&]() -> QString const* {
+				return next != lines.end() ? &*next++ : nullptr;
+			}, NavaidStorage::kAptChunkLines, threads));
+		});
+
+		if (threads == hardware_threads)
+			break;
+	}
+});
+
+} // namespace
+} // namespace xf::test
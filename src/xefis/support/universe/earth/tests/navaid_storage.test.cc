@@ -0,0 +1,211 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/support/universe/earth/navaid_storage.h>
+#include <xefis/support/universe/earth/utility.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Qt:
+#include <QString>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+
+/**
+ * Return a random position; some of them are placed near the antimeridian and the poles.
+ */
+si::LonLat
+random_position (std::mt19937& prng)
+{
+	auto longitude = std::uniform_real_distribution<double> (-180.0, +180.0);
+	auto latitude = std::uniform_real_distribution<double> (-90.0, +90.0);
+	auto near_edge = std::uniform_real_distribution<double> (0.0, 1.0);
+	auto sign = std::bernoulli_distribution (0.5);
+	auto const edge_sign = sign (prng) ? +1.0 : -1.0;
+
+	switch (std::uniform_int_distribution<int> (0, 2) (prng))
+	{
+		case 0:
+			// Near lon ±180°:
+			return si::LonLat (1_deg * edge_sign * (180.0 - near_edge (prng)), 1_deg * latitude (prng));
+
+		case 1:
+			// Near lat ±89°:
+			return si::LonLat (1_deg * longitude (prng), 1_deg * edge_sign * (88.5 + near_edge (prng)));
+
+		default:
+			return si::LonLat (1_deg * longitude (prng), 1_deg * latitude (prng));
+	}
+}
+
+
+std::vector<Navaid>
+random_navaids (std::mt19937& prng, std::size_t const count)
+{
+	auto navaids = std::vector<Navaid>();
+	navaids.reserve (count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		auto const identifier = QString::number (i);
+		navaids.emplace_back (Navaid::FIX, random_position (prng), identifier, identifier, 0_nmi);
+	}
+
+	return navaids;
+}
+
+
+/**
+ * Return apt.dat lines with land airports, their runways and some records that the decoder skips.
+ */
+std::vector<QString>
+sample_apt_lines (std::mt19937& prng, std::size_t const airports)
+{
+	auto coordinate = std::uniform_real_distribution<double> (-0.05, +0.05);
+	auto runways_count = std::uniform_int_distribution<int> (0, 3);
+	auto lines = std::vector<QString>();
+
+	for (std::size_t i = 0; i < airports; ++i)
+	{
+		auto const lon = -170.0 + 340.0 * i / airports;
+		auto const lat = -80.0 + 160.0 * i / airports;
+
+		lines.push_back (QString::fromStdString (std::format ("1 {} 0 0 A{:03} Airport number {}", 100 + i, i, i)));
+		lines.push_back (QString::fromStdString (std::format ("1302 city City {}", i)));
+
+		for (int r = 0, n = runways_count (prng); r < n; ++r)
+		{
+			lines.push_back (QString::fromStdString (std::format ("100 45.00 1 0 0.25 1 2 1 {:02}L {:.8f} {:.8f} 0 0 3 2 1 1 {:02}R {:.8f} {:.8f} 0 0 3 2 1 1",
+																  r + 1, lat + coordinate (prng), lon + coordinate (prng),
+																  r + 19, lat + coordinate (prng), lon + coordinate (prng))));
+		}
+
+		lines.push_back (QString::fromStdString (std::format ("14 {:.8f} {:.8f} 0 0 Tower viewpoint", lat, lon)));
+	}
+
+	lines.push_back ("99");
+	return lines;
+}
+
+
+/**
+ * Positions decoded from the same text must be exactly equal.
+ */
+bool
+same_position (si::LonLat const& a, si::LonLat const& b)
+{
+	return a.lon() == b.lon() && a.lat() == b.lat();
+}
+
+
+std::vector<Navaid>
+parse_apt_lines (NavaidStorage& storage, std::vector<QString> const& lines, std::size_t const chunk_lines, std::size_t const max_threads)
+{
+	auto next = lines.begin();
+
+	return storage.parse_apt_lines ([&]() -> QString const* {
+		return next != lines.end() ? &*next++ : nullptr;
+	}, chunk_lines, max_threads);
+}
+
+
+nu::AutoTest t1 ("Earth: NavaidStorage::get_navs() matches brute-force haversine filter", []{
+	auto prng = std::mt19937 (1);
+	auto const storage = NavaidStorage (nu::Logger(), random_navaids (prng, 5000));
+	// Radius larger than half of the Earth circumference returns all navaids:
+	auto const all_navaids = storage.get_navs (si::LonLat (0_deg, 0_deg), 30'000_km);
+	test_asserts::verify ("all navaids are returned for a huge radius", all_navaids.size() == 5000);
+
+	auto radius_nmi = std::uniform_real_distribution<double> (1.0, 600.0);
+
+	for (std::size_t q = 0; q < 500; ++q)
+	{
+		auto const center = random_position (prng);
+		auto const radius = 1_nmi * radius_nmi (prng);
+		auto found = storage.get_navs (center, radius);
+		auto expected = NavaidStorage::Navaids();
+
+		for (auto const* navaid: all_navaids)
+		{
+			auto const distance = haversine_earth (center, navaid->position());
+
+			// Don't compare navaids on the boundary, where rounding errors could go either way:
+			if (abs (distance - radius) < 1_m)
+			{
+				std::erase (found, navaid);
+				continue;
+			}
+
+			if (distance < radius)
+				expected.push_back (navaid);
+		}
+
+		std::ranges::sort (found);
+		std::ranges::sort (expected);
+		test_asserts::verify ("get_navs() returns navaids within radius, around " + std::to_string (center.lon().in<si::Degree>()) + "°, " + std::to_string (center.lat().in<si::Degree>()) + "°",
+							  found == expected);
+	}
+});
+
+nu::AutoTest t2 ("Earth: NavaidStorage::parse_apt_lines() gives the same result for any chunking", []{
+	auto prng = std::mt19937 (1);
+	auto const lines = sample_apt_lines (prng, 50);
+	auto storage = NavaidStorage (nu::Logger(), {});
+	auto const expected = parse_apt_lines (storage, lines, lines.size() + 1, 1);
+
+	test_asserts::verify ("airports with runways are decoded", !expected.empty());
+
+	for (auto const chunk_lines: { 1uz, 2uz, 3uz, 7uz, 40uz })
+	{
+		for (auto const max_threads: { 1uz, 2uz, 8uz })
+		{
+			auto const result = parse_apt_lines (storage, lines, chunk_lines, max_threads);
+			auto const label = std::format (" with {}-line chunks on {} threads", chunk_lines, max_threads);
+			auto const same_airports = std::ranges::equal (result, expected, [] (Navaid const& a, Navaid const& b) {
+				return a.identifier() == b.identifier()
+					&& a.name() == b.name()
+					&& same_position (a.position(), b.position())
+					&& a.elevation() == b.elevation()
+					&& std::ranges::equal (a.runways(), b.runways(), [] (Navaid::Runway const& ra, Navaid::Runway const& rb) {
+						return ra.identifier_1() == rb.identifier_1()
+							&& ra.identifier_2() == rb.identifier_2()
+							&& same_position (ra.pos_1(), rb.pos_1())
+							&& same_position (ra.pos_2(), rb.pos_2());
+					});
+			});
+
+			test_asserts::verify ("same number of airports" + label, result.size() == expected.size());
+			test_asserts::verify ("same airports" + label, same_airports);
+		}
+	}
+});
+
+
+} // namespace
+} // namespace xf::test
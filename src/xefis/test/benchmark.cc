@@ -0,0 +1,110 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Local:
+#include "benchmark.h"
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <numeric>
+
+
+namespace xf {
+namespace {
+
+double
+to_us (si::Time const time)
+{
+	return 1e6 * time.in<si::Second>();
+}
+
+} // namespace
+
+
+Benchmark::Benchmark (std::string_view const name, Function const function):
+	_name (name),
+	_function (function)
+{
+	registry().push_back (this);
+}
+
+
+Benchmark::Statistics
+Benchmark::report (std::string_view const label, std::vector<si::Time> samples)
+{
+	auto const stats = compute_statistics (std::move (samples));
+
+	std::cout << std::format ("  {:<48} n={:<7} min={:10.3f} µs  median={:10.3f} µs  p90={:10.3f} µs  p99={:10.3f} µs  max={:10.3f} µs  mean={:10.3f} µs\n",
+							  label, stats.samples, to_us (stats.minimum), to_us (stats.median), to_us (stats.p90),
+							  to_us (stats.p99), to_us (stats.maximum), to_us (stats.mean));
+
+	return stats;
+}
+
+
+Benchmark::Statistics
+Benchmark::compute_statistics (std::vector<si::Time> samples)
+{
+	Statistics stats;
+
+	if (samples.empty())
+		return stats;
+
+	std::sort (samples.begin(), samples.end());
+
+	auto const percentile = [&samples] (double const p) {
+		auto const index = static_cast<size_t> (p * static_cast<double> (samples.size() - 1) + 0.5);
+		return samples[std::min (index, samples.size() - 1)];
+	};
+
+	stats.samples = samples.size();
+	stats.minimum = samples.front();
+	stats.median = percentile (0.5);
+	stats.p90 = percentile (0.9);
+	stats.p99 = percentile (0.99);
+	stats.maximum = samples.back();
+	stats.mean = std::accumulate (samples.begin(), samples.end(), 0_s) / static_cast<double> (samples.size());
+
+	return stats;
+}
+
+
+void
+Benchmark::run_all (std::optional<std::string_view> const filter)
+{
+	for (auto* benchmark: registry())
+	{
+		if (filter && benchmark->name().find (*filter) == std::string::npos)
+			continue;
+
+		std::cout << benchmark->name() << ":\n";
+		benchmark->_function (*benchmark);
+		std::cout << std::flush;
+	}
+}
+
+
+std::vector<Benchmark*>&
+Benchmark::registry()
+{
+	static std::vector<Benchmark*> benchmarks;
+	return benchmarks;
+}
+
+} // namespace xf
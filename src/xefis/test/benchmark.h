@@ -0,0 +1,138 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+#ifndef XEFIS__TEST__BENCHMARK_H__INCLUDED
+#define XEFIS__TEST__BENCHMARK_H__INCLUDED
+
+// Xefis:
+#include <xefis/config/all.h>
+
+// Neutrino:
+#include <neutrino/time.h>
+
+// Standard:
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace xf {
+
+/**
+ * Statically-registered benchmark, similar to nu::AutoTest and nu::ManualTest.
+ * All registered benchmarks are run by the benchmark executable.
+ */
+class Benchmark
+{
+  public:
+	using Function = std::function<void (Benchmark&)>;
+
+	/**
+	 * Per-iteration time distribution of a single measurement.
+	 */
+	struct Statistics
+	{
+		size_t		samples	{ 0 };
+		si::Time	minimum	{ 0_s };
+		si::Time	median	{ 0_s };
+		si::Time	p90		{ 0_s };
+		si::Time	p99		{ 0_s };
+		si::Time	maximum	{ 0_s };
+		si::Time	mean	{ 0_s };
+	};
+
+  public:
+	// Ctor
+	explicit
+	Benchmark (std::string_view name, Function);
+
+	/**
+	 * Return benchmark name.
+	 */
+	[[nodiscard]]
+	std::string const&
+	name() const noexcept
+		{ return _name; }
+
+	/**
+	 * Run the iteration function a couple of times to warm up caches, then time each of the requested
+	 * iterations separately and report the distribution under given label.
+	 */
+	template<class Iteration>
+		Statistics
+		measure (std::string_view label, size_t iterations, Iteration&&);
+
+	/**
+	 * Report externally collected per-iteration samples under given label.
+	 */
+	Statistics
+	report (std::string_view label, std::vector<si::Time> samples);
+
+	/**
+	 * Compute distribution statistics of given samples.
+	 */
+	[[nodiscard]]
+	static Statistics
+	compute_statistics (std::vector<si::Time> samples);
+
+	/**
+	 * Prevent the compiler from optimizing away computation of the value.
+	 */
+	template<class Value>
+		static void
+		keep (Value const& value)
+			{ asm volatile ("" : : "g" (&value) : "memory"); }
+
+	/**
+	 * Run all registered benchmarks whose name contains the filter string.
+	 */
+	static void
+	run_all (std::optional<std::string_view> filter = std::nullopt);
+
+  private:
+	static std::vector<Benchmark*>&
+	registry();
+
+  private:
+	std::string	_name;
+	Function	_function;
+};
+
+
+template<class Iteration>
+	inline Benchmark::Statistics
+	Benchmark::measure (std::string_view const label, size_t const iterations, Iteration&& iteration)
+	{
+		std::vector<si::Time> samples;
+		samples.reserve (iterations);
+
+		for (size_t i = 0; i < std::max<size_t> (1, iterations / 10); ++i)
+			iteration();
+
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			auto const t0 = nu::steady_now();
+			iteration();
+			samples.push_back (nu::steady_now() - t0);
+		}
+
+		return report (label, std::move (samples));
+	}
+
+} // namespace xf
+
+#endif
@@ -15,17 +15,19 @@
 #include "packet_reader.h"
 
 // Neutrino:
+#include <neutrino/exception.h>
 #include <neutrino/numeric.h>
 
 // Standard:
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 #include <utility>
 
 
 namespace xf {
 
-PacketReader::PacketReader (Blob const& magic, ParseCallback parse):
+PacketReader::PacketReader (BlobView const magic, ParseCallback parse):
 	_magic (magic),
 	_parse (std::move (parse))
 {
@@ -42,57 +44,134 @@ PacketReader::set_minimum_packet_size (std::size_t bytes) noexcept
 
 
 void
-PacketReader::set_buffer_capacity (std::size_t bytes) noexcept
+PacketReader::set_buffer_capacity (std::size_t bytes)
 {
 	_capacity = bytes;
-	_buffer.reserve (_capacity);
+
+	if (_capacity > 0)
+	{
+		auto const buffered_size = _write - _read;
+
+		if (buffered_size > _capacity)
+		{
+			_discarded_bytes += buffered_size - _capacity;
+			_read = _write - _capacity;
+			_synchronized = false;
+		}
+
+		// Twice the capacity, so that remaining bytes are moved to the front at most
+		// once per _capacity fed bytes:
+		std::memmove (_buffer.data(), _buffer.data() + _read, _write - _read);
+		_write -= _read;
+		_read = 0;
+		_buffer.resize (2 * _capacity);
+	}
 }
 
 
 void
-PacketReader::feed (Blob const& data)
+PacketReader::feed (BlobView data)
 {
-	using nu::to_signed;
-
-	if (_capacity > 0 && _buffer.size() + data.size() > _capacity)
+	if (_capacity > 0)
 	{
 		// Trim input buffer:
 		if (data.size() > _capacity)
-			_buffer = Blob (data.begin() + to_signed (data.size()) - to_signed (_capacity), data.end());
-		else
 		{
-			_buffer.erase (_buffer.begin(), _buffer.begin() + to_signed (_buffer.size()) + to_signed (data.size()) - to_signed (_capacity));
-			_buffer.append_range (data);
+			_discarded_bytes += _write - _read + data.size() - _capacity;
+			_read = _write = 0;
+			_synchronized = false;
+			data.remove_prefix (data.size() - _capacity);
+		}
+		else if (_write - _read + data.size() > _capacity)
+		{
+			auto const to_drop = _write - _read + data.size() - _capacity;
+			_discarded_bytes += to_drop;
+			_read += to_drop;
+			_synchronized = false;
 		}
 	}
-	else
-		_buffer.append_range (data);
 
-	for (;;)
+	make_room (data.size());
+	std::copy (data.begin(), data.end(), _buffer.begin() + nu::to_signed (_write));
+	_write += data.size();
+
+	while (_read < _write)
 	{
-		// Find magic string in buffer:
-		Blob::iterator p = std::search (_buffer.begin(), _buffer.end(),
-										_magic.begin(), _magic.end());
-		// If magic found:
-		if (p != _buffer.end())
+		if (!_synchronized)
 		{
-			// Everything until packet magic is considered gibberish:
-			_buffer.erase (_buffer.begin(), p);
-			// If enough data to parse:
-			if (_buffer.size() >= _minimum_packet_size)
+			auto const p = find_magic();
+
+			if (p == _write)
 			{
-				std::size_t parsed_bytes = _parse();
-				if (parsed_bytes > 0)
-				{
-					_buffer.erase (_buffer.begin(), _buffer.begin() + to_signed (parsed_bytes));
-					// If buffer is still non-empty, try parsing again:
-					if (!_buffer.empty())
-						continue;
-				}
+				// Everything except possibly a partial magic at the end is gibberish:
+				auto const keep = std::min (_magic.size() - 1, _write - _read);
+				_discarded_bytes += _write - _read - keep;
+				_read = _write - keep;
+				break;
 			}
+
+			// Everything until packet magic is considered gibberish:
+			_discarded_bytes += p - _read;
+			_read = p;
+			_synchronized = true;
 		}
-		break;
+
+		// If not enough data to parse:
+		if (_write - _read < _minimum_packet_size)
+			break;
+
+		auto const parsed_bytes = std::min (_parse (buffered()), _write - _read);
+
+		if (parsed_bytes == 0)
+			break;
+
+		_read += parsed_bytes;
+		_synchronized = false;
 	}
+
+	// Cheap compaction when everything has been consumed:
+	if (_read == _write)
+		_read = _write = 0;
+}
+
+
+void
+PacketReader::make_room (std::size_t const bytes)
+{
+	if (_write + bytes <= _buffer.size())
+		return;
+
+	// Move remaining bytes to the front:
+	std::memmove (_buffer.data(), _buffer.data() + _read, _write - _read);
+	_write -= _read;
+	_read = 0;
+
+	if (_write + bytes > _buffer.size())
+		_buffer.resize (std::max (2 * _buffer.size(), _write + bytes));
+}
+
+
+std::size_t
+PacketReader::find_magic() const noexcept
+{
+	auto const* const begin = _buffer.data() + _read;
+	auto const* const end = _buffer.data() + _write;
+	auto const magic_size = _magic.size();
+
+	// memchr() is vectorized in the C library, so searching for the first magic byte
+	// is much faster than std::search() for sparse matches:
+	for (auto const* p = begin; p + magic_size <= end; ++p)
+	{
+		p = static_cast<uint8_t const*> (std::memchr (p, _magic[0], nu::to_unsigned (end - p)));
+
+		if (!p || p + magic_size > end)
+			break;
+
+		if (std::memcmp (p + 1, _magic.data() + 1, magic_size - 1) == 0)
+			return nu::to_unsigned (p - _buffer.data());
+	}
+
+	return _write;
 }
 
 } // namespace xf
@@ -31,17 +31,22 @@ namespace xf {
 /**
  * Helper object that collects input bytes until a certain amount is collected
  * and only then calls the configured callback.
+ *
+ * Bytes are kept in a preallocated buffer with read/write offsets, so consuming packets
+ * doesn't move memory. Remaining bytes are moved to the front only when the write offset
+ * reaches the end of the buffer, which keeps the data passed to the callback contiguous
+ * and the total cost linear in the number of fed bytes.
  */
 class PacketReader: private nu::Noncopyable
 {
   public:
 	/**
-	 * Callback should return number of parsed bytes.
-	 * This number of bytes will be removed from the beginning
-	 * of input buffer. If returns 0, it indicates that there
-	 * was not enough data.
+	 * Callback gets a view of buffered data starting with the magic value.
+	 * It should return number of parsed bytes. This number of bytes will be
+	 * removed from the beginning of input buffer. If returns 0, it indicates
+	 * that there was not enough data.
 	 */
-	typedef std::function<std::size_t()> ParseCallback;
+	using ParseCallback = std::function<std::size_t (BlobView)>;
 
   public:
 	/**
@@ -50,7 +55,7 @@ class PacketReader: private nu::Noncopyable
 	 * @magic value and when its size > minimum packet size.
 	 */
 	explicit
-	PacketReader (Blob const& magic, ParseCallback callback);
+	PacketReader (BlobView magic, ParseCallback callback);
 
 	/**
 	 * Set minimum packet size in bytes. If data in the input buffer
@@ -62,37 +67,62 @@ class PacketReader: private nu::Noncopyable
 
 	/**
 	 * Set maximum buffer size. If 0, buffer size will not be limited.
+	 * When limited, oldest bytes are dropped when buffer gets full.
 	 */
 	void
-	set_buffer_capacity (std::size_t bytes) noexcept;
+	set_buffer_capacity (std::size_t bytes);
 
 	/**
 	 * Feed synchronizer with input data. It will search for magic values
 	 * and asks if synchronization is possible.
 	 */
 	void
-	feed (Blob const& data);
+	feed (BlobView data);
+
+	/**
+	 * Return view of currently buffered, not yet parsed data.
+	 */
+	[[nodiscard]]
+	BlobView
+	buffered() const noexcept
+		{ return BlobView (_buffer.data() + _read, _write - _read); }
 
 	/**
-	 * Access input buffer.
+	 * Return total number of bytes discarded so far because they didn't belong to any packet
+	 * or didn't fit in the buffer.
 	 */
-	Blob&
-	buffer() noexcept;
+	[[nodiscard]]
+	std::size_t
+	discarded_bytes() const noexcept
+		{ return _discarded_bytes; }
 
   private:
-	Blob			_magic;
-	std::size_t		_minimum_packet_size	= 0;
-	std::size_t		_capacity				= 0;
-	Blob			_buffer;
-	ParseCallback	_parse;
-};
+	/**
+	 * Make sure there's room for given number of bytes after the write offset.
+	 */
+	void
+	make_room (std::size_t bytes);
 
+	/**
+	 * Find the magic value in buffered data starting at the read offset.
+	 * Return offset in _buffer or _write if not found.
+	 */
+	[[nodiscard]]
+	std::size_t
+	find_magic() const noexcept;
 
-inline Blob&
-PacketReader::buffer() noexcept
-{
-	return _buffer;
-}
+  private:
+	Blob					_magic;
+	std::size_t				_minimum_packet_size	= 0;
+	std::size_t				_capacity				= 0;
+	std::vector<uint8_t>	_buffer;
+	std::size_t				_read					= 0;
+	std::size_t				_write					= 0;
+	// True if data at _read is known to start with the magic value:
+	bool					_synchronized			= false;
+	std::size_t				_discarded_bytes		= 0;
+	ParseCallback			_parse;
+};
 
 } // namespace xf
 
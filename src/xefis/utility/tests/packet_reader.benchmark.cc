@@ -0,0 +1,58 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/test/benchmark.h>
+#include <xefis/utility/packet_reader.h>
+
+// Standard:
+#include <cstddef>
+#include <format>
+
+
+namespace xf::test {
+namespace {
+
+xf::Benchmark b1 ("PacketReader: burst parsing", [] (xf::Benchmark& benchmark) {
+	// CHR-UM6-like packets: "snp", packet type, address, 4 data bytes, 2 checksum bytes:
+	Blob const packet { 's', 'n', 'p', 0x80, 0x5c, 1, 2, 3, 4, 0, 0 };
+
+	for (std::size_t const packets_per_burst: { 10u, 100u, 1'000u, 10'000u })
+	{
+		Blob burst;
+
+		for (std::size_t i = 0; i < packets_per_burst; ++i)
+			burst += packet;
+
+		std::size_t parsed = 0;
+		auto reader = PacketReader (Blob { 's', 'n', 'p' }, [&parsed, &packet] (BlobView const data) -> std::size_t {
+			if (data.size() < packet.size())
+				return 0;
+
+			++parsed;
+			return packet.size();
+		});
+		reader.set_minimum_packet_size (7);
+		reader.set_buffer_capacity (2 * burst.size());
+
+		benchmark.measure (std::format ("{} packets per burst", packets_per_burst), 200, [&] {
+			reader.feed (burst);
+		});
+
+		xf::Benchmark::keep (parsed);
+	}
+});
+
+} // namespace
+} // namespace xf::test
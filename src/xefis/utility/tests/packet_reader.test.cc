@@ -0,0 +1,102 @@
+/* vim:ts=4
+ *
+ * Copyleft 2026  Michał Gawron
+ * Marduk Unix Labs, http://mulabs.org/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Visit http://www.gnu.org/licenses/gpl-3.0.html for more information on licensing.
+ */
+
+// Xefis:
+#include <xefis/config/all.h>
+#include <xefis/utility/packet_reader.h>
+
+// Neutrino:
+#include <neutrino/test/auto_test.h>
+
+// Standard:
+#include <cstddef>
+#include <vector>
+
+
+namespace xf::test {
+namespace {
+
+namespace test_asserts = nu::test_asserts;
+
+
+/**
+ * Packets are: magic "AB", length byte, payload of given length.
+ */
+struct TestReader
+{
+	std::vector<Blob>	packets;
+	PacketReader		reader {
+		Blob { 'A', 'B' },
+		[this] (BlobView const data) -> std::size_t {
+			auto const size = 3u + data[2];
+
+			if (data.size() < size)
+				return 0;
+
+			packets.emplace_back (data.substr (0, size));
+			return size;
+		},
+	};
+
+	TestReader()
+		{ reader.set_minimum_packet_size (3); }
+};
+
+
+nu::AutoTest t_1 ("PacketReader: parses packets split across feeds", []{
+	TestReader t;
+
+	t.reader.feed (Blob { 'x', 'y', 'A' });
+	t.reader.feed (Blob { 'B', 2, 'p' });
+	test_asserts::verify ("incomplete packet is not parsed", t.packets.empty());
+
+	t.reader.feed (Blob { 'q', 'A', 'B', 0, 'z', 'A', 'B', 1 });
+	test_asserts::verify_equal ("two packets parsed", t.packets.size(), std::size_t (2));
+	test_asserts::verify_equal ("first packet", t.packets[0], Blob { 'A', 'B', 2, 'p', 'q' });
+	test_asserts::verify_equal ("second packet", t.packets[1], Blob { 'A', 'B', 0 });
+	test_asserts::verify_equal ("gibberish is discarded and counted", t.reader.discarded_bytes(), std::size_t (3));
+	test_asserts::verify_equal ("partial packet stays buffered", Blob (t.reader.buffered()), Blob { 'A', 'B', 1 });
+});
+
+
+nu::AutoTest t_2 ("PacketReader: parses a long burst", []{
+	TestReader t;
+	Blob burst;
+
+	for (std::size_t i = 0; i < 10'000; ++i)
+		burst += Blob { 'A', 'B', 2, static_cast<uint8_t> (i), '-' };
+
+	t.reader.feed (burst);
+	test_asserts::verify_equal ("all packets parsed", t.packets.size(), std::size_t (10'000));
+	test_asserts::verify ("buffer is empty", t.reader.buffered().empty());
+});
+
+
+nu::AutoTest t_3 ("PacketReader: limited capacity drops oldest bytes", []{
+	TestReader t;
+	t.reader.set_buffer_capacity (8);
+
+	// Packet with declared length larger than capacity can never be parsed:
+	t.reader.feed (Blob { 'A', 'B', 20, 1, 2, 3, 4, 5 });
+	t.reader.feed (Blob { 6, 7, 'A', 'B', 1, 'x' });
+	test_asserts::verify_equal ("packet after dropped data is parsed", t.packets.size(), std::size_t (1));
+	test_asserts::verify_equal ("parsed packet", t.packets[0], Blob { 'A', 'B', 1, 'x' });
+
+	for (std::size_t i = 0; i < 1000; ++i)
+		t.reader.feed (Blob { 'A', 'B', 0, '.' });
+
+	test_asserts::verify_equal ("packets parsed after many feeds", t.packets.size(), std::size_t (1001));
+});
+
+} // namespace
+} // namespace xf::test